@@ -0,0 +1,466 @@
+/*
+	Name        : ArrowWriter.cpp
+	Author      : Charles N. Burns (charlesnburns|gmail|com / burnchar|isu|edu)
+	Date        : October 2026
+	License     : GPL3. See license.txt or www.gnu.org/licenses/gpl-3.0.txt
+	Requirements: Qt 4, data to parse, any spreadsheet program.
+	Notes       : Best viewed with tab width 4.
+	Description : Writes decoded columns in the Apache Arrow IPC file format.
+				  Arrow's metadata is stored as FlatBuffers; the few tables it
+				  needs are built here by a minimal FlatBuffers builder rather
+				  than pulling in the Arrow and FlatBuffers libraries.
+
+				  Format: https://arrow.apache.org/docs/format/Columnar.html
+				  Schema: Schema.fbs, Message.fbs and File.fbs in Arrow's
+				  format directory; the field numbers below are theirs.
+*/
+
+#include "ArrowWriter.h"
+#include "DecodePlan.h"
+#include <QSysInfo>
+#include <cstring>
+
+const int arrowAlignment = 8;	// Every message and buffer starts on this
+static const char arrowMagic[] = "ARROW1";
+
+// Enumerations from the Arrow schema
+const qint16 metadataVersionV5 = 4;
+const quint8 headerSchema = 1;
+const quint8 headerRecordBatch = 3;
+const quint8 typeInt = 2;
+const quint8 typeFloatingPoint = 3;
+const qint16 precisionDouble = 2;
+
+
+//! Appends a scalar to a byte array, least significant byte first.
+template<typename T>
+static void appendLittleEndian(QByteArray &bytes, T value)
+{
+	for(unsigned int index = 0; index < sizeof(T); ++index)
+		bytes.append(char(quint64(value) >> (index * 8)));
+}
+
+
+//! @returns The number of zero bytes which pad size to a multiple of alignment
+static int paddingFor(qint64 size, int alignment = arrowAlignment)
+{
+	return int((alignment - size % alignment) % alignment);
+}
+
+
+//! Builds one FlatBuffer, back to front as the FlatBuffers library does, so
+//! that every offset points forward. Positions are measured from the end of
+//! the buffer, which does not move as it grows toward the front.
+class FlatBuilder
+{
+	QByteArray bytes;
+	int head;			// Index of the first byte in use
+	int minAlign;		// Largest alignment of anything in the buffer
+	int tableStart;
+	QVector<int> slots;	// Position of each field of the current table
+
+	void reserve(int size);
+	void pad(int size);
+	void prep(int alignment, int additional);
+	void pushOffset(int target);
+
+public:
+	FlatBuilder();
+	int offset() const { return bytes.size() - head; }
+	template<typename T> void push(T value);
+	int createString(const QByteArray &text);
+	int createStructVector(const QByteArray &data, int count, int alignment);
+	int createOffsetVector(const QVector<int> &offsets);
+	void startTable();
+	template<typename T> void addScalar(int slot, T value);
+	void addOffset(int slot, int target);
+	int endTable();
+	QByteArray finish(int root);
+};
+
+
+//! Constructor for FlatBuilder class
+FlatBuilder::FlatBuilder()
+{
+	this->bytes.resize(1024);
+	this->head = bytes.size();
+	this->minAlign = 1;
+	this->tableStart = 0;
+}
+
+
+//! Makes room for size more bytes in front of the head.
+void FlatBuilder::reserve(int size)
+{
+	if(head >= size) return;
+	int used = offset();
+	int newSize = bytes.size() * 2;
+	while(newSize - used < size) newSize *= 2;
+	QByteArray larger(newSize, '\0');
+	memcpy(larger.data() + newSize - used, bytes.constData() + head, used);
+	bytes = larger;
+	head = newSize - used;
+}
+
+
+//! Writes size zero bytes.
+void FlatBuilder::pad(int size)
+{
+	reserve(size);
+	for(; size > 0; --size) bytes[--head] = '\0';
+}
+
+
+//! Pads so that, once additional more bytes are written, the buffer is
+//! aligned for a value of alignment bytes.
+void FlatBuilder::prep(int alignment, int additional)
+{
+	if(alignment > minAlign) minAlign = alignment;
+	pad(paddingFor(offset() + additional, alignment));
+}
+
+
+//! Writes a little-endian scalar.
+template<typename T>
+void FlatBuilder::push(T value)
+{
+	prep(sizeof(T), 0);
+	reserve(sizeof(T));
+	for(int index = sizeof(T) - 1; index >= 0; --index)
+		bytes[--head] = char(quint64(value) >> (index * 8));
+}
+
+
+//! Writes an offset to something already in the buffer.
+void FlatBuilder::pushOffset(int target)
+{
+	prep(4, 0);
+	push<quint32>(offset() - target + 4);
+}
+
+
+//! @returns The position of a new null-terminated string
+int FlatBuilder::createString(const QByteArray &text)
+{
+	prep(4, text.size() + 1);
+	pad(1);
+	reserve(text.size());
+	head -= text.size();
+	memcpy(bytes.data() + head, text.constData(), text.size());
+	push<quint32>(text.size());
+	return offset();
+}
+
+
+//! @param data The structs, already laid out in little-endian order
+//! @returns The position of a new vector of structs
+int FlatBuilder::createStructVector(const QByteArray &data, int count,
+									int alignment)
+{
+	prep(4, data.size());
+	prep(alignment, data.size());
+	reserve(data.size());
+	head -= data.size();
+	memcpy(bytes.data() + head, data.constData(), data.size());
+	push<quint32>(count);
+	return offset();
+}
+
+
+//! @returns The position of a new vector of offsets to tables or strings
+int FlatBuilder::createOffsetVector(const QVector<int> &offsets)
+{
+	prep(4, offsets.size() * 4);
+	for(int index = offsets.size() - 1; index >= 0; --index)
+		pushOffset(offsets.at(index));
+	push<quint32>(offsets.size());
+	return offset();
+}
+
+
+//! Begins a table. Strings, vectors and tables it refers to must already be
+//! in the buffer.
+void FlatBuilder::startTable()
+{
+	slots.clear();
+	tableStart = offset();
+}
+
+
+//! Adds a scalar field to the current table.
+template<typename T>
+void FlatBuilder::addScalar(int slot, T value)
+{
+	push<T>(value);
+	if(slots.size() <= slot) slots.resize(slot + 1);
+	slots[slot] = offset();
+}
+
+
+//! Adds a field which refers to a string, vector or table.
+void FlatBuilder::addOffset(int slot, int target)
+{
+	pushOffset(target);
+	if(slots.size() <= slot) slots.resize(slot + 1);
+	slots[slot] = offset();
+}
+
+
+//! Ends the current table and writes its vtable just in front of it.
+//! @returns The position of the table
+int FlatBuilder::endTable()
+{
+	push<qint32>(0);	// Replaced by the distance to the vtable below
+	int table = offset();
+	for(int slot = slots.size() - 1; slot >= 0; --slot)
+		push<quint16>(slots.at(slot) ? table - slots.at(slot) : 0);
+	push<quint16>(table - tableStart);
+	push<quint16>((slots.size() + 2) * 2);
+	qint32 distance = offset() - table;
+	int index = bytes.size() - table;
+	for(int shift = 0; shift < 32; shift += 8)
+		bytes[index++] = char(quint32(distance) >> shift);
+	return table;
+}
+
+
+//! Writes the offset to the root table.
+//! @returns The finished FlatBuffer
+QByteArray FlatBuilder::finish(int root)
+{
+	prep(minAlign, 4);
+	pushOffset(root);
+	return bytes.mid(head);
+}
+
+
+//! Adds the Schema table describing the columns.
+//! @returns The position of the table
+static int buildSchema(FlatBuilder &builder, const QVector<ArrowField> &fields)
+{
+	QVector<int> fieldTables;
+	QVector<int> noChildren;
+	for(int index = 0; index < fields.size(); ++index) {
+		const ArrowField &field = fields.at(index);
+		int name = builder.createString(field.name);
+		builder.startTable();
+		if(field.isFloat) builder.addScalar<qint16>(0, precisionDouble);
+		else {
+			builder.addScalar<qint32>(0, field.bitWidth);
+			builder.addScalar<quint8>(1, field.isSigned);	// is_signed
+		}
+		int type = builder.endTable();
+		int children = builder.createOffsetVector(noChildren);
+		builder.startTable();
+		builder.addOffset(0, name);
+		builder.addScalar<quint8>(1, 0);		// Not nullable
+		builder.addScalar<quint8>(2, field.isFloat ? typeFloatingPoint
+												   : typeInt);
+		builder.addOffset(3, type);
+		builder.addOffset(5, children);
+		fieldTables.append(builder.endTable());
+	}
+	int fieldVector = builder.createOffsetVector(fieldTables);
+	builder.startTable();
+	builder.addScalar<qint16>(0, QSysInfo::ByteOrder == QSysInfo::BigEndian);
+	builder.addOffset(1, fieldVector);
+	return builder.endTable();
+}
+
+
+//! Wraps a Message table around a header table.
+//! @returns The finished FlatBuffer
+static QByteArray finishMessage(FlatBuilder &builder, quint8 headerType,
+								int header, qint64 bodyLength)
+{
+	builder.startTable();
+	builder.addScalar<qint64>(3, bodyLength);
+	builder.addOffset(2, header);
+	builder.addScalar<qint16>(0, metadataVersionV5);
+	builder.addScalar<quint8>(1, headerType);
+	return builder.finish(builder.endTable());
+}
+
+
+//! Frames a message as the IPC format requires: a continuation marker, the
+//! padded metadata length, the metadata, padding, then the body.
+static QByteArray encapsulate(const QByteArray &metadata, const QByteArray &body)
+{
+	int length = metadata.size() + paddingFor(8 + metadata.size());
+	QByteArray message;
+	message.reserve(8 + length + body.size());
+	appendLittleEndian<quint32>(message, 0xFFFFFFFFu);
+	appendLittleEndian<qint32>(message, length);
+	message.append(metadata);
+	message.append(QByteArray(length - metadata.size(), '\0'));
+	message.append(body);
+	return message;
+}
+
+
+//! @returns The Arrow integer width which holds a column of bytes bytes
+int ArrowField::bitWidthForBytes(int bytes)
+{
+	if(bytes <= 1) return 8;
+	if(bytes <= 2) return 16;
+	if(bytes <= 4) return 32;
+	return 64;
+}
+
+
+//! Constructor for ArrowBatch class
+//! @param fields The columns. Must outlive the batch.
+//! @param maxRows The most rows which will be appended
+ArrowBatch::ArrowBatch(const QVector<ArrowField> &fields, int maxRows)
+	: fields(fields), columns(fields.size())
+{
+	this->rows = 0;
+	for(int col = 0; col < fields.size(); ++col)
+		columns[col].resize(maxRows * (fields.at(col).bitWidth / 8));
+}
+
+
+//! Copies the values of a decoded block into the columns, in this host's
+//! byte order, which the schema records.
+void ArrowBatch::append(const DecodedBlock &block)
+{
+	for(int col = 0; col < columns.size(); ++col) {
+		int width = fields.at(col).bitWidth / 8;
+		char *out = columns[col].data() + rows * width;
+		if(fields.at(col).isFloat) {
+			memcpy(out, block.realColumn(col), block.rows * sizeof(double));
+			continue;
+		}
+		const quint64 *raw = block.rawColumn(col);
+		for(int row = 0; row < block.rows; ++row, out += width) {
+			switch(width) {
+			case 1: { quint8 value = raw[row]; memcpy(out, &value, 1); break; }
+			case 2: { quint16 value = raw[row]; memcpy(out, &value, 2); break; }
+			case 4: { quint32 value = raw[row]; memcpy(out, &value, 4); break; }
+			default: memcpy(out, &raw[row], 8);
+			}
+		}
+	}
+	rows += block.rows;
+}
+
+
+//! Encodes the batch as a RecordBatch message. Each column has an empty
+//! validity buffer, as no value is ever null, and a data buffer.
+//! @returns The message, ready for ArrowWriter::writeBatch()
+QByteArray ArrowBatch::message() const
+{
+	QByteArray nodes, buffers, body;
+	for(int col = 0; col < columns.size(); ++col) {
+		qint64 length = qint64(rows) * (fields.at(col).bitWidth / 8);
+		appendLittleEndian<qint64>(nodes, rows);
+		appendLittleEndian<qint64>(nodes, 0);			// Null count
+		appendLittleEndian<qint64>(buffers, body.size());	// Validity
+		appendLittleEndian<qint64>(buffers, 0);
+		appendLittleEndian<qint64>(buffers, body.size());	// Values
+		appendLittleEndian<qint64>(buffers, length);
+		body.append(columns.at(col).constData(), length);
+		body.append(QByteArray(paddingFor(length), '\0'));
+	}
+
+	FlatBuilder builder;
+	int nodeVector = builder.createStructVector(nodes, columns.size(), 8);
+	int bufferVector = builder.createStructVector(buffers,
+												  columns.size() * 2, 8);
+	builder.startTable();
+	builder.addScalar<qint64>(0, rows);
+	builder.addOffset(1, nodeVector);
+	builder.addOffset(2, bufferVector);
+	int header = builder.endTable();
+	return encapsulate(finishMessage(builder, headerRecordBatch, header,
+									 body.size()), body);
+}
+
+
+//! Constructor for ArrowWriter class
+ArrowWriter::ArrowWriter()
+{
+	this->device = 0;
+	this->position = 0;
+}
+
+
+//! Writes bytes to the file, keeping track of the position for the footer.
+//! @returns false on a write error
+bool ArrowWriter::write(const QByteArray &bytes)
+{
+	if(device->write(bytes) != bytes.size()) return false;
+	position += bytes.size();
+	return true;
+}
+
+
+//! Writes the file signature and the schema.
+//! @param device The open output file, positioned at its start
+//! @param fields The columns of every batch
+//! @returns false on a write error
+bool ArrowWriter::begin(QIODevice *device, const QVector<ArrowField> &fields)
+{
+	this->device = device;
+	this->fields = fields;
+	batches.clear();
+	position = 0;
+	QByteArray magic(arrowMagic, sizeof(arrowMagic) - 1);
+	magic.append(QByteArray(paddingFor(magic.size()), '\0'));
+
+	FlatBuilder builder;
+	int schema = buildSchema(builder, fields);
+	QByteArray metadata = finishMessage(builder, headerSchema, schema, 0);
+	return write(magic) && write(encapsulate(metadata, QByteArray()));
+}
+
+
+//! Appends a record batch made by ArrowBatch::message().
+//! @returns false on a write error
+bool ArrowWriter::writeBatch(const QByteArray &message)
+{
+	Block block;
+	const uchar *prefix = reinterpret_cast<const uchar*>(message.constData());
+	qint32 length = prefix[4] | (prefix[5] << 8) | (prefix[6] << 16) |
+					(prefix[7] << 24);
+	block.offset = position;
+	block.metaDataLength = 8 + length;
+	block.bodyLength = message.size() - block.metaDataLength;
+	batches.append(block);
+	return write(message);
+}
+
+
+//! Writes the end-of-stream marker and the footer, which repeats the schema
+//! and indexes the record batches for random access.
+//! @returns false on a write error
+bool ArrowWriter::finish()
+{
+	QByteArray end;
+	appendLittleEndian<quint32>(end, 0xFFFFFFFFu);
+	appendLittleEndian<qint32>(end, 0);
+
+	QByteArray blocks;
+	for(int index = 0; index < batches.size(); ++index) {
+		const Block &block = batches.at(index);
+		appendLittleEndian<qint64>(blocks, block.offset);
+		appendLittleEndian<qint32>(blocks, block.metaDataLength);
+		appendLittleEndian<qint32>(blocks, 0);		// Struct padding
+		appendLittleEndian<qint64>(blocks, block.bodyLength);
+	}
+	FlatBuilder builder;
+	int schema = buildSchema(builder, fields);
+	int dictionaries = builder.createStructVector(QByteArray(), 0, 8);
+	int recordBatches = builder.createStructVector(blocks, batches.size(), 8);
+	builder.startTable();
+	builder.addOffset(1, schema);
+	builder.addOffset(2, dictionaries);
+	builder.addOffset(3, recordBatches);
+	builder.addScalar<qint16>(0, metadataVersionV5);
+	QByteArray footer = builder.finish(builder.endTable());
+
+	QByteArray trailer;
+	appendLittleEndian<qint32>(trailer, footer.size());
+	trailer.append(arrowMagic, sizeof(arrowMagic) - 1);
+	return write(end) && write(footer) && write(trailer);
+}
@@ -0,0 +1,78 @@
+/*
+	Name        : ArrowWriter.h
+	Author      : Charles N. Burns (charlesnburns|gmail|com / burnchar|isu|edu)
+	Date        : October 2026
+	License     : GPL3. See license.txt or www.gnu.org/licenses/gpl-3.0.txt
+	Requirements: Qt 4, data to parse, any spreadsheet program.
+	Notes       : Best viewed with tab width 4.
+	Description : Header file to define the ArrowBatch and ArrowWriter classes.
+*/
+
+#ifndef ARROWWRITER_H
+#define ARROWWRITER_H
+
+#include <QByteArray>
+#include <QVector>
+#include <QIODevice>
+
+class DecodedBlock;
+
+//! One column of an Arrow file: counters are integers of the smallest Arrow
+//! width which holds them, signed if the column is, voltages and floats are
+//! 64-bit doubles.
+struct ArrowField
+{
+	QByteArray name;	// UTF-8
+	bool isFloat;
+	bool isSigned;		// Of an integer field
+	int bitWidth;		// 8, 16, 32 or 64
+
+	static int bitWidthForBytes(int bytes);
+};
+
+
+//! The columns of one record batch, filled a decoded block at a time, then
+//! encoded as an Arrow IPC message. Batches touch no shared state, so they
+//! may be built on any number of threads at once.
+class ArrowBatch
+{
+	const QVector<ArrowField> &fields;
+	QVector<QByteArray> columns;
+	int rows;
+
+public:
+	ArrowBatch(const QVector<ArrowField> &fields, int maxRows);
+	void append(const DecodedBlock &block);
+	QByteArray message() const;
+};
+
+
+//! Writes an Arrow IPC file, also known as Feather version 2: a schema, then
+//! record batches as they arrive, then a footer which indexes the batches.
+//! Only one batch is held in memory at a time, and the finished file can be
+//! memory-mapped by pandas, Polars or any other Arrow reader with no parsing.
+class ArrowWriter
+{
+	//! Location of one record batch, for the footer
+	struct Block
+	{
+		qint64 offset;
+		qint32 metaDataLength;
+		qint64 bodyLength;
+	};
+
+	QIODevice *device;
+	QVector<ArrowField> fields;
+	QVector<Block> batches;
+	qint64 position;
+
+	bool write(const QByteArray &bytes);
+
+public:
+	ArrowWriter();
+	bool begin(QIODevice *device, const QVector<ArrowField> &fields);
+	bool writeBatch(const QByteArray &message);
+	bool finish();
+};
+
+#endif // ARROWWRITER_H
@@ -0,0 +1,299 @@
+/*
+	Name        : BatchQueue.cpp
+	Author      : Charles N. Burns (charlesnburns|gmail|com / burnchar|isu|edu)
+	Date        : October 2026
+	License     : GPL3. See license.txt or www.gnu.org/licenses/gpl-3.0.txt
+	Requirements: Qt 4, data to parse, any spreadsheet program.
+	Notes       : Best viewed with tab width 4.
+	Description : The BatchQueue class converts a whole session's captures in
+				  one go, keeping every core busy until the last file is done.
+*/
+
+#include "BatchQueue.h"
+#include <QDir>
+#include <QFileInfo>
+#include <QThread>
+#include <QMutexLocker>
+#include <QPair>
+#include <QtAlgorithms>
+
+//! A thread which runs jobs of a BatchQueue until none are left.
+class BatchWorker : public QThread
+{
+	BatchQueue *queue;
+	int worker;
+
+protected:
+	void run() { queue->runJobs(worker); }
+
+public:
+	BatchWorker(BatchQueue *queue, int worker)
+	{
+		this->queue = queue;
+		this->worker = worker;
+	}
+};
+
+
+//! Constructor for BatchQueue class
+BatchQueue::BatchQueue(QObject *parent) : QObject(parent)
+{
+	this->memoryBytes = defaultBatchMemoryBytes;
+	this->workers = 0;
+	this->budget = 0;
+	this->finishedJobs = 0;
+	this->elapsedNs = 0;
+}
+
+
+//! Adds a file to the batch. A batch never follows its files, which would
+//! keep it from ever finishing.
+//! @param settings The file's job, with its input and output paths
+//! @returns false if the input file does not exist, or another job already
+//!			 writes the same output file
+bool BatchQueue::add(const ConvertSettings &settings)
+{
+	QFileInfo info(settings.infilePath);
+	bool retval = info.isFile();
+	if(!retval) {
+		errorMessage = tr("Cannot open data file for reading: %1")
+				.arg(settings.infilePath);
+	}
+	for(int index = 0; retval && index < jobs.size(); ++index) {
+		if(jobs.at(index).settings.outfilePath == settings.outfilePath) {
+			errorMessage = tr("Two data files would be converted to %1")
+					.arg(settings.outfilePath);
+			retval = false;
+		}
+	}
+	if(retval) {
+		BatchJob job;
+		job.settings = settings;
+		job.settings.follow = false;
+		job.inputBytes = info.size();
+		job.finished = false;
+		job.succeeded = false;
+		jobs.append(job);
+	}
+	return retval;
+}
+
+
+//! Deals the jobs out to the workers' queues, largest file first, each to
+//! the worker with the fewest bytes queued so far. Each queue is then in
+//! order of decreasing size.
+void BatchQueue::deal()
+{
+	QList<QPair<quint64, int> > bySize;
+	for(int index = 0; index < jobs.size(); ++index)
+		bySize.append(qMakePair(jobs.at(index).inputBytes, index));
+	qSort(bySize.begin(), bySize.end(), qGreater<QPair<quint64, int> >());
+
+	queues.fill(QList<int>(), workers);
+	queuedBytes.fill(0, workers);
+	for(int job = 0; job < bySize.size(); ++job) {
+		int least = 0;
+		for(int worker = 1; worker < workers; ++worker)
+			if(queuedBytes.at(worker) < queuedBytes.at(least)) least = worker;
+		queues[least].append(bySize.at(job).second);
+		queuedBytes[least] += bySize.at(job).first;
+	}
+}
+
+
+//! Takes the next job for a worker: the largest in its own queue, or else
+//! the largest in the queue of the worker with the most bytes left.
+//! Its Converter is made and listed as running under the same lock, so a
+//! cancel() can never fall between taking a job and starting it.
+//! @param index Receives the index of the job
+//! @param converter Receives the job's Converter, for the caller to delete
+//! @returns false once every queue is empty, or the batch is cancelled
+bool BatchQueue::takeJob(int worker, int &index, Converter *&converter)
+{
+	QMutexLocker locker(&mutex);
+	if(cancelRequested != 0) return false;
+	int from = worker;
+	if(queues.at(from).isEmpty()) { // Steal
+		for(int other = 0; other < workers; ++other)
+			if(queuedBytes.at(other) > queuedBytes.at(from)) from = other;
+	}
+	if(queues.at(from).isEmpty()) return false;
+	index = queues[from].takeFirst();
+	queuedBytes[from] -= jobs.at(index).inputBytes;
+	converter = new Converter(jobs.at(index).settings);
+	converter->setMemoryBudget(budget);
+	running.append(converter);
+	return true;
+}
+
+
+//! Worker thread body: converts jobs until there are none left.
+void BatchQueue::runJobs(int worker)
+{
+	int index;
+	Converter *converter;
+	while(takeJob(worker, index, converter)) {
+		bool succeeded = converter->run();
+		int finished;
+		{
+			QMutexLocker locker(&mutex);
+			running.removeOne(converter);
+			BatchJob &job = jobs[index];
+			job.finished = true;
+			job.succeeded = succeeded;
+			job.errorMessage = converter->errorMessage;
+			job.stats = converter->runStats();
+			finished = ++finishedJobs;
+		}
+		delete converter;
+		emit jobFinished(index);
+		emit progressChanged(finished);
+	}
+}
+
+
+//! Converts every file of the batch, and returns once all are done.
+//! May be called on any thread, like Converter::run().
+//! @returns false if any file failed or the batch was cancelled, true
+//!			 otherwise
+bool BatchQueue::run()
+{
+	QElapsedTimer clock;
+	clock.start();
+	finishedJobs = 0;
+	if(workers < 1) workers = QThread::idealThreadCount();
+	if(workers < 1) workers = 1;
+	if(workers > jobs.size()) workers = qMax(1, jobs.size());
+	deal();
+	emit progressRange(0, jobs.size());
+
+	MemoryBudget shared(memoryBytes);
+	budget = &shared;
+	QList<BatchWorker*> threads;
+	for(int worker = 0; worker < workers; ++worker) {
+		threads.append(new BatchWorker(this, worker));
+		threads.last()->start();
+	}
+	for(int worker = 0; worker < workers; ++worker) {
+		threads.at(worker)->wait();
+		delete threads.at(worker);
+	}
+	budget = 0;
+
+	bool retval = (cancelRequested == 0);
+	for(int index = 0; index < jobs.size(); ++index)
+		if(!jobs.at(index).succeeded) retval = false;
+	elapsedNs = clock.nsecsElapsed();
+	return retval;
+}
+
+
+//! Stops the batch: the running jobs are cancelled, and no more are started.
+//! May be called from any thread.
+void BatchQueue::cancel()
+{
+	QMutexLocker locker(&mutex);
+	cancelRequested.fetchAndStoreOrdered(1);
+	for(int index = 0; index < running.size(); ++index)
+		running.at(index)->cancel();
+}
+
+
+//! @returns One line telling how a job went, and how fast it read its input
+QString BatchQueue::jobSummary(int index) const
+{
+	const BatchJob &job = jobs.at(index);
+	QString name = QFileInfo(job.settings.infilePath).fileName();
+	if(!job.finished) return tr("%1: not converted.").arg(name);
+	if(!job.succeeded) return tr("%1: %2").arg(name).arg(job.errorMessage);
+	double seconds = job.stats.elapsedNs / 1e9;
+	QString text = tr("%1: %2 rows, %3 MB in %4 s, %5 MB/s.")
+			.arg(name)
+			.arg(job.stats.rowsOutput)
+			.arg(job.inputBytes / 1e6, 0, 'f', 1)
+			.arg(seconds, 0, 'f', 2)
+			.arg(seconds > 0 ? job.inputBytes / 1e6 / seconds : 0, 0, 'f', 1);
+	if(job.stats.framesBad > 0)
+		text += tr(" %1 bad frames.").arg(job.stats.framesBad);
+	if(!job.stats.warning.isEmpty()) text += " " + job.stats.warning;
+	return text;
+}
+
+
+//! @returns One line for the whole batch, short enough for the status bar.
+//!			 Its throughput is of all files together, over the batch's time.
+QString BatchQueue::summary() const
+{
+	int succeeded = 0;
+	quint64 bytes = 0;
+	for(int index = 0; index < jobs.size(); ++index) {
+		if(!jobs.at(index).succeeded) continue;
+		succeeded += 1;
+		bytes += jobs.at(index).inputBytes;
+	}
+	double seconds = elapsedNs / 1e9;
+	return tr("%1 of %2 files converted, %3 MB in %4 s, %5 MB/s.")
+			.arg(succeeded)
+			.arg(jobs.size())
+			.arg(bytes / 1e6, 0, 'f', 1)
+			.arg(seconds, 0, 'f', 2)
+			.arg(seconds > 0 ? bytes / 1e6 / seconds : 0, 0, 'f', 1);
+}
+
+
+//! Lists the files a wildcard pattern such as "C:/captures/*.bin" matches.
+//! Only the file name may hold wildcards. The shell expands patterns on
+//! Unix-like hosts, but Windows leaves that to each program.
+//! @returns The matching files in name order, or the pattern itself if it
+//!			 holds no wildcards
+QStringList BatchQueue::expandPattern(const QString &pattern)
+{
+	QStringList retval;
+	QFileInfo info(pattern);
+	QString name = info.fileName();
+	if(!name.contains('*') && !name.contains('?') && !name.contains('[')) {
+		retval.append(pattern);
+	}
+	else {
+		QDir dir = info.dir();
+		QStringList names = dir.entryList(QStringList(name), QDir::Files,
+										  QDir::Name);
+		for(int index = 0; index < names.size(); ++index)
+			retval.append(dir.filePath(names.at(index)));
+	}
+	return retval;
+}
+
+
+//! Names the output file of one input file of a batch. The output template
+//! may be a directory, which gets CSV files, or a file name whose directory
+//! and extension are used, such as "out/*.csv.gz".
+//! @param infilePath Path of the input file
+//! @param outputTemplate Directory or file name; if empty, each output file
+//!		   is a CSV file next to its input file
+//! @returns The input file's name, with the extension replaced
+QString BatchQueue::outputPathFor(const QString &infilePath,
+								  const QString &outputTemplate)
+{
+	QFileInfo input(infilePath);
+	QFileInfo output(outputTemplate);
+	QString base = input.fileName();
+	if(ConvertSettings::compressionForPath(base) != Decompressor::Uncompressed)
+		base = QFileInfo(base).completeBaseName();	// "run.bin.gz": "run.bin"
+	base = QFileInfo(base).completeBaseName();
+
+	QString dir = input.path();
+	QString suffix = "csv";
+	if(output.isDir()) dir = output.filePath();
+	else if(!outputTemplate.isEmpty()) {
+		dir = output.path();
+		suffix = output.suffix();
+		if(ConvertSettings::compressionForPath(outputTemplate) !=
+		   Decompressor::Uncompressed)
+			suffix = QFileInfo(output.completeBaseName()).suffix() + "." +
+					suffix;
+		if(suffix.startsWith('.')) suffix = "csv" + suffix;	// "out/*.gz"
+		if(suffix.isEmpty()) suffix = "csv";
+	}
+	return QDir(dir).filePath(base + "." + suffix);
+}
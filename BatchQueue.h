@@ -0,0 +1,96 @@
+/*
+	Name        : BatchQueue.h
+	Author      : Charles N. Burns (charlesnburns|gmail|com / burnchar|isu|edu)
+	Date        : October 2026
+	License     : GPL3. See license.txt or www.gnu.org/licenses/gpl-3.0.txt
+	Requirements: Qt 4, data to parse, any spreadsheet program.
+	Notes       : Best viewed with tab width 4.
+	Description : Header file to define the BatchJob and BatchQueue classes.
+*/
+
+#ifndef BATCHQUEUE_H
+#define BATCHQUEUE_H
+
+#include <QObject>
+#include <QList>
+#include <QVector>
+#include <QStringList>
+#include <QMutex>
+#include <QAtomicInt>
+#include <QElapsedTimer>
+#include "Converter.h"
+
+//! Most memory the jobs of a batch hold for their output at once
+const quint64 defaultBatchMemoryBytes = Q_UINT64_C(512) << 20;
+
+
+//! One file of a batch, and how its conversion went.
+struct BatchJob
+{
+	ConvertSettings settings;
+	quint64 inputBytes;		// Size of the input file, for scheduling
+	bool finished;
+	bool succeeded;
+	QString errorMessage;
+	RunStats stats;
+};
+
+
+//! Converts many files with one layout, several at once. Each worker thread
+//! runs one Converter at a time, whose chunks are formatted on the global
+//! thread pool like any other job's, so the cores left idle by a small file
+//! format the chunks of a large one.
+//! Files are dealt out largest first, each to the worker with the fewest
+//! bytes queued. A worker whose queue runs dry steals the largest file queued
+//! by the worker with the most bytes left, so a few large files never keep
+//! one worker busy long after the others have finished.
+//! The jobs share one MemoryBudget, which caps the output they hold at once.
+class BatchQueue : public QObject
+{
+	Q_OBJECT
+
+	friend class BatchWorker;
+
+	QList<BatchJob> jobs;
+	QVector<QList<int> > queues;	// Job indices each worker will run
+	QVector<quint64> queuedBytes;	// Input bytes in each worker's queue
+	QList<Converter*> running;
+	QMutex mutex;				// Guards all of the above while running
+	QAtomicInt cancelRequested;
+	quint64 memoryBytes;
+	MemoryBudget *budget;		// Shared by the jobs while running
+	int workers;
+	int finishedJobs;
+	qint64 elapsedNs;
+
+	void deal();
+	bool takeJob(int worker, int &index, Converter *&converter);
+	void runJobs(int worker);
+
+public:
+	QString errorMessage;
+	explicit BatchQueue(QObject *parent = 0);
+	bool add(const ConvertSettings &settings);
+	void setMemoryLimit(quint64 bytes) { memoryBytes = bytes; }
+	void setWorkers(int workers) { this->workers = workers; }
+	bool run();
+	int size() const { return jobs.size(); }
+	const BatchJob &job(int index) const { return jobs.at(index); }
+	bool wasCancelled() const { return cancelRequested != 0; }
+	QString jobSummary(int index) const;
+	QString summary() const;
+
+	static QStringList expandPattern(const QString &pattern);
+	static QString outputPathFor(const QString &infilePath,
+								 const QString &outputTemplate);
+
+public slots:
+	void cancel();
+
+signals:
+	void progressRange(int minimum, int maximum);
+	void progressChanged(int files);
+	void jobFinished(int index);
+};
+
+#endif // BATCHQUEUE_H
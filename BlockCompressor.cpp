@@ -0,0 +1,67 @@
+/*
+	Name        : BlockCompressor.cpp
+	Author      : Charles N. Burns (charlesnburns|gmail|com / burnchar|isu|edu)
+	Date        : October 2026
+	License     : GPL3. See license.txt or www.gnu.org/licenses/gpl-3.0.txt
+	Requirements: Qt 4, data to parse, any spreadsheet program.
+				  zlib for gzip files and libzstd for zstd files; see
+				  DataParser.pro.
+	Notes       : Best viewed with tab width 4.
+	Description : The BlockCompressor class lets the converter write
+				  compressed CSV files without a second, serial pass.
+*/
+
+#include "BlockCompressor.h"
+#ifdef WITH_ZLIB
+#include <string.h>
+#include <zlib.h>
+#endif
+#ifdef WITH_ZSTD
+#include <zstd.h>
+#endif
+
+//! Compresses one block of output. Touches no shared state, so blocks may
+//! be compressed on any number of threads at once.
+//! @param data The text to compress
+//! @param compression How to compress it. Must be supported by this build.
+//! @param block Receives a whole gzip member or zstd frame
+//! @returns false if the block cannot be compressed, true otherwise
+bool BlockCompressor::compress(const QByteArray &data,
+							   Decompressor::Compression compression,
+							   QByteArray &block)
+{
+	bool retval = false;
+	block.clear();
+#ifdef WITH_ZLIB
+	if(compression == Decompressor::Gzip) {
+		z_stream zs;
+		memset(&zs, 0, sizeof(zs));
+		// 16: Write a gzip header and trailer around the deflate stream
+		if(deflateInit2(&zs, gzipOutputLevel, Z_DEFLATED, 15 + 16, 8,
+						Z_DEFAULT_STRATEGY) == Z_OK) {
+			block.resize(int(deflateBound(&zs, uLong(data.size()))));
+			zs.next_in = reinterpret_cast<Bytef*>(
+					const_cast<char*>(data.constData()));
+			zs.avail_in = uInt(data.size());
+			zs.next_out = reinterpret_cast<Bytef*>(block.data());
+			zs.avail_out = uInt(block.size());
+			retval = (deflate(&zs, Z_FINISH) == Z_STREAM_END);
+			block.resize(retval ? int(zs.total_out) : 0);
+			deflateEnd(&zs);
+		}
+	}
+#endif
+#ifdef WITH_ZSTD
+	if(compression == Decompressor::Zstd) {
+		block.resize(int(ZSTD_compressBound(size_t(data.size()))));
+		size_t size = ZSTD_compress(block.data(), size_t(block.size()),
+									data.constData(), size_t(data.size()),
+									zstdOutputLevel);
+		retval = !ZSTD_isError(size);
+		block.resize(retval ? int(size) : 0);
+	}
+#endif
+	Q_UNUSED(data);
+	Q_UNUSED(compression);
+	return retval;
+}
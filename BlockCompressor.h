@@ -0,0 +1,38 @@
+/*
+	Name        : BlockCompressor.h
+	Author      : Charles N. Burns (charlesnburns|gmail|com / burnchar|isu|edu)
+	Date        : October 2026
+	License     : GPL3. See license.txt or www.gnu.org/licenses/gpl-3.0.txt
+	Requirements: Qt 4, data to parse, any spreadsheet program.
+				  zlib for gzip files and libzstd for zstd files; see
+				  DataParser.pro.
+	Notes       : Best viewed with tab width 4.
+	Description : Header file to define the BlockCompressor class.
+*/
+
+#ifndef BLOCKCOMPRESSOR_H
+#define BLOCKCOMPRESSOR_H
+
+#include <QByteArray>
+#include "Decompressor.h"
+
+const int gzipOutputLevel = 6;	// As gzip and pigz use by default
+const int zstdOutputLevel = 3;	// As zstd uses by default
+
+
+//! Compresses each block of output text on its own, as a whole gzip member
+//! or zstd frame, so blocks can be compressed on any number of threads at
+//! once, like pigz does. The blocks are simply written one after another:
+//! gzip and zstd files may hold any number of members or frames, and every
+//! decompressor joins them into one stream. Each block's ratio is a little
+//! worse than compressing the whole stream, as no block refers back to
+//! text in the block before it.
+class BlockCompressor
+{
+public:
+	static bool compress(const QByteArray &data,
+						 Decompressor::Compression compression,
+						 QByteArray &block);
+};
+
+#endif // BLOCKCOMPRESSOR_H
@@ -0,0 +1,183 @@
+/*
+	Name        : Checkpoint.cpp
+	Author      : Charles N. Burns (charlesnburns|gmail|com / burnchar|isu|edu)
+	Date        : October 2026
+	License     : GPL3. See license.txt or www.gnu.org/licenses/gpl-3.0.txt
+	Requirements: Qt 4, data to parse, any spreadsheet program.
+	Notes       : Best viewed with tab width 4.
+	Description : The Checkpoint class reads and writes the sidecar file which
+				  lets a conversion continue where an earlier one stopped.
+*/
+
+#include "Checkpoint.h"
+
+//! Constructor for Checkpoint class. An empty checkpoint is not valid.
+Checkpoint::Checkpoint()
+{
+	this->keptRows = 0;
+	this->inputOffset = 0;
+	this->inputSize = 0;
+	this->inputModified = 0;
+	this->outputLength = 0;
+	this->rowsOutput = 0;
+}
+
+
+//! @returns The path of the sidecar file kept for an output file
+QString Checkpoint::pathFor(const QString &outfilePath)
+{
+	return outfilePath + CHECKPOINT_SUFFIX;
+}
+
+
+//! Reads a sidecar file.
+//! @param fileURI Path of the sidecar file
+//! @returns false if the file is missing or unreadable, true otherwise
+bool Checkpoint::read(const QString &fileURI)
+{
+	bool retval = true;
+	QDomDocument doc;
+	QFile file(fileURI);
+	layoutHash.clear();
+	columnStats.clear();
+	inputSize = 0;
+	inputModified = 0;
+	if(! file.open(QFile::ReadOnly | QFile::Text)) {
+		errorMessage = "No checkpoint file.";
+		retval = false;
+	}
+	else if(! doc.setContent(&file) ||
+			doc.documentElement().tagName() != CHECKPOINT_START_ELEMENT) {
+		errorMessage = "The checkpoint file is damaged.";
+		retval = false;
+	}
+	else {
+		QDomNode child = doc.documentElement().firstChild();
+		while(!child.isNull()) {
+			QString tagName = child.toElement().tagName();
+			QString text = child.toElement().text().trimmed();
+			if(tagName == "layouthash") layoutHash = text.toLatin1();
+			else if(tagName == "keptrows") keptRows = text.toULongLong();
+			else if(tagName == "inputoffset") inputOffset = text.toULongLong();
+			else if(tagName == "inputchecksum")
+				inputChecksum = text.toLatin1();
+			else if(tagName == "inputsize") inputSize = text.toULongLong();
+			else if(tagName == "inputmodified")
+				inputModified = text.toLongLong();
+			else if(tagName == "outputlength")
+				outputLength = text.toULongLong();
+			else if(tagName == "outputchecksum")
+				outputChecksum = text.toLatin1();
+			else if(tagName == "rowsoutput") rowsOutput = text.toULongLong();
+			else if(tagName == "columnstats") columnStats = text;
+			child = child.nextSibling();
+		}
+		file.close();
+	}
+	return retval;
+}
+
+
+//! Writes the sidecar file. It is written under a temporary name, then
+//! renamed, so a crash never leaves a half-written checkpoint behind.
+//! @param fileURI Path of the sidecar file
+//! @returns false on a write error, true otherwise
+bool Checkpoint::write(const QString &fileURI)
+{
+	bool retval = true;
+	QString tempURI = fileURI + ".tmp";
+	QFile file(tempURI);
+	if(! file.open(QFile::WriteOnly | QFile::Text)) {
+		retval = false;
+	}
+	else {
+		QXmlStreamWriter xml(&file);
+		xml.setAutoFormatting(true);
+		xml.setAutoFormattingIndent(-1); // -1: Use 1 tab for formatting
+		xml.writeStartDocument();
+		xml.writeStartElement(CHECKPOINT_START_ELEMENT);
+		xml.writeTextElement("layouthash", QString(layoutHash));
+		xml.writeTextElement("keptrows", QString::number(keptRows));
+		xml.writeTextElement("inputoffset", QString::number(inputOffset));
+		xml.writeTextElement("inputchecksum",
+							 QString(inputChecksum));
+		xml.writeTextElement("inputsize", QString::number(inputSize));
+		xml.writeTextElement("inputmodified", QString::number(inputModified));
+		xml.writeTextElement("outputlength", QString::number(outputLength));
+		xml.writeTextElement("outputchecksum",
+							 QString(outputChecksum));
+		xml.writeTextElement("rowsoutput", QString::number(rowsOutput));
+		xml.writeTextElement("columnstats", columnStats);
+		xml.writeEndDocument();
+		file.close();
+		retval = (file.error() == QFile::NoError);
+		// QFile::rename() will not replace an existing file
+		if(retval && QFile::exists(fileURI)) retval = QFile::remove(fileURI);
+		if(retval) retval = QFile::rename(tempURI, fileURI);
+	}
+	if(!retval) {
+		QFile::remove(tempURI);
+		errorMessage = QString("Cannot write checkpoint file: %1")
+				.arg(fileURI);
+	}
+	return retval;
+}
+
+
+//! Picks the parts of the output's prefix its checksum covers: the first
+//! and last checkpointChecksumBytes, and checkpointSampleCount samples spread
+//! evenly between them. That notices a different or rewritten file, or one
+//! changed in the middle, without reading all of a large one.
+//! @param length Bytes in the prefix
+//! @returns The offset and size of each part, in order
+QList<QPair<quint64, qint64> > Checkpoint::sampleRanges(quint64 length)
+{
+	QList<QPair<quint64, qint64> > ranges;
+	qint64 ends = qMin(qint64(length), checkpointChecksumBytes);
+	if(ends == 0) return ranges;
+	ranges.append(qMakePair(Q_UINT64_C(0), ends));
+	if(length > quint64(2 * checkpointChecksumBytes)) {
+		quint64 spacing = length / (checkpointSampleCount + 1);
+		for(int sample = 1; sample <= checkpointSampleCount; ++sample) {
+			quint64 offset = spacing * sample;
+			ranges.append(qMakePair(offset, qMin(qint64(length - offset),
+												 checkpointSampleBytes)));
+		}
+	}
+	ranges.append(qMakePair(length - ends, ends));
+	return ranges;
+}
+
+
+//! Checksums the parts of a prefix picked by sampleRanges().
+//! @param samples The bytes of each part, in order
+//! @returns The checksum as hex digits
+QByteArray Checkpoint::sampledChecksum(const QList<QByteArray> &samples)
+{
+	QCryptographicHash hash(QCryptographicHash::Sha1);
+	for(int index = 0; index < samples.size(); ++index)
+		hash.addData(samples.at(index));
+	return hash.result().toHex();
+}
+
+
+//! Checksums the first length bytes of a file, as sampledChecksum() does.
+//! @param checksum Receives the checksum
+//! @returns false if the file is shorter than length or cannot be read
+bool Checkpoint::fileChecksum(const QString &fileURI, quint64 length,
+							  QByteArray &checksum)
+{
+	QFile file(fileURI);
+	bool retval = file.open(QFile::ReadOnly) &&
+			quint64(file.size()) >= length;
+	QList<QPair<quint64, qint64> > ranges = sampleRanges(length);
+	QList<QByteArray> samples;
+	for(int index = 0; retval && index < ranges.size(); ++index) {
+		const QPair<quint64, qint64> &range = ranges.at(index);
+		if(file.seek(range.first)) samples.append(file.read(range.second));
+		retval = (samples.size() == index + 1 &&
+				  samples.last().size() == range.second);
+	}
+	if(retval) checksum = sampledChecksum(samples);
+	return retval;
+}
@@ -0,0 +1,68 @@
+/*
+	Name        : Checkpoint.h
+	Author      : Charles N. Burns (charlesnburns|gmail|com / burnchar|isu|edu)
+	Date        : October 2026
+	License     : GPL3. See license.txt or www.gnu.org/licenses/gpl-3.0.txt
+	Requirements: Qt 4, data to parse, any spreadsheet program.
+	Notes       : Best viewed with tab width 4.
+	Description : Header file to define the Checkpoint class.
+*/
+
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <QtXml/QDomDocument>
+#include <QtXml/QXmlStreamWriter>
+#include <QFile>
+#include <QString>
+#include <QByteArray>
+#include <QList>
+#include <QPair>
+#include <QCryptographicHash>
+
+const char CHECKPOINT_START_ELEMENT[] = "charles_n_burns-data_parser-checkpoint";
+const char CHECKPOINT_SUFFIX[] = ".checkpoint";
+//! Bytes at each end of the output's prefix which its checksum covers
+const qint64 checkpointChecksumBytes = 64 << 10;
+//! Samples the checksum also covers, spread evenly between the ends
+const int checkpointSampleCount = 64;
+const qint64 checkpointSampleBytes = 4 << 10;
+//! Input bytes added to its checksum at a time
+const quint64 checkpointHashBytes = 4 << 20;
+const int checkpointIntervalMs = 2000;	// Least time between sidecar writes
+
+
+//! How far a conversion had safely got, kept in a sidecar file next to the
+//! output so a later run can continue instead of starting over. The checksums
+//! tell whether the input and output are still the files the job wrote, and
+//! the input's size and modification time whether it was written since.
+//! The input's checksum covers every byte converted, as any of them may have
+//! been edited. The output's samples it, as only the job writes the output.
+class Checkpoint
+{
+public:
+	QByteArray layoutHash;		// Of every setting which changes the output
+	quint64 keptRows;			// Kept rows (or buckets) already converted
+	quint64 inputOffset;		// Input bytes those rows cover
+	QByteArray inputChecksum;	// Of all input bytes before inputOffset
+	quint64 inputSize;			// Of the input file, when checkpointed
+	qint64 inputModified;		// Its modification time, in ms since 1970
+	quint64 outputLength;		// Output bytes those rows produced
+	QByteArray outputChecksum;	// Of output bytes before outputLength
+	quint64 rowsOutput;			// Output rows, counting the column names
+	QString columnStats;		// Of those rows; see ColumnStats::state()
+	QString errorMessage;
+
+	Checkpoint();
+	bool read(const QString &fileURI);
+	bool write(const QString &fileURI);
+	bool isValid() const { return !layoutHash.isEmpty(); }
+
+	static QString pathFor(const QString &outfilePath);
+	static QList<QPair<quint64, qint64> > sampleRanges(quint64 length);
+	static QByteArray sampledChecksum(const QList<QByteArray> &samples);
+	static bool fileChecksum(const QString &fileURI, quint64 length,
+							 QByteArray &checksum);
+};
+
+#endif // CHECKPOINT_H
@@ -0,0 +1,337 @@
+/*
+	Name        : ColumnModel.cpp
+	Author      : Charles N. Burns (charlesnburns|gmail|com / burnchar|isu|edu)
+	Date        : October 2026
+	License     : GPL3. See license.txt or www.gnu.org/licenses/gpl-3.0.txt
+	Requirements: Qt 4, data to parse, any spreadsheet program.
+	Notes       : Best viewed with tab width 4.
+	Description : The ColumnModel class holds the column layout shown in the
+				  window's table of columns, and ColumnDelegate edits it one
+				  cell at a time.
+*/
+
+#include "ColumnModel.h"
+#include <QComboBox>
+#include <QSpinBox>
+#include <QRegExpValidator>
+
+//! Constructor for ColumnModel class. No columns are shown.
+ColumnModel::ColumnModel(QObject *parent) : QAbstractTableModel(parent)
+{
+	this->count = 0;
+}
+
+
+//! @returns The number of columns shown, one per table row
+int ColumnModel::rowCount(const QModelIndex &parent) const
+{
+	return parent.isValid() ? 0 : count;
+}
+
+
+//! @returns The number of fields of each column, one per table column
+int ColumnModel::columnCount(const QModelIndex &parent) const
+{
+	return parent.isValid() ? 0 : FieldCount;
+}
+
+
+//! @returns What a cell shows, or what its editor starts with
+QVariant ColumnModel::data(const QModelIndex &index, int role) const
+{
+	if(!index.isValid() || index.row() >= count) return QVariant();
+	const Entry &entry = entries.at(index.row());
+	switch(index.column()) {
+	case NameField:
+		if(role == Qt::DisplayRole || role == Qt::EditRole)
+			return name(index.row());
+		if(role == NameHistoryRole) return entry.names;
+		break;
+	case BytesField:
+		if(role == Qt::DisplayRole || role == Qt::EditRole) return entry.bytes;
+		break;
+	case TypeField:
+		if(role == Qt::DisplayRole) return typeLabel(entry.type);
+		if(role == Qt::EditRole) return int(entry.type);
+		break;
+	case CounterField:
+		if(role == Qt::CheckStateRole)
+			return entry.counter ? Qt::Checked : Qt::Unchecked;
+		break;
+	case ExportField:
+		if(role == Qt::CheckStateRole)
+			return entry.exported ? Qt::Checked : Qt::Unchecked;
+		break;
+	}
+	return QVariant();
+}
+
+
+//! Changes one field of a column, from its editor or check box.
+//! @returns false if the cell does not take the value
+bool ColumnModel::setData(const QModelIndex &index, const QVariant &value,
+						  int role)
+{
+	bool retval = index.isValid() && index.row() < count;
+	int column = index.row();
+	if(retval && role == Qt::EditRole) {
+		switch(index.column()) {
+		case NameField: {
+			QStringList names = nameHistory(column);
+			QString text = filterName(value.toString());
+			names.removeAll(text);
+			names.prepend(text);
+			setNameHistory(column, names);
+			break;
+		}
+		case BytesField: setBytes(column, value.toInt()); break;
+		case TypeField: setType(column, PlanColumn::Type(value.toInt())); break;
+		default: retval = false;
+		}
+	}
+	else if(retval && role == Qt::CheckStateRole) {
+		bool checked = (value.toInt() == Qt::Checked);
+		if(index.column() == CounterField) setCounter(column, checked);
+		else if(index.column() == ExportField) setExported(column, checked);
+		else retval = false;
+	}
+	else retval = false;
+	return retval;
+}
+
+
+//! @returns The titles of the fields, and the numbers of the columns
+QVariant ColumnModel::headerData(int section, Qt::Orientation orientation,
+								 int role) const
+{
+	if(orientation == Qt::Vertical) {
+		if(role == Qt::DisplayRole) return section + 1;
+		return QVariant();
+	}
+	if(role == Qt::DisplayRole) {
+		switch(section) {
+		case NameField: return tr("Column Name");
+		case BytesField: return tr("# bytes");
+		case TypeField: return tr("Type");
+		case CounterField: return tr("Count");
+		case ExportField: return tr("Export");
+		}
+	}
+	else if(role == Qt::ToolTipRole) {
+		switch(section) {
+		case TypeField: return tr("How the column's bytes are read. Signed "
+								  "integers are two's complement; floats are "
+								  "IEEE 754 and have 2, 4 or 8 bytes.");
+		case CounterField: return tr("Write the column's raw value instead of "
+									 "a voltage");
+		case ExportField: return tr("Write this column to the output file. "
+									"Unchecked columns are skipped without "
+									"being read.");
+		}
+	}
+	return QVariant();
+}
+
+
+//! @returns Which cells are edited, and which are check boxes
+Qt::ItemFlags ColumnModel::flags(const QModelIndex &index) const
+{
+	if(!index.isValid()) return 0;
+	Qt::ItemFlags retval = Qt::ItemIsEnabled | Qt::ItemIsSelectable;
+	if(index.column() == CounterField || index.column() == ExportField)
+		retval |= Qt::ItemIsUserCheckable;
+	else retval |= Qt::ItemIsEditable;
+	return retval;
+}
+
+
+//! Shows a number of columns. New columns have one byte, are unsigned,
+//! and are exported.
+void ColumnModel::setCount(int columns)
+{
+	if(columns > count) {
+		beginInsertRows(QModelIndex(), count, columns - 1);
+		while(entries.size() < columns) {
+			Entry entry;
+			entry.bytes = 1;
+			entry.type = PlanColumn::Unsigned;
+			entry.counter = false;
+			entry.exported = true;
+			entries.append(entry);
+		}
+		count = columns;
+		endInsertRows();
+	}
+	else if(columns < count) {
+		beginRemoveRows(QModelIndex(), columns, count - 1);
+		count = columns;
+		endRemoveRows();
+	}
+}
+
+
+//! Computes the sum of bytes in the columns shown.
+//! @returns the number of bytes
+int ColumnModel::rowDataSize() const
+{
+	int accumulator = 0;
+	for(int column = 0; column < count; ++column)
+		accumulator += entries.at(column).bytes;
+	return accumulator;
+}
+
+
+//! @returns The current name of a column, which may be empty
+QString ColumnModel::name(int column) const
+{
+	const QStringList &names = entries.at(column).names;
+	return names.isEmpty() ? QString() : names.first();
+}
+
+
+//! @returns The names of a column, the current one first
+QStringList ColumnModel::nameHistory(int column) const
+{
+	return entries.at(column).names;
+}
+
+
+//! Sets the names of a column, the current one first.
+void ColumnModel::setNameHistory(int column, const QStringList &names)
+{
+	entries[column].names = names;
+	emit dataChanged(index(column, NameField), index(column, NameField));
+}
+
+
+void ColumnModel::setBytes(int column, int bytes)
+{
+	entries[column].bytes = qBound(1, bytes, int(maxColumnBytes));
+	emit dataChanged(index(column, BytesField), index(column, BytesField));
+}
+
+
+void ColumnModel::setType(int column, PlanColumn::Type type)
+{
+	entries[column].type = type;
+	emit dataChanged(index(column, TypeField), index(column, TypeField));
+}
+
+
+void ColumnModel::setCounter(int column, bool counter)
+{
+	entries[column].counter = counter;
+	emit dataChanged(index(column, CounterField), index(column, CounterField));
+}
+
+
+void ColumnModel::setExported(int column, bool exported)
+{
+	entries[column].exported = exported;
+	emit dataChanged(index(column, ExportField), index(column, ExportField));
+}
+
+
+//! @returns The name of a type, as shown in the table
+QString ColumnModel::typeLabel(PlanColumn::Type type)
+{
+	switch(type) {
+	case PlanColumn::Signed: return tr("Signed");
+	case PlanColumn::Float: return tr("Float");
+	default: return tr("Unsigned");
+	}
+}
+
+
+//!	Removes the characters which cause problems in a CSV file from a column
+//! name: \ " and the comma.
+QString ColumnModel::filterName(const QString &name)
+{
+	QString filtered = name;
+	filtered.remove(QRegExp("[\\\\\\\",]"));
+	return filtered.trimmed();
+}
+
+
+//! Constructor for ColumnDelegate class
+ColumnDelegate::ColumnDelegate(QObject *parent) : QStyledItemDelegate(parent)
+{
+}
+
+
+//! Creates the editor of a cell when editing starts. It is deleted when
+//! editing ends, so at most one exists at a time.
+QWidget *ColumnDelegate::createEditor(QWidget *parent,
+									  const QStyleOptionViewItem &option,
+									  const QModelIndex &index) const
+{
+	QWidget *retval = 0;
+	if(index.column() == ColumnModel::NameField) {
+		QComboBox *combo = new QComboBox(parent);
+		combo->setEditable(true);
+		combo->setInsertPolicy(QComboBox::NoInsert);
+		combo->setValidator(new QRegExpValidator(QRegExp("[^\\\\\",]*"),
+												 combo));
+		retval = combo;
+	}
+	else if(index.column() == ColumnModel::BytesField) {
+		QSpinBox *spin = new QSpinBox(parent);
+		spin->setRange(1, maxColumnBytes);
+		retval = spin;
+	}
+	else if(index.column() == ColumnModel::TypeField) {
+		QComboBox *combo = new QComboBox(parent);
+		combo->addItem(ColumnModel::typeLabel(PlanColumn::Unsigned),
+					   PlanColumn::Unsigned);
+		combo->addItem(ColumnModel::typeLabel(PlanColumn::Signed),
+					   PlanColumn::Signed);
+		combo->addItem(ColumnModel::typeLabel(PlanColumn::Float),
+					   PlanColumn::Float);
+		retval = combo;
+	}
+	else retval = QStyledItemDelegate::createEditor(parent, option, index);
+	return retval;
+}
+
+
+//! Fills an editor from its cell: the names used before, the byte count,
+//! or the type.
+void ColumnDelegate::setEditorData(QWidget *editor,
+								   const QModelIndex &index) const
+{
+	if(index.column() == ColumnModel::NameField) {
+		QComboBox *combo = static_cast<QComboBox*>(editor);
+		combo->addItems(index.data(ColumnModel::NameHistoryRole)
+						.toStringList());
+		combo->setEditText(index.data(Qt::EditRole).toString());
+	}
+	else if(index.column() == ColumnModel::BytesField) {
+		static_cast<QSpinBox*>(editor)->setValue(
+				index.data(Qt::EditRole).toInt());
+	}
+	else if(index.column() == ColumnModel::TypeField) {
+		QComboBox *combo = static_cast<QComboBox*>(editor);
+		combo->setCurrentIndex(combo->findData(index.data(Qt::EditRole)));
+	}
+	else QStyledItemDelegate::setEditorData(editor, index);
+}
+
+
+//! Stores what an editor holds in its cell when editing ends.
+void ColumnDelegate::setModelData(QWidget *editor, QAbstractItemModel *model,
+								  const QModelIndex &index) const
+{
+	if(index.column() == ColumnModel::NameField) {
+		model->setData(index, static_cast<QComboBox*>(editor)->currentText());
+	}
+	else if(index.column() == ColumnModel::BytesField) {
+		QSpinBox *spin = static_cast<QSpinBox*>(editor);
+		spin->interpretText();
+		model->setData(index, spin->value());
+	}
+	else if(index.column() == ColumnModel::TypeField) {
+		QComboBox *combo = static_cast<QComboBox*>(editor);
+		model->setData(index, combo->itemData(combo->currentIndex()));
+	}
+	else QStyledItemDelegate::setModelData(editor, model, index);
+}
@@ -0,0 +1,97 @@
+/*
+	Name        : ColumnModel.h
+	Author      : Charles N. Burns (charlesnburns|gmail|com / burnchar|isu|edu)
+	Date        : October 2026
+	License     : GPL3. See license.txt or www.gnu.org/licenses/gpl-3.0.txt
+	Requirements: Qt 4, data to parse, any spreadsheet program.
+	Notes       : Best viewed with tab width 4.
+	Description : Header file to define the ColumnModel and ColumnDelegate
+				  classes.
+*/
+
+#ifndef COLUMNMODEL_H
+#define COLUMNMODEL_H
+
+#include <QAbstractTableModel>
+#include <QStyledItemDelegate>
+#include <QStringList>
+#include <QList>
+#include "Converter.h"
+
+
+//! The column layout edited in the window: one table row per data column,
+//! with its name, byte count, type, counter box and export box. Only the
+//! rows the table view shows are ever painted, and an editor widget exists
+//! only for the cell being edited, so a layout of hundreds of columns costs
+//! no more to show or resize than a few.
+//! Columns dropped by lowering the count keep their settings, and get them
+//! back if the count is raised again.
+class ColumnModel : public QAbstractTableModel
+{
+	Q_OBJECT
+
+	//! Everything set for one data column
+	struct Entry
+	{
+		QStringList names;	// Current name first, then the names used before
+		int bytes;
+		PlanColumn::Type type;
+		bool counter;
+		bool exported;
+	};
+
+	QList<Entry> entries;	// Every column ever shown, even beyond count
+	int count;				// Columns shown
+
+public:
+	enum Field { NameField, BytesField, TypeField, CounterField,
+				 ExportField, FieldCount };
+	//! Role of a name's history, as a QStringList, current name first
+	static const int NameHistoryRole = Qt::UserRole;
+
+	explicit ColumnModel(QObject *parent = 0);
+	int rowCount(const QModelIndex &parent = QModelIndex()) const;
+	int columnCount(const QModelIndex &parent = QModelIndex()) const;
+	QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const;
+	bool setData(const QModelIndex &index, const QVariant &value,
+				 int role = Qt::EditRole);
+	QVariant headerData(int section, Qt::Orientation orientation,
+						int role = Qt::DisplayRole) const;
+	Qt::ItemFlags flags(const QModelIndex &index) const;
+
+	void setCount(int columns);
+	int rowDataSize() const;
+	QString name(int column) const;
+	QStringList nameHistory(int column) const;
+	int bytes(int column) const { return entries.at(column).bytes; }
+	PlanColumn::Type type(int column) const { return entries.at(column).type; }
+	bool isCounter(int column) const { return entries.at(column).counter; }
+	bool isExported(int column) const { return entries.at(column).exported; }
+	void setNameHistory(int column, const QStringList &names);
+	void setBytes(int column, int bytes);
+	void setType(int column, PlanColumn::Type type);
+	void setCounter(int column, bool counter);
+	void setExported(int column, bool exported);
+
+	static QString typeLabel(PlanColumn::Type type);
+	static QString filterName(const QString &name);
+};
+
+
+//! Creates the editor of one cell of a ColumnModel when it is edited: an
+//! editable combo box of the names used before, a spin box of the byte
+//! count, or a combo box of the types. The check boxes need no editor.
+class ColumnDelegate : public QStyledItemDelegate
+{
+	Q_OBJECT
+
+public:
+	explicit ColumnDelegate(QObject *parent = 0);
+	QWidget *createEditor(QWidget *parent, const QStyleOptionViewItem &option,
+						  const QModelIndex &index) const;
+	void setEditorData(QWidget *editor, const QModelIndex &index) const;
+	void setModelData(QWidget *editor, QAbstractItemModel *model,
+					  const QModelIndex &index) const;
+};
+
+#endif // COLUMNMODEL_H
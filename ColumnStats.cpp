@@ -0,0 +1,557 @@
+/*
+	Name        : ColumnStats.cpp
+	Author      : Charles N. Burns (charlesnburns|gmail|com / burnchar|isu|edu)
+	Date        : October 2026
+	License     : GPL3. See license.txt or www.gnu.org/licenses/gpl-3.0.txt
+	Requirements: Qt 4, data to parse, any spreadsheet program.
+	Notes       : Best viewed with tab width 4.
+	Description : The ColumnStats class gathers per-column statistics while a
+				  job converts, and writes them to a sidecar file next to the
+				  output. Each decoded block is reduced with vector
+				  instructions: one pass for its extremes and sum, one for
+				  the squared deviations from its own mean, which are then
+				  merged into the column's with Chan's formula.
+*/
+
+#include "ColumnStats.h"
+#include <QObject>
+#include <QFile>
+#include <cmath>
+#include <limits>
+
+#if defined(__SSE2__) || defined(_M_X64) || \
+	(defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define STATS_SSE2
+#endif
+
+
+//! Finds the least and greatest of a run of values, and their sum.
+//! @param count Number of values; at least 1
+static void scanValues(const double *values, int count, double &minimum,
+					   double &maximum, double &sum)
+{
+	int index = 0;
+	double low = values[0];
+	double high = values[0];
+	double total = 0.0;
+#if defined(STATS_SSE2)
+	if(count >= 4) {
+		__m128d low2 = _mm_loadu_pd(values);
+		__m128d high2 = low2;
+		__m128d sumA = _mm_setzero_pd();
+		__m128d sumB = _mm_setzero_pd();
+		for(; index + 4 <= count; index += 4) {
+			__m128d a = _mm_loadu_pd(values + index);
+			__m128d b = _mm_loadu_pd(values + index + 2);
+			low2 = _mm_min_pd(low2, _mm_min_pd(a, b));
+			high2 = _mm_max_pd(high2, _mm_max_pd(a, b));
+			sumA = _mm_add_pd(sumA, a);
+			sumB = _mm_add_pd(sumB, b);
+		}
+		double lanes[2];
+		_mm_storeu_pd(lanes, low2);
+		low = qMin(lanes[0], lanes[1]);
+		_mm_storeu_pd(lanes, high2);
+		high = qMax(lanes[0], lanes[1]);
+		_mm_storeu_pd(lanes, _mm_add_pd(sumA, sumB));
+		total = lanes[0] + lanes[1];
+	}
+#endif
+	for(; index < count; ++index) {
+		low = qMin(low, values[index]);
+		high = qMax(high, values[index]);
+		total += values[index];
+	}
+	minimum = low;
+	maximum = high;
+	sum = total;
+}
+
+
+//! @returns The sum of the squared deviations of a run of values from mean
+static double squaredDeviations(const double *values, int count, double mean)
+{
+	int index = 0;
+	double total = 0.0;
+#if defined(STATS_SSE2)
+	if(count >= 4) {
+		__m128d mean2 = _mm_set1_pd(mean);
+		__m128d sumA = _mm_setzero_pd();
+		__m128d sumB = _mm_setzero_pd();
+		for(; index + 4 <= count; index += 4) {
+			__m128d a = _mm_sub_pd(_mm_loadu_pd(values + index), mean2);
+			__m128d b = _mm_sub_pd(_mm_loadu_pd(values + index + 2), mean2);
+			sumA = _mm_add_pd(sumA, _mm_mul_pd(a, a));
+			sumB = _mm_add_pd(sumB, _mm_mul_pd(b, b));
+		}
+		double lanes[2];
+		_mm_storeu_pd(lanes, _mm_add_pd(sumA, sumB));
+		total = lanes[0] + lanes[1];
+	}
+#endif
+	for(; index < count; ++index) {
+		double deviation = values[index] - mean;
+		total += deviation * deviation;
+	}
+	return total;
+}
+
+
+//! @returns A value as a JSON number, or null if it has none
+static QString jsonNumber(double value)
+{
+	if(value - value != 0.0) return "null"; // NaN or infinite
+	return QString::number(value, 'g', 17);
+}
+
+
+//! Constructor for ColumnAccumulator class. Holds no values.
+ColumnAccumulator::ColumnAccumulator()
+{
+	this->counter = false;
+	this->isSigned = false;
+	this->isFloat = false;
+	this->voltsPerCount = 1.0;
+	this->zeroVolts = 0.0;
+	this->count = 0;
+	this->nonFinite = 0;
+	this->minimum = 0.0;
+	this->maximum = 0.0;
+	this->rawMinimum = 0;
+	this->rawMaximum = 0;
+	this->mean = 0.0;
+	this->m2 = 0.0;
+	this->low = 0.0;
+	this->high = 0.0;
+	this->binScale = 0.0;
+	this->below = 0;
+	this->above = 0;
+}
+
+
+//! Prepares for the values of one output column, with no values yet.
+//! Integer columns are binned over every value their width holds; float
+//! columns over the voltage range, counting the values outside it.
+//! @param output The output column
+//! @param source The plan column it is decoded from
+void ColumnAccumulator::setup(const OutputColumn &output,
+							  const PlanColumn &source)
+{
+	*this = ColumnAccumulator();
+	counter = (output.kind == PlanColumn::Counter);
+	isSigned = (output.type == PlanColumn::Signed);
+	isFloat = (output.type == PlanColumn::Float);
+	double maxValue = double(DecodePlan::maxRawValue(source.bytes));
+	double signOffset = isSigned ? (maxValue + 1.0) / 2.0 : 0.0;
+	if(!isFloat) {
+		voltsPerCount = 1.0 / source.divisor;
+		zeroVolts = source.vMin + signOffset / source.divisor;
+	}
+	if(counter) {
+		low = -signOffset;
+		high = maxValue - signOffset;
+	}
+	else { // The voltage range, which floats may also leave
+		double vMax = source.vMin + maxValue / source.divisor;
+		low = qMin(source.vMin, vMax);
+		high = qMax(source.vMin, vMax);
+	}
+	binScale = (high > low) ? statsHistogramBins / (high - low) : 0.0;
+	bins.fill(0, statsHistogramBins);
+}
+
+
+//! Adds the statistics of a run of values, already reduced, to the column's.
+void ColumnAccumulator::combine(quint64 count, double mean, double m2,
+								double minimum, double maximum)
+{
+	if(count == 0) return;
+	if(this->count == 0) {
+		this->mean = mean;
+		this->m2 = m2;
+		this->minimum = minimum;
+		this->maximum = maximum;
+	}
+	else {
+		double total = double(this->count) + double(count);
+		double delta = mean - this->mean;
+		this->mean += delta * (double(count) / total);
+		this->m2 += m2 + delta * delta *
+				(double(this->count) * double(count) / total);
+		this->minimum = qMin(this->minimum, minimum);
+		this->maximum = qMax(this->maximum, maximum);
+	}
+	this->count += count;
+}
+
+
+//! Counts a run of values into the bins of the histogram.
+void ColumnAccumulator::addHistogram(const double *values, int count)
+{
+	quint64 *bin = bins.data();
+	for(int index = 0; index < count; ++index) {
+		double position = (values[index] - low) * binScale;
+		if(position < 0.0) ++below;
+		else if(position < statsHistogramBins) ++bin[int(position)];
+		else if(values[index] <= high) ++bin[statsHistogramBins - 1];
+		else ++above;
+	}
+}
+
+
+//! Adds values in the written unit: the volts, or floats, of a block.
+//! Floats which are NaN or infinite are only counted.
+void ColumnAccumulator::add(const double *values, int count)
+{
+	double finite[decodeBlockRows];
+	while(count > 0) {
+		int run = qMin(count, decodeBlockRows);
+		const double *data = values;
+		if(isFloat) {
+			int kept = 0;
+			for(int index = 0; index < run; ++index) {
+				finite[kept] = values[index];
+				kept += (values[index] - values[index] == 0.0);
+			}
+			nonFinite += run - kept;
+			data = finite;
+			run = kept;
+		}
+		if(run > 0) {
+			double minimum, maximum, sum;
+			scanValues(data, run, minimum, maximum, sum);
+			double runMean = sum / run;
+			combine(run, runMean, squaredDeviations(data, run, runMean),
+					minimum, maximum);
+			addHistogram(data, run);
+		}
+		int done = qMin(count, decodeBlockRows);
+		values += done;
+		count -= done;
+	}
+}
+
+
+//! Adds the raw values of a counter column, keeping their exact extremes.
+void ColumnAccumulator::addCounts(const quint64 *values, int count)
+{
+	double converted[decodeBlockRows];
+	while(count > 0) {
+		int run = qMin(count, decodeBlockRows);
+		if(isSigned) {
+			qint64 least = qint64(values[0]);
+			qint64 most = least;
+			for(int index = 0; index < run; ++index) {
+				qint64 value = qint64(values[index]);
+				converted[index] = double(value);
+				least = qMin(least, value);
+				most = qMax(most, value);
+			}
+			if(this->count == 0 || least < qint64(rawMinimum))
+				rawMinimum = quint64(least);
+			if(this->count == 0 || most > qint64(rawMaximum))
+				rawMaximum = quint64(most);
+		}
+		else {
+			quint64 least = values[0];
+			quint64 most = least;
+			for(int index = 0; index < run; ++index) {
+				converted[index] = double(values[index]);
+				least = qMin(least, values[index]);
+				most = qMax(most, values[index]);
+			}
+			if(this->count == 0 || least < rawMinimum) rawMinimum = least;
+			if(this->count == 0 || most > rawMaximum) rawMaximum = most;
+		}
+		add(converted, run);
+		values += run;
+		count -= run;
+	}
+}
+
+
+//! Adds the statistics of the same column gathered elsewhere, such as by
+//! another thread.
+void ColumnAccumulator::merge(const ColumnAccumulator &other)
+{
+	if(other.count > 0 && counter) {
+		bool lower = isSigned ? qint64(other.rawMinimum) < qint64(rawMinimum)
+							  : other.rawMinimum < rawMinimum;
+		bool higher = isSigned ? qint64(other.rawMaximum) > qint64(rawMaximum)
+							   : other.rawMaximum > rawMaximum;
+		if(count == 0 || lower) rawMinimum = other.rawMinimum;
+		if(count == 0 || higher) rawMaximum = other.rawMaximum;
+	}
+	combine(other.count, other.mean, other.m2, other.minimum, other.maximum);
+	nonFinite += other.nonFinite;
+	below += other.below;
+	above += other.above;
+	for(int bin = 0; bin < bins.size() && bin < other.bins.size(); ++bin)
+		bins[bin] += other.bins.at(bin);
+}
+
+
+//! @returns The standard deviation of the values, in the written unit
+double ColumnAccumulator::stddev() const
+{
+	return (count > 0) ? std::sqrt(m2 / count) : 0.0;
+}
+
+
+//! @returns A raw value as volts, as the voltage kernels scale it
+double ColumnAccumulator::toVolts(double counts) const
+{
+	return counts * voltsPerCount + zeroVolts;
+}
+
+
+//! @returns The raw value which reads as a voltage
+double ColumnAccumulator::toCounts(double volts) const
+{
+	return (volts - zeroVolts) / voltsPerCount;
+}
+
+
+//! Constructor for ColumnStats class. Has no columns.
+ColumnStats::ColumnStats()
+{
+}
+
+
+//! Prepares for the output columns of a job, with no values yet.
+//! @param outputs The output columns, in the order they are written
+//! @param plan The plan they are decoded by
+void ColumnStats::setup(const QVector<OutputColumn> &outputs,
+						const DecodePlan &plan)
+{
+	columns.resize(outputs.size());
+	names.clear();
+	for(int col = 0; col < outputs.size(); ++col) {
+		const OutputColumn &output = outputs.at(col);
+		const PlanColumn &source = plan.columns.at(output.source);
+		columns[col].setup(output, source);
+		QString name = output.name.trimmed();
+		if(name.isEmpty()) name = QString("Column %1").arg(source.index + 1);
+		names.append(name);
+	}
+}
+
+
+//! Adds the rows of a decoded block, whose first columns are the outputs.
+void ColumnStats::add(const DecodedBlock &block)
+{
+	if(block.rows < 1) return;
+	for(int col = 0; col < columns.size(); ++col) {
+		ColumnAccumulator &column = columns[col];
+		if(column.counter) column.addCounts(block.rawColumn(col), block.rows);
+		else column.add(block.realColumn(col), block.rows);
+	}
+}
+
+
+//! Adds statistics of the same columns gathered elsewhere.
+void ColumnStats::merge(const ColumnStats &other)
+{
+	for(int col = 0; col < columns.size() && col < other.columns.size(); ++col)
+		columns[col].merge(other.columns.at(col));
+}
+
+
+//! @returns One line per column, at most statsSummaryColumns of them, of its
+//!			 range, mean and standard deviation in the unit it is written in
+QString ColumnStats::summary() const
+{
+	QStringList lines;
+	for(int col = 0; col < columns.size(); ++col) {
+		if(col == statsSummaryColumns) {
+			lines.append(QObject::tr("...and %1 more columns.")
+						 .arg(columns.size() - col));
+			break;
+		}
+		const ColumnAccumulator &column = columns.at(col);
+		QString unit = column.counter ? QString() : QString(" V");
+		if(column.count == 0) {
+			lines.append(QObject::tr("%1: no values").arg(names.at(col)));
+			continue;
+		}
+		lines.append(QObject::tr("%1: %2 to %3%4, mean %5%4, "
+								 "std. dev. %6%4")
+					 .arg(names.at(col))
+					 .arg(column.minimum, 0, 'g', 6)
+					 .arg(column.maximum, 0, 'g', 6)
+					 .arg(unit)
+					 .arg(column.mean, 0, 'g', 6)
+					 .arg(column.stddev(), 0, 'g', 6));
+	}
+	return lines.join("\n");
+}
+
+
+//! @returns One unit's statistics of a column as a JSON object
+static QString unitJson(const QString &minimum, const QString &maximum,
+						double mean, double stddev, double low, double high)
+{
+	return "{\"min\":" + minimum + ",\"max\":" + maximum +
+			",\"mean\":" + jsonNumber(mean) +
+			",\"stddev\":" + jsonNumber(stddev) +
+			",\"low\":" + jsonNumber(low) + ",\"high\":" + jsonNumber(high) +
+			"}";
+}
+
+
+//! @returns The statistics as one JSON object, one line per column. Each
+//!			 column has its statistics and the range of its histogram in
+//!			 "raw" counts and in "volts", then the histogram's bins from low
+//!			 to high, and the values below and above its range. Statistics
+//!			 of a column with no values are null.
+QByteArray ColumnStats::toJson() const
+{
+	QString json = QString("{\"bins\":%1,\"columns\":[")
+			.arg(statsHistogramBins);
+	for(int col = 0; col < columns.size(); ++col) {
+		const ColumnAccumulator &column = columns.at(col);
+		double none = std::numeric_limits<double>::quiet_NaN();
+		bool empty = (column.count == 0);
+		double minimum = empty ? none : column.minimum;
+		double maximum = empty ? none : column.maximum;
+		double mean = empty ? none : column.mean;
+		double stddev = empty ? none : column.stddev();
+		double scale = qAbs(column.voltsPerCount);
+		double countsMin, countsMax, voltsMin, voltsMax;
+		QString raw, volts;
+		if(column.counter) {
+			voltsMin = column.toVolts(minimum);
+			voltsMax = column.toVolts(maximum);
+			if(column.voltsPerCount < 0.0) qSwap(voltsMin, voltsMax);
+			QString least = jsonNumber(minimum);
+			QString most = jsonNumber(maximum);
+			if(!empty && column.isSigned) { // Exact, as read
+				least = QString::number(qint64(column.rawMinimum));
+				most = QString::number(qint64(column.rawMaximum));
+			}
+			else if(!empty) {
+				least = QString::number(column.rawMinimum);
+				most = QString::number(column.rawMaximum);
+			}
+			raw = unitJson(least, most, mean, stddev, column.low, column.high);
+			volts = unitJson(jsonNumber(voltsMin), jsonNumber(voltsMax),
+							 column.toVolts(mean), stddev * scale,
+							 qMin(column.toVolts(column.low),
+								  column.toVolts(column.high)),
+							 qMax(column.toVolts(column.low),
+								  column.toVolts(column.high)));
+		}
+		else {
+			volts = unitJson(jsonNumber(minimum), jsonNumber(maximum), mean,
+							 stddev, column.low, column.high);
+			countsMin = column.toCounts(minimum);
+			countsMax = column.toCounts(maximum);
+			if(column.voltsPerCount < 0.0) qSwap(countsMin, countsMax);
+			raw = column.isFloat ? volts :
+					unitJson(jsonNumber(countsMin), jsonNumber(countsMax),
+							 column.toCounts(mean), stddev / scale,
+							 qMin(column.toCounts(column.low),
+								  column.toCounts(column.high)),
+							 qMax(column.toCounts(column.low),
+								  column.toCounts(column.high)));
+		}
+
+		QStringList bins;
+		for(int bin = 0; bin < column.bins.size(); ++bin)
+			bins.append(QString::number(column.bins.at(bin)));
+		QString name = names.at(col);
+		name.replace('\\', "\\\\").replace('"', "\\\"");
+		json += QString(col > 0 ? ",\n" : "\n") +
+				"{\"name\":\"" + name + "\",\"unit\":\"" +
+				(column.counter ? "raw" : "volts") + "\",\"count\":" +
+				QString::number(column.count) + ",\"non_finite\":" +
+				QString::number(column.nonFinite) + ",\"raw\":" + raw +
+				",\"volts\":" + volts + ",\"histogram\":[" +
+				bins.join(",") + "],\"below\":" +
+				QString::number(column.below) + ",\"above\":" +
+				QString::number(column.above) + "}";
+	}
+	json += "\n]}\n";
+	return json.toUtf8();
+}
+
+
+//! Writes the statistics to a JSON file.
+//! @returns false on a write error
+bool ColumnStats::write(const QString &fileURI) const
+{
+	QFile file(fileURI);
+	QByteArray json = toJson();
+	return file.open(QIODevice::WriteOnly | QIODevice::Text) &&
+			file.write(json) == json.size();
+}
+
+
+//! @returns Everything gathered so far as text, one column after another,
+//!			 which restoreState() reads back exactly
+QString ColumnStats::state() const
+{
+	QStringList lines;
+	for(int col = 0; col < columns.size(); ++col) {
+		const ColumnAccumulator &column = columns.at(col);
+		QStringList fields;
+		fields << QString::number(column.count)
+			   << QString::number(column.nonFinite)
+			   << QString::number(column.minimum, 'g', 17)
+			   << QString::number(column.maximum, 'g', 17)
+			   << QString::number(column.rawMinimum)
+			   << QString::number(column.rawMaximum)
+			   << QString::number(column.mean, 'g', 17)
+			   << QString::number(column.m2, 'g', 17)
+			   << QString::number(column.below)
+			   << QString::number(column.above);
+		for(int bin = 0; bin < column.bins.size(); ++bin)
+			fields << QString::number(column.bins.at(bin));
+		lines.append(fields.join(" "));
+	}
+	return lines.join(";");
+}
+
+
+//! Replaces what has been gathered with a state() saved earlier for the
+//! same columns.
+//! @returns false, changing nothing, if the text is not such a state
+bool ColumnStats::restoreState(const QString &text)
+{
+	QStringList lines = text.split(';');
+	QVector<ColumnAccumulator> restored = columns;
+	bool retval = (lines.size() == restored.size());
+	for(int col = 0; retval && col < restored.size(); ++col) {
+		ColumnAccumulator &column = restored[col];
+		QStringList fields = lines.at(col).split(' ');
+		retval = (fields.size() == statsStateFields + statsHistogramBins);
+		bool ok[statsStateFields];
+		if(retval) {
+			column.count = fields.at(0).toULongLong(&ok[0]);
+			column.nonFinite = fields.at(1).toULongLong(&ok[1]);
+			column.minimum = fields.at(2).toDouble(&ok[2]);
+			column.maximum = fields.at(3).toDouble(&ok[3]);
+			column.rawMinimum = fields.at(4).toULongLong(&ok[4]);
+			column.rawMaximum = fields.at(5).toULongLong(&ok[5]);
+			column.mean = fields.at(6).toDouble(&ok[6]);
+			column.m2 = fields.at(7).toDouble(&ok[7]);
+			column.below = fields.at(8).toULongLong(&ok[8]);
+			column.above = fields.at(9).toULongLong(&ok[9]);
+			for(int field = 0; field < statsStateFields; ++field)
+				retval = retval && ok[field];
+		}
+		for(int bin = 0; retval && bin < statsHistogramBins; ++bin)
+			column.bins[bin] = fields.at(statsStateFields + bin)
+					.toULongLong(&retval);
+	}
+	if(retval) columns = restored;
+	return retval;
+}
+
+
+//! @returns The path of the statistics sidecar file of an output file
+QString ColumnStats::pathFor(const QString &outfilePath)
+{
+	return outfilePath + COLUMN_STATS_SUFFIX;
+}
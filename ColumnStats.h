@@ -0,0 +1,101 @@
+/*
+	Name        : ColumnStats.h
+	Author      : Charles N. Burns (charlesnburns|gmail|com / burnchar|isu|edu)
+	Date        : October 2026
+	License     : GPL3. See license.txt or www.gnu.org/licenses/gpl-3.0.txt
+	Requirements: Qt 4, data to parse, any spreadsheet program.
+	Notes       : Best viewed with tab width 4.
+	Description : Header file to define the ColumnAccumulator and ColumnStats
+				  classes.
+*/
+
+#ifndef COLUMNSTATS_H
+#define COLUMNSTATS_H
+
+#include <QString>
+#include <QStringList>
+#include <QByteArray>
+#include <QVector>
+#include "DecodePlan.h"
+#include "Decimator.h"
+
+const char COLUMN_STATS_SUFFIX[] = ".stats.json";
+const int statsHistogramBins = 64;
+const int statsSummaryColumns = 8;	// Columns listed by ColumnStats::summary()
+const int statsStateFields = 10;	// Of a column's state, before its bins
+
+
+//! Running statistics of one output column, kept in the unit the column is
+//! written in: raw counts for counter columns, volts for the others. The
+//! other unit is found from the column's linear scale only when the
+//! statistics are written, so each value is looked at once.
+//! Mean and spread are kept as a mean and a sum of squared deviations, which
+//! are merged exactly across blocks and threads.
+class ColumnAccumulator
+{
+	void combine(quint64 count, double mean, double m2, double minimum,
+				 double maximum);
+	void addHistogram(const double *values, int count);
+
+public:
+	ColumnAccumulator();
+	void setup(const OutputColumn &output, const PlanColumn &source);
+	void add(const double *values, int count);
+	void addCounts(const quint64 *values, int count);
+	void merge(const ColumnAccumulator &other);
+	double stddev() const;
+	double toVolts(double counts) const;
+	double toCounts(double volts) const;
+
+	bool counter;		// Written as raw counts rather than volts
+	bool isSigned;		// Raw values are sign-extended
+	bool isFloat;		// Written as read, with no raw scale
+	double voltsPerCount;	// volts = counts * voltsPerCount + zeroVolts
+	double zeroVolts;
+	quint64 count;		// Values in the statistics
+	quint64 nonFinite;	// NaN and infinite floats, left out of them
+	double minimum;
+	double maximum;
+	quint64 rawMinimum;	// Exact extremes of a counter column, as read
+	quint64 rawMaximum;
+	double mean;
+	double m2;			// Sum of squared deviations from the mean
+	double low;			// Range of the histogram, in the written unit
+	double high;
+	double binScale;	// Histogram bins per unit
+	quint64 below;		// Values outside the range of the histogram
+	quint64 above;
+	QVector<quint64> bins;
+};
+
+
+//! Minimum, maximum, mean, standard deviation and a histogram of every
+//! output column of a job, in both raw counts and volts. Gathered from the
+//! decoded blocks while they are formatted, one ColumnStats per chunk, and
+//! merged into the job's under its lock, so the values are read only once.
+//! The standard deviation is that of the whole population of values. Float
+//! columns have no raw scale, so both of their units give the value.
+//! A resumable job keeps the statistics of the rows it has converted in its
+//! checkpoint, as state(), so the next run carries on from them.
+class ColumnStats
+{
+	QVector<ColumnAccumulator> columns;
+	QStringList names;
+
+public:
+	ColumnStats();
+	void setup(const QVector<OutputColumn> &outputs, const DecodePlan &plan);
+	void add(const DecodedBlock &block);
+	void merge(const ColumnStats &other);
+	int columnCount() const { return columns.size(); }
+	const ColumnAccumulator &column(int col) const { return columns.at(col); }
+	QString summary() const;
+	QByteArray toJson() const;
+	bool write(const QString &fileURI) const;
+	QString state() const;
+	bool restoreState(const QString &text);
+
+	static QString pathFor(const QString &outfilePath);
+};
+
+#endif // COLUMNSTATS_H
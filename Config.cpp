@@ -17,8 +17,17 @@
 Config::Config()
 {
 	this->limitRows = DEFAULT_LIMIT_ROWS;
+	this->decimation = DEFAULT_DECIMATION;
+	this->checksum = DEFAULT_CHECKSUM;
+	this->lengthByte = DEFAULT_LENGTH_BYTE;
+	this->columnStats = DEFAULT_COLUMN_STATS;
 	this->colCount = DEFAULT_COLUMN_COUNT;
 	this->boxOpen = DEFAULT_BOX_OPEN;
+	this->previewOpen = DEFAULT_PREVIEW_OPEN;
+	this->swapBytes = DEFAULT_SWAP_BYTES;
+	this->writeColNames = DEFAULT_WRITE_COLUMN_NAMES;
+	this->minVoltage = DEFAULT_MIN_VOLTAGE;
+	this->maxVoltage = DEFAULT_MAX_VOLTAGE;
 }
 
 
@@ -120,11 +129,34 @@ void Config::parseOptionsElement(const QDomElement &element)
 		tagName = child.toElement().tagName();
 		text = child.toElement().text().trimmed();
 		if(tagName == "openbox" && text == "checked") this->boxOpen = true;
+		else if(tagName == "preview")
+			this->previewOpen = (text == "checked");
 		else if(tagName == "columncount") {
 			int temp = text.toInt();
 			if(temp > 0 && temp <= 255) this->colCount = temp;
 		}
 		else if(tagName == "limitrows") this->limitRows = text;
+		else if(tagName == "decimation") this->decimation = text;
+		else if(tagName == "rowfilter") this->rowFilter = text;
+		else if(tagName == "syncword") this->syncWord = text;
+		else if(tagName == "lengthbyte")
+			this->lengthByte = (text == "checked");
+		else if(tagName == "checksum") this->checksum = text;
+		else if(tagName == "columnstats")
+			this->columnStats = (text == "checked");
+		else if(tagName == "swapbytes") this->swapBytes = (text == "checked");
+		else if(tagName == "columnnames")
+			this->writeColNames = (text == "checked");
+		else if(tagName == "minvoltage") {
+			bool ok;
+			double temp = text.toDouble(&ok);
+			if(ok) this->minVoltage = temp;
+		}
+		else if(tagName == "maxvoltage") {
+			bool ok;
+			double temp = text.toDouble(&ok);
+			if(ok) this->maxVoltage = temp;
+		}
 		child = child.nextSibling();
 	}
 }
@@ -135,13 +167,15 @@ void Config::parseOptionsElement(const QDomElement &element)
 void Config::parseColumnElement(const QDomElement &element)
 {
 	QDomNode child = element.firstChild();
-	QString index, name, bytecount, counterbox;
+	QString index, name, bytecount, counterbox, exportbox, type;
 	while(!child.isNull()) {
 
 		index = child.toElement().attribute("index", "0");
 		name = child.toElement().attribute("name", "0");
 		bytecount = child.toElement().attribute("bytes", "1");
 		counterbox = child.toElement().attribute("counterbox", "0");
+		exportbox = child.toElement().attribute("exportbox", "checked");
+		type = child.toElement().attribute("type", "unsigned");
 
 		QDomNode colChild = child.firstChild();
 		QString innerTagName, innerText;
@@ -156,6 +190,8 @@ void Config::parseColumnElement(const QDomElement &element)
 		colBytes.append(quint8(bytecount.toInt()));
 		if(counterbox == "checked") colBoxChecked.append(true);
 		else colBoxChecked.append(false);
+		colExport.append(exportbox != "unchecked");
+		colType.append(type);
 		colNames.append(sl);
 		child = child.nextSibling();
 	}
@@ -226,8 +262,20 @@ void Config::xmlWriteOptions(QXmlStreamWriter &xml)
 {
 	xml.writeStartElement("options");
 	xml.writeTextElement("openbox", boxOpen ? "checked" : "unchecked");
+	xml.writeTextElement("preview", previewOpen ? "checked" : "unchecked");
 	xml.writeTextElement("limitrows", limitRows);
+	xml.writeTextElement("decimation", decimation);
+	xml.writeTextElement("rowfilter", rowFilter);
+	xml.writeTextElement("syncword", syncWord);
+	xml.writeTextElement("lengthbyte", lengthByte ? "checked" : "unchecked");
+	xml.writeTextElement("checksum", checksum);
+	xml.writeTextElement("columnstats", columnStats ? "checked" : "unchecked");
 	xml.writeTextElement("columncount", QString::number(colCount));
+	xml.writeTextElement("swapbytes", swapBytes ? "checked" : "unchecked");
+	xml.writeTextElement("columnnames",
+						 writeColNames ? "checked" : "unchecked");
+	xml.writeTextElement("minvoltage", QString::number(minVoltage));
+	xml.writeTextElement("maxvoltage", QString::number(maxVoltage));
 	xml.writeEndElement();
 }
 
@@ -243,6 +291,9 @@ void Config::xmlWriteColumns(QXmlStreamWriter &xml)
 		xml.writeAttribute("bytes", QString::number(colBytes.at(counter)));
 		xml.writeAttribute("counterbox",
 						   colBoxChecked.at(counter) ? "checked" : "unchecked");
+		xml.writeAttribute("exportbox", colExport.value(counter, true) ?
+							   "checked" : "unchecked");
+		xml.writeAttribute("type", colType.value(counter, "unsigned"));
 		for(int names = 0; names < colNames.at(counter).size(); ++names) {
 			QString tmp = colNames.at(counter).at(names);
 			xml.writeTextElement("name", colNames.at(counter).at(names));
@@ -259,7 +310,12 @@ void Config::clear()
 	pathlistInfile.clear();
 	pathlistOutfile.clear();
 	limitRows.clear();
+	rowFilter.clear();
+	syncWord.clear();
+	checksum = DEFAULT_CHECKSUM;
 	colNames.clear();
 	colBoxChecked.clear();
+	colExport.clear();
+	colType.clear();
 	colBytes.clear();
 }
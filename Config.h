@@ -16,12 +16,20 @@
 #include <QFile>
 #include <QStringList>
 #include <QMultiMap>
-#include <QLabel>
 
 // Globals
 const bool DEFAULT_BOX_OPEN = false;
+const bool DEFAULT_PREVIEW_OPEN = false;
+const bool DEFAULT_SWAP_BYTES = true;
+const bool DEFAULT_WRITE_COLUMN_NAMES = true;
+const double DEFAULT_MIN_VOLTAGE = 0.0;
+const double DEFAULT_MAX_VOLTAGE = 5.0;
 const quint8 DEFAULT_COLUMN_COUNT = 0;
 const char DEFAULT_LIMIT_ROWS[] = "0";
+const char DEFAULT_DECIMATION[] = "first";
+const bool DEFAULT_LENGTH_BYTE = false;
+const char DEFAULT_CHECKSUM[] = "none";
+const bool DEFAULT_COLUMN_STATS = true;
 const char DEFAULT_START_ELEMENT[] = "charles_n_burns-data_parser";
 
 class Config
@@ -46,12 +54,25 @@ public:
 	void clear();
 
 	QString limitRows;
+	QString decimation;	// How rows are reduced to the row limit
+	QString rowFilter;	// Expression rows must match, or empty for all
+	QString syncWord;	// Hex bytes starting each frame, or empty if unframed
+	QString checksum;	// Of each frame; see FrameFormat::checksumFromName()
+	bool lengthByte;	// Each frame has a length byte after its sync word
+	bool columnStats;	// Write the output's column statistics; see ColumnStats
 	QStringList pathlistInfile;
 	QStringList pathlistOutfile;
 	QList<QStringList> colNames;
 	QList<quint8> colBytes;
 	QList<bool> colBoxChecked;
+	QList<bool> colExport;	// Columns written to the output file
+	QStringList colType;	// "unsigned", "signed" or "float"
 	bool boxOpen;
+	bool previewOpen;	// The preview of decoded rows is shown
+	bool swapBytes;
+	bool writeColNames;
+	double minVoltage;
+	double maxVoltage;
 	quint8 colCount;
 };
 
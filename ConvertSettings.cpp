@@ -0,0 +1,187 @@
+/*
+	Name        : ConvertSettings.cpp
+	Author      : Charles N. Burns (charlesnburns|gmail|com / burnchar|isu|edu)
+	Date        : October 2026
+	License     : GPL3. See license.txt or www.gnu.org/licenses/gpl-3.0.txt
+	Requirements: Qt 4, data to parse, any spreadsheet program.
+	Notes       : Best viewed with tab width 4.
+	Description : The ConvertSettings class holds everything a conversion job
+				  needs to know, so the decoder and the engine share it
+				  without depending on each other.
+*/
+
+#include "ConvertSettings.h"
+#include "CsvFormatter.h"
+#include <QFileInfo>
+
+//! Constructor for ConvertSettings class
+ConvertSettings::ConvertSettings()
+{
+	this->byteSwap = DEFAULT_SWAP_BYTES;
+	this->writeColNames = DEFAULT_WRITE_COLUMN_NAMES;
+	this->vMin = DEFAULT_MIN_VOLTAGE;
+	this->vMax = DEFAULT_MAX_VOLTAGE;
+	this->rowLimit = 0;
+	this->threads = 0;
+	this->precision = defaultPrecision;
+	this->format = Csv;
+	this->compression = Decompressor::Uncompressed;
+	this->decimation = Decimator::KeepFirst;
+	this->follow = false;
+	this->resume = false;
+	this->columnStats = true;
+}
+
+
+//! Chooses the output format from a file name's extension. Files ending in
+//! .arrow, .feather or .ipc are Arrow IPC files; anything else is CSV.
+//! A compression extension is skipped; see compressionForPath().
+ConvertSettings::Format ConvertSettings::formatForPath(const QString &path)
+{
+	QFileInfo info(path);
+	QString suffix = info.suffix().toLower();
+	if(compressionForPath(path) != Decompressor::Uncompressed)
+		suffix = QFileInfo(info.completeBaseName()).suffix().toLower();
+	if(suffix == "arrow" || suffix == "feather" || suffix == "ipc")
+		return Arrow;
+	return Csv;
+}
+
+
+//! Chooses the output compression from a file name's extension. Files
+//! ending in .gz are gzip files, and .zst zstd files, as in "out.csv.gz".
+Decompressor::Compression ConvertSettings::compressionForPath(
+		const QString &path)
+{
+	QString suffix = QFileInfo(path).suffix().toLower();
+	if(suffix == "gz") return Decompressor::Gzip;
+	if(suffix == "zst") return Decompressor::Zstd;
+	return Decompressor::Uncompressed;
+}
+
+
+//! Copies the column layout and options stored in a Config object.
+//! The first name in each column's name history is used as the column name.
+//! @param config A Config object which has already been read and parsed
+//! @returns false if the Config holds no usable column layout, true otherwise
+bool ConvertSettings::fromConfig(const Config &config)
+{
+	bool retval = true;
+	int count = config.colCount;
+	colNames.clear();
+	colBytes.clear();
+	colCounter.clear();
+	colType.clear();
+	colExport.clear();
+
+	if(count < 1 || config.colBytes.size() < count) {
+		errorMessage = "The settings file does not describe any data columns.";
+		retval = false;
+	}
+	else {
+		for(int index = 0; index < count; ++index) {
+			quint8 bytes = config.colBytes.at(index);
+			PlanColumn::Type type =
+					DecodePlan::typeFromName(config.colType.value(index));
+			if(!DecodePlan::typeFits(type, bytes)) {
+				errorMessage = QString("Column %1 has an invalid byte count "
+									   "for a %2 column: %3")
+						.arg(index + 1).arg(DecodePlan::typeName(type))
+						.arg(bytes);
+				retval = false;
+				break;
+			}
+			colBytes.append(bytes);
+			colType.append(type);
+			if(config.colNames.size() > index &&
+			   ! config.colNames.at(index).isEmpty())
+				colNames.append(config.colNames.at(index).first().trimmed());
+			else colNames.append(QString());
+			if(config.colBoxChecked.size() > index)
+				colCounter.append(config.colBoxChecked.at(index));
+			else colCounter.append(false);
+			if(config.colExport.size() > index)
+				colExport.append(config.colExport.at(index));
+			else colExport.append(true);
+		}
+	}
+	byteSwap = config.swapBytes;
+	writeColNames = config.writeColNames;
+	vMin = config.minVoltage;
+	vMax = config.maxVoltage;
+	rowLimit = config.limitRows.trimmed().toULongLong();
+	decimation = Decimator::modeFromName(config.decimation);
+	rowFilter = config.rowFilter;
+	framing = FrameFormat();
+	if(!framing.setSyncHex(config.syncWord)) {
+		errorMessage = QString("The sync word is not valid hex: %1")
+				.arg(config.syncWord);
+		retval = false;
+	}
+	framing.lengthByte = config.lengthByte;
+	framing.checksum = FrameFormat::checksumFromName(config.checksum);
+	columnStats = config.columnStats;
+	return retval;
+}
+
+
+//! @returns The number of columns in each row of input data
+int ConvertSettings::colCount() const
+{
+	return colBytes.size();
+}
+
+
+//! Computes the sum of bytes in the columns of any one row of input data.
+//! @returns the number of bytes
+int ConvertSettings::rowDataSize() const
+{
+	int accumulator = 0;
+	for(int index = 0; index < colBytes.size(); ++index)
+		accumulator += colBytes.at(index);
+	return accumulator;
+}
+
+
+//! @returns Whether a column is written to the output file. Columns which
+//!			 are not are still part of each row, but are never decoded.
+bool ConvertSettings::isExported(int col) const
+{
+	return colExport.value(col, true);
+}
+
+
+//! @returns How a column's bytes are read
+PlanColumn::Type ConvertSettings::typeOf(int col) const
+{
+	return colType.value(col, PlanColumn::Unsigned);
+}
+
+
+//! @returns The first column whose byte count does not fit its type, such
+//!			 as a float of 3 bytes, or -1 if every column is valid
+int ConvertSettings::badTypeColumn() const
+{
+	for(int col = 0; col < colBytes.size(); ++col)
+		if(!DecodePlan::typeFits(typeOf(col), colBytes.at(col))) return col;
+	return -1;
+}
+
+
+//! @returns Whether the output can be continued from a checkpoint. Only a
+//! plain CSV file can: an Arrow file cut off at a checkpoint has no footer,
+//! and a compressed one no final block, so neither can be appended to.
+bool ConvertSettings::isResumable() const
+{
+	return format == Csv && compression == Decompressor::Uncompressed;
+}
+
+
+//! @returns The number of columns written to the output file
+int ConvertSettings::exportedCount() const
+{
+	int count = 0;
+	for(int index = 0; index < colBytes.size(); ++index)
+		if(isExported(index)) count += 1;
+	return count;
+}
@@ -0,0 +1,70 @@
+/*
+	Name        : ConvertSettings.h
+	Author      : Charles N. Burns (charlesnburns|gmail|com / burnchar|isu|edu)
+	Date        : October 2026
+	License     : GPL3. See license.txt or www.gnu.org/licenses/gpl-3.0.txt
+	Requirements: Qt 4, data to parse, any spreadsheet program.
+	Notes       : Best viewed with tab width 4.
+	Description : Header file to define the ConvertSettings class.
+*/
+
+#ifndef CONVERTSETTINGS_H
+#define CONVERTSETTINGS_H
+
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include "Config.h"
+#include "DecodePlan.h"
+#include "Decimator.h"
+#include "Decompressor.h"
+#include "FrameIndex.h"
+
+
+//! Everything a conversion job needs to know, independent of any widget.
+//! Filled in by the GUI or from a Config, then copied into a Converter.
+class ConvertSettings
+{
+public:
+	enum Format { Csv, Arrow };
+
+	ConvertSettings();
+	static Format formatForPath(const QString &path);
+	static Decompressor::Compression compressionForPath(const QString &path);
+	bool fromConfig(const Config &config);
+	int colCount() const;
+	int rowDataSize() const;
+	bool isExported(int col) const;
+	int exportedCount() const;
+	PlanColumn::Type typeOf(int col) const;
+	int badTypeColumn() const;
+	bool isResumable() const;
+
+	QString infilePath;
+	QString outfilePath;
+	QStringList colNames;
+	QList<quint8> colBytes;
+	QList<bool> colCounter;
+	QList<PlanColumn::Type> colType;	// Unsigned for every column if empty
+	QList<bool> colExport;	// Columns written out; every column if empty
+	QString rowFilter;	// Expression rows must match; see RowFilter
+	FrameFormat framing;	// Of each row of the input; unframed by default
+	bool byteSwap;
+	bool writeColNames;
+	double vMin;
+	double vMax;
+	quint64 rowLimit;
+	int threads;	// Worker threads, 0 for one per processor core
+	int precision;	// Significant digits of voltages; see roundTripPrecision
+	Format format;	// Of the output file
+	Decompressor::Compression compression;	// Of the output file
+	Decimator::Mode decimation;	// How rows are dropped to meet rowLimit
+	bool follow;	// Keep converting rows appended to the input until cancelled
+	bool resume;	// Continue from the output's checkpoint, and keep one;
+					// only for uncompressed CSV output; see isResumable()
+	bool columnStats;	// Gather ColumnStats, and write them beside the output
+	QString statsPath;	// JSON file for the job's RunStats, if not empty
+	QString errorMessage;
+};
+
+#endif // CONVERTSETTINGS_H
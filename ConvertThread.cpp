@@ -0,0 +1,69 @@
+/*
+	Name        : ConvertThread.cpp
+	Author      : Charles N. Burns (charlesnburns|gmail|com / burnchar|isu|edu)
+	Date        : October 2026
+	License     : GPL3. See license.txt or www.gnu.org/licenses/gpl-3.0.txt
+	Requirements: Qt 4, data to parse, any spreadsheet program.
+	Notes       : Best viewed with tab width 4.
+	Description : The ConvertThread and BatchThread classes run a Converter or
+				  a BatchQueue off the GUI thread.
+*/
+
+#include "ConvertThread.h"
+
+//! Constructor for ConvertThread class
+//! @param settings The job's settings. They are copied, so the caller may
+//!		   change the widgets they came from while the job runs.
+ConvertThread::ConvertThread(const ConvertSettings &settings, QObject *parent)
+	: QThread(parent), converter(settings)
+{
+	this->succeeded = false;
+	// The converter lives on this object's thread but emits from run(), so
+	// these connections are queued and the signals arrive on that thread.
+	connect(&converter, SIGNAL(progressRange(int,int)),
+			this, SIGNAL(progressRange(int,int)));
+	connect(&converter, SIGNAL(progressChanged(int)),
+			this, SIGNAL(progressChanged(int)));
+	connect(&converter, SIGNAL(throughputChanged(double,int)),
+			this, SIGNAL(throughputChanged(double,int)));
+}
+
+
+//! Asks the job to stop. Called directly rather than through the event loop,
+//! which the busy worker thread does not run; see Converter::cancel().
+void ConvertThread::cancel()
+{
+	converter.cancel();
+}
+
+
+//! Thread body: runs the conversion. finished() is emitted afterward.
+void ConvertThread::run()
+{
+	succeeded = converter.run();
+}
+
+
+//! Constructor for BatchThread class
+BatchThread::BatchThread(QObject *parent) : QThread(parent)
+{
+	this->succeeded = false;
+	connect(&queue, SIGNAL(progressRange(int,int)),
+			this, SIGNAL(progressRange(int,int)));
+	connect(&queue, SIGNAL(progressChanged(int)),
+			this, SIGNAL(progressChanged(int)));
+}
+
+
+//! Asks the batch to stop; see BatchQueue::cancel().
+void BatchThread::cancel()
+{
+	queue.cancel();
+}
+
+
+//! Thread body: runs the batch. finished() is emitted afterward.
+void BatchThread::run()
+{
+	succeeded = queue.run();
+}
@@ -0,0 +1,77 @@
+/*
+	Name        : ConvertThread.h
+	Author      : Charles N. Burns (charlesnburns|gmail|com / burnchar|isu|edu)
+	Date        : October 2026
+	License     : GPL3. See license.txt or www.gnu.org/licenses/gpl-3.0.txt
+	Requirements: Qt 4, data to parse, any spreadsheet program.
+	Notes       : Best viewed with tab width 4.
+	Description : Header file to define the ConvertThread and BatchThread
+				  classes.
+*/
+
+#ifndef CONVERTTHREAD_H
+#define CONVERTTHREAD_H
+
+#include <QThread>
+#include "Converter.h"
+#include "BatchQueue.h"
+
+//! Runs one conversion job on its own thread, so the GUI stays responsive.
+//! The job works on a copy of the settings taken when the thread is created.
+//! The converter's signals are re-emitted by this object, on the thread which
+//! created it, so they may be connected straight to widgets.
+class ConvertThread : public QThread
+{
+	Q_OBJECT
+
+	Converter converter;
+	bool succeeded;
+
+protected:
+	void run();
+
+public:
+	explicit ConvertThread(const ConvertSettings &settings,
+						   QObject *parent = 0);
+	bool wasSuccessful() const { return succeeded; }
+	bool wasCancelled() const { return converter.wasCancelled(); }
+	QString errorMessage() const { return converter.errorMessage; }
+	RunStats runStats() const { return converter.runStats(); }
+	ColumnStats columnStats() const { return converter.columnStatistics(); }
+
+public slots:
+	void cancel();
+
+signals:
+	void progressRange(int minimum, int maximum);
+	void progressChanged(int steps);
+	void throughputChanged(double rowsPerSecond, int secondsRemaining);
+};
+
+
+//! Runs a batch of conversion jobs on its own thread, as ConvertThread runs
+//! one. The queue is filled before the thread is started.
+class BatchThread : public QThread
+{
+	Q_OBJECT
+
+	BatchQueue queue;
+	bool succeeded;
+
+protected:
+	void run();
+
+public:
+	explicit BatchThread(QObject *parent = 0);
+	BatchQueue &batch() { return queue; }
+	bool wasSuccessful() const { return succeeded; }
+
+public slots:
+	void cancel();
+
+signals:
+	void progressRange(int minimum, int maximum);
+	void progressChanged(int files);
+};
+
+#endif // CONVERTTHREAD_H
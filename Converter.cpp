@@ -0,0 +1,1099 @@
+/*
+	Name        : Converter.cpp
+	Author      : Charles N. Burns (charlesnburns|gmail|com / burnchar|isu|edu)
+	Date        : October 2026
+	License     : GPL3. See license.txt or www.gnu.org/licenses/gpl-3.0.txt
+	Requirements: Qt 4, data to parse, any spreadsheet program.
+	Notes       : Best viewed with tab width 4.
+	Description : The Converter class does all parsing and file I/O needed to
+				  turn a binary data file into a .CSV file. It only knows about
+				  a ConvertSettings object, so it runs the same way from the
+				  GUI, from the command line, or from a batch job.
+*/
+
+#include "Converter.h"
+
+//! Constructor for MemoryBudget class
+//! @param bytes The most memory the jobs sharing it may hold at once
+MemoryBudget::MemoryBudget(quint64 bytes)
+{
+	this->totalKiB = int(qBound(Q_UINT64_C(1), bytes >> 10,
+								quint64(INT_MAX)));
+	freeKiB.release(totalKiB);
+}
+
+
+//! Takes memory from the budget, waiting until enough is free. A request
+//! for more than the whole budget takes the whole budget, so a job never
+//! waits forever; it then runs alone.
+//! @param bytes Memory needed
+//! @returns What was taken, to be passed to release()
+int MemoryBudget::acquire(quint64 bytes)
+{
+	int kiB = int(qBound(Q_UINT64_C(1), (bytes + 1023) >> 10,
+						 quint64(totalKiB)));
+	freeKiB.acquire(kiB);
+	return kiB;
+}
+
+
+//! Gives back memory taken by acquire().
+void MemoryBudget::release(int kiB)
+{
+	freeKiB.release(kiB);
+}
+
+
+//! Constructor for Converter class. The settings are copied and never change.
+Converter::Converter(const ConvertSettings &settings, QObject *parent)
+	: QObject(parent), settings(settings), serialText(settings.precision),
+	  inputHash(QCryptographicHash::Sha1)
+{
+	this->inputHashed = 0;
+	this->stride = 0;
+	this->divCount = 1;
+	this->fullRows = 0;
+	this->partialBytes = 0;
+	this->budget = 0;
+	this->chunkRows = 1;
+	this->waveChunks = 1;
+	this->parallel = false;
+	this->following = false;
+	this->streaming = false;
+	this->firstKept = 0;
+	this->checkpointDirty = false;
+	this->columnStatsPartial = false;
+	this->rowTextBytes = 0;
+	this->rowsOutput = 0;
+	this->lastProgressMs = 0;
+	this->progressRows = 0;
+}
+
+
+//! Asks a running conversion to stop. The partial output file is removed,
+//! unless the job is following a growing input file.
+//! Safe to call directly from any thread; workers notice within one block.
+void Converter::cancel()
+{
+	cancelRequested.fetchAndStoreOrdered(1);
+	QMutexLocker locker(&followMutex);
+	followWake.wakeAll();
+}
+
+
+//! @returns Rows done as a step of progressSteps, of progressRows in all.
+//! Row counts can overflow the int of a progress bar, so steps are shown.
+int Converter::progressStep(quint64 rows) const
+{
+	if(progressRows == 0) return 0;
+	return int(double(qMin(rows, progressRows)) * progressSteps / progressRows);
+}
+
+
+//! Emits progress, throughput and time remaining, at most once per
+//! progressIntervalMs so a fast conversion does not flood the GUI thread.
+//! @param kept Rows of input converted so far
+//! @param keepRows Rows of input the job will convert in total
+//! @param force True to emit even if the last report was very recent
+void Converter::reportProgress(quint64 kept, quint64 keepRows, bool force)
+{
+	qint64 elapsed = progressClock.elapsed();
+	if(!force && elapsed - lastProgressMs < progressIntervalMs) return;
+	lastProgressMs = elapsed;
+	emit progressChanged(progressStep(rowsOutput + stats.rowsFiltered));
+	if(elapsed > 0 && kept > firstKept) {
+		double rowsPerSecond = (kept - firstKept) * 1000.0 / elapsed;
+		int secondsRemaining = int((keepRows - kept) / rowsPerSecond + 0.5);
+		if(streaming) secondsRemaining = -1;	// Unknown
+		emit throughputChanged(rowsPerSecond, secondsRemaining);
+	}
+}
+
+
+//! Computes number of rows in a file based on its size and bytes per row.
+//! @param fileSize Size of the input file in bytes
+//! @param rowSize Size of one row of input data in bytes
+//! @returns The number of rows, counting a trailing partial row as a row
+quint64 Converter::numberRows(quint64 fileSize, int rowSize)
+{
+	quint64 rows = 0;
+	if(rowSize > 0) {
+		rows = fileSize / rowSize;
+		if(fileSize % rowSize != 0) rows += 1; // Don't ignore partial rows
+	}
+	return rows;
+}
+
+
+//! Finds the integer by which the row count must divide to stay within limits.
+//! For example, if there are 200 rows, and the row limit is 50, returns 4
+//! @param rows Number of rows in the input file
+//! @param rowLimit Maximum number of rows in the output file, 0 for no limit
+//! @param writeColNames True if the first output row holds column names
+//! @returns That integer
+quint64 Converter::rowLimitDivisor(quint64 rows, quint64 rowLimit,
+								   bool writeColNames)
+{
+	quint64 divider = 1;
+	quint64 start;
+	if((rowLimit < rows) && (rows > 0) && (rowLimit > 0)) {
+		if(writeColNames) rows += 1;
+		start = rows / (rowLimit + 1);
+		for(divider = start; ((rows / divider) > rowLimit); divider += 1);
+	}
+	return divider;
+}
+
+
+//! Converts a raw unsigned integer value range [0, 2^numBits] to a voltage.
+//! Assumes that vMax > vMin
+//! @param value One piece of the raw uninterpreted data from the source file
+//! @param numBytes The size of value in number of bytes
+//! @param vMin If device outputs between 1.1v and 5.5v, this is the 1.1v
+//! @param vMax If device outputs between 1.1v and 5.5v, this is the 5.1v
+//! @returns The computed voltage in the range [vMin, vMax]
+double Converter::rawIntToVoltage(const quint64 value, const int numBytes,
+								  const double vMin, const double vMax)
+{
+	double range = vMax - vMin;
+	// Corrected bug reported by Riley Pack, 26 Jan 2010
+	//	quint64 maxVal = 1 << (numBytes << 3); // pow(2,(bits in numBytes))
+	// An int shift overflowed for 4 or more bytes; see maxRawValue()
+	quint64 maxVal = DecodePlan::maxRawValue(numBytes);
+
+	return (value / (maxVal / range)) + vMin;
+}
+
+
+//! Opens both input and output files for processing.
+//! @param input Unopened MappedInput object representing input file.
+//! @param outfile Unassociated QFile object representing output file.
+//! @returns True if there was an error opening either one, false otherwise.
+//! @see run()
+bool Converter::openFiles(MappedInput &input, QFile &outfile)
+{
+	bool errorState = false;
+	if(!input.open(settings.infilePath)) {
+		errorMessage = input.errorMessage;
+		errorState = true;
+	}
+	else {
+		QIODevice::OpenMode mode = QIODevice::WriteOnly;
+		if(settings.format == ConvertSettings::Csv &&
+		   settings.compression == Decompressor::Uncompressed)
+			mode |= QIODevice::Text;
+		// Keep the old output until resume() has checked it against its
+		// checkpoint. resume() empties the file if it cannot be continued.
+		if(settings.resume) mode |= QIODevice::ReadOnly;
+		outfile.setFileName(settings.outfilePath);
+		if(!outfile.open(mode)) {
+			errorMessage = tr("Cannot open output file for writing.");
+			errorState = true;
+		}
+		else {
+			QFileInfo ifinfo(input.device());
+			QFileInfo ofinfo(outfile);
+			if(ifinfo.canonicalFilePath() == ofinfo.canonicalFilePath()) {
+				errorMessage = tr(
+						"Input and output files must not be the same file!");
+				errorState = true;
+			}
+		}
+	}
+	return errorState;
+}
+
+
+//! Writes the first row of the output file -- the names of each column.
+//! @param ts QTextStream object already associated with an output file
+//! @returns True if column names were written, false otherwise
+//! @see run()
+bool Converter::writeColumnNames(QTextStream &ts)
+{
+	bool retval = false;
+	for(int index = 0; index < outputs.size(); ++index) {
+		ts << outputs.at(index).name << ',';
+		retval = true;
+	}
+	ts << endl;
+	return retval;
+}
+
+
+//! Writes the decoded values of a block of rows as CSV text.
+//! @param block Values of the output columns
+//! @param out Formatter collecting the output text
+//! @see formatChunk()
+void inline Converter::formatBlock(const DecodedBlock &block,
+								   CsvFormatter &out) const
+{
+	int columns = outputs.size();
+	const OutputColumn *column = outputs.constData();
+	for(int row = 0; row < block.rows; ++row) {
+		out.reserve(rowTextBytes);
+		for(int col = 0; col < columns; ++col) {
+			if(column[col].kind == PlanColumn::Voltage)
+				out.appendDouble(block.realColumn(col)[row]);
+			else if(column[col].type == PlanColumn::Signed)
+				out.appendInt(qint64(block.rawColumn(col)[row]));
+			else out.appendUInt(block.rawColumn(col)[row]);
+			out.append(',');
+		}
+		out.append('\n');
+	}
+}
+
+
+//! Decodes the next block of output rows of a chunk: kept rows, then the
+//! partial row, or when decimating by aggregate, reduced buckets.
+//! @param chunk The chunk being decoded
+//! @param done Rows of the chunk already decoded; advanced by this call
+//! @param block Receives the rows. Must be resized for the output columns.
+//! @param state Decimator working space, fresh for each chunk
+//! @param filtered Rows the row filter dropped; advanced by this call
+//! @returns false once the whole chunk has been decoded, or if cancelled
+bool Converter::decodeNext(const RowChunk &chunk, quint64 &done,
+						   DecodedBlock &block, DecimatorState &state,
+						   quint64 &filtered) const
+{
+	// The output is discarded anyway, except when following, where every
+	// chunk of a wave is finished so the output has no gaps
+	if(cancelRequested != 0 && !following) return false;
+	int rows = 0;
+	if(done < chunk.count) rows = qMin(chunk.count - done,
+									   quint64(decodeBlockRows));
+	if(decimator.isAggregate()) {
+		if(rows < 1) return false;
+		const uchar *data = chunk.data ? chunk.data + done * stride : 0;
+		decimator.reduce(data, chunk.first + done, rows, block, state);
+	}
+	else if(rows > 0) plan.decode(chunk.data + done * stride, stride, rows,
+								  block);
+	else if(chunk.partial != 0 && done == chunk.count)
+		plan.decode(chunk.partial, stride, 1, block);
+	else return false;
+	done += block.rows;
+	filtered += filter.apply(block);
+	return true;
+}
+
+
+//! Formats a chunk of rows as CSV text. Touches no shared state, so chunks
+//! may be formatted on any number of threads at once.
+//! @param chunk The rows to format
+//! @param out Formatter which receives the text of those rows
+void Converter::formatChunk(const RowChunk &chunk, CsvFormatter &out) const
+{
+	DecodedBlock block;
+	DecimatorState state;
+	block.resize(qMax(outputs.size(), plan.columnCount()));
+	ColumnStats columns;	// Of no columns if not wanted
+	if(settings.columnStats) columns.setup(outputs, plan);
+	quint64 done = 0;
+	quint64 filtered = 0;
+	QElapsedTimer clock;
+	qint64 decodeNs = 0;
+	bool more = true;
+	clock.start();
+	while(more) {
+		qint64 start = clock.nsecsElapsed();
+		more = decodeNext(chunk, done, block, state, filtered);
+		if(more && settings.columnStats) columns.add(block);
+		decodeNs += clock.nsecsElapsed() - start;
+		if(more) formatBlock(block, out);
+	}
+	addChunkStats(decodeNs, clock.nsecsElapsed() - decodeNs, 0, filtered,
+				  &columns);
+}
+
+
+//! Decodes a chunk of rows into one Arrow record batch.
+//! @param chunk The rows to encode
+//! @returns The record batch message, ready for ArrowWriter::writeBatch()
+QByteArray Converter::encodeArrowChunk(const RowChunk &chunk) const
+{
+	ArrowBatch batch(arrowFields, chunk.count + (chunk.partial != 0));
+	DecodedBlock block;
+	DecimatorState state;
+	block.resize(qMax(outputs.size(), plan.columnCount()));
+	ColumnStats columns;	// Of no columns if not wanted
+	if(settings.columnStats) columns.setup(outputs, plan);
+	quint64 done = 0;
+	quint64 filtered = 0;
+	QElapsedTimer clock;
+	qint64 decodeNs = 0;
+	bool more = true;
+	clock.start();
+	while(more) {
+		qint64 start = clock.nsecsElapsed();
+		more = decodeNext(chunk, done, block, state, filtered);
+		if(more && settings.columnStats) columns.add(block);
+		decodeNs += clock.nsecsElapsed() - start;
+		if(more) batch.append(block);
+	}
+	if(cancelRequested != 0) return QByteArray();
+	QByteArray message = batch.message();
+	addChunkStats(decodeNs, clock.nsecsElapsed() - decodeNs, 0, filtered,
+				  &columns);
+	return message;
+}
+
+
+//! Adds the times one chunk took, the rows the row filter dropped from it,
+//! and the statistics of its columns, to the job's statistics. Called once
+//! per chunk, from any thread.
+void Converter::addChunkStats(qint64 decodeNs, qint64 formatNs,
+							  qint64 compressNs, quint64 rowsFiltered,
+							  const ColumnStats *columns) const
+{
+	QMutexLocker locker(&statsMutex);
+	if(columns != 0) columnStats.merge(*columns);
+	stats.decodeNs += decodeNs;
+	stats.formatNs += formatNs;
+	stats.compressNs += compressNs;
+	stats.rowsFiltered += rowsFiltered;
+}
+
+
+//! Formats a chunk of rows into a new buffer, for use on a worker thread.
+//! @param chunk The rows to format
+//! @returns The text of those rows, or for Arrow output their record batch,
+//!			 ready to be written to the output file
+QByteArray Converter::formatChunk(const RowChunk &chunk) const
+{
+	if(settings.format == ConvertSettings::Arrow)
+		return encodeArrowChunk(chunk);
+	CsvFormatter out(settings.precision);
+	formatChunk(chunk, out);
+	return compressText(out.takeText());
+}
+
+
+//! Compresses CSV text as one block of a compressed output file, on the
+//! worker thread which formatted it; see BlockCompressor.
+//! @returns The bytes to write: the text itself if the output is not
+//!			 compressed, or nothing on an error, which sets compressFailed
+QByteArray Converter::compressText(const QByteArray &text) const
+{
+	if(settings.compression == Decompressor::Uncompressed || text.isEmpty())
+		return text;
+	QByteArray block;
+	QElapsedTimer clock;
+	clock.start();
+	if(!BlockCompressor::compress(text, settings.compression, block))
+		compressFailed.fetchAndStoreOrdered(1);
+	addChunkStats(0, 0, clock.nsecsElapsed(), 0);
+	return block;
+}
+
+
+//! Writes formatted output: CSV text as is, Arrow record batches through
+//! the ArrowWriter, which indexes them for the footer.
+//! @returns false on a write error
+bool Converter::writeOutput(QFile &outfile, const QByteArray &bytes)
+{
+	if(settings.format == ConvertSettings::Arrow) {
+		if(cancelRequested != 0) return true; // Batch may be incomplete
+		return arrowOut.writeBatch(bytes);
+	}
+	return outfile.write(bytes) != -1;
+}
+
+
+//! Formats a list of chunks and writes the text to the output file in order.
+//! @param outfile The output file
+//! @param chunks The chunks, in the order they appear in the input file
+//! @param parallel True to format the chunks on the global thread pool
+//! @returns false on a write error, true otherwise
+//! @see run()
+bool Converter::writeChunks(QFile &outfile, const QList<RowChunk> &chunks,
+							bool parallel)
+{
+	bool retval = true;
+	QElapsedTimer clock;
+	clock.start();
+	if(parallel && chunks.size() > 1) {
+		QFuture<QByteArray> future = QtConcurrent::mapped(
+				chunks, ChunkFormatter(this));
+		future.waitForFinished();
+		stats.stallNs += clock.nsecsElapsed();
+		clock.start();
+		for(int index = 0; index < chunks.size() && retval; ++index)
+			retval = writeOutput(outfile, future.resultAt(index));
+		stats.writeNs += clock.nsecsElapsed();
+	}
+	else if(settings.format == ConvertSettings::Arrow ||
+			settings.compression != Decompressor::Uncompressed) {
+		for(int index = 0; index < chunks.size() && retval; ++index) {
+			QByteArray bytes = formatChunk(chunks.at(index));
+			clock.start();
+			retval = writeOutput(outfile, bytes);
+			stats.writeNs += clock.nsecsElapsed();
+		}
+	}
+	else {
+		for(int index = 0; index < chunks.size() && retval; ++index) {
+			serialText.clear();
+			formatChunk(chunks.at(index), serialText);
+			clock.start();
+			retval = (outfile.write(serialText.data(),
+									serialText.size()) != -1);
+			stats.writeNs += clock.nsecsElapsed();
+		}
+	}
+	if(!retval) errorMessage = tr("Error writing output file.");
+	else if(compressFailed != 0) {
+		errorMessage = tr("Cannot compress output file.");
+		retval = false;
+	}
+	return retval;
+}
+
+
+//! Maps the input rows of one wave and splits them into chunks.
+//! @param input The input file
+//! @param kept Kept rows (or buckets) before the wave
+//! @param waveRows Kept rows (or buckets) in the wave
+//! @param chunks Receives the chunks
+//! @returns false if the input could not be mapped
+//! @see run()
+bool Converter::mapWave(MappedInput &input, quint64 kept, quint64 waveRows,
+						QList<RowChunk> &chunks)
+{
+	QElapsedTimer clock;
+	clock.start();
+	quint64 rowSize = plan.rowSize;
+	quint64 firstRow = kept * divCount;
+	quint64 fromRow = firstRow;
+	quint64 toRow;		// One past the last whole row needed
+	quint64 whole = waveRows;
+	const uchar *partial = 0;
+	if(decimator.isAggregate()) {
+		// LTTB also reads the buckets on either side of each chunk
+		quint64 reach = decimator.needsNeighbours() ? 1 : 0;
+		if(kept >= reach) fromRow -= reach * divCount;
+		toRow = (kept + waveRows + reach) * divCount;
+	}
+	else {
+		if(firstRow + (waveRows - 1) * divCount >= fullRows) whole -= 1;
+		if(whole < waveRows) partial = reinterpret_cast<const uchar*>(
+				partialRow.constData());
+		toRow = firstRow + (whole > 0 ? (whole - 1) * divCount + 1 : 0);
+	}
+	if(toRow > fullRows) toRow = fullRows;
+
+	// The trailing partial row is copied by the waves which may read it, in
+	// the same mapping as their rows, as a compressed input cannot go back
+	quint64 tailBytes = 0;
+	if(decimator.isAggregate() ? toRow == fullRows : partial != 0)
+		tailBytes = partialBytes;
+	quint64 mapStart = fromRow * rowSize;
+	quint64 mapEnd = toRow * rowSize;
+	if(tailBytes > 0) mapEnd = fullRows * rowSize + tailBytes;
+
+	const uchar *base = 0;
+	if(mapEnd > mapStart) {
+		// Fetch the wave's rows in one batch: every row when aggregating,
+		// otherwise only the kept ones, and of each only the exported span
+		quint64 spanStart = plan.spanStart;
+		quint64 spanBytes = plan.spanBytes;
+		if(decimator.isAggregate())
+			input.adviseRows(mapStart + spanStart, rowSize, toRow - fromRow,
+							 spanBytes);
+		else input.adviseRows(firstRow * rowSize + spanStart, stride, whole,
+							  spanBytes);
+		const uchar *mapped = input.map(mapStart, mapEnd - mapStart);
+		if(mapped == 0) {
+			errorMessage = input.errorMessage;
+			return false;
+		}
+		if(firstRow < toRow) base = mapped + (firstRow - fromRow) * rowSize;
+		if(tailBytes > 0) memcpy(partialRow.data(),
+								 mapped + (fullRows - fromRow) * rowSize,
+								 tailBytes);
+	}
+
+	chunks.clear();
+	for(quint64 done = 0; done < waveRows; done += chunkRows) {
+		RowChunk chunk;
+		quint64 count = qMin(chunkRows, waveRows - done);
+		chunk.first = kept + done;
+		chunk.count = (whole > done) ? qMin(count, whole - done) : 0;
+		chunk.data = (chunk.count > 0 && base) ? base + done * stride : 0;
+		chunk.partial = (done + count == waveRows) ? partial : 0;
+		chunks.append(chunk);
+	}
+
+	// Input rows from the wave's first row to the next wave's first row,
+	// and how many of them are decoded
+	quint64 lastRow = qMin((kept + waveRows) * divCount, fullRows);
+	quint64 covered = (lastRow > firstRow) ? lastRow - firstRow : 0;
+	quint64 decoded = decimator.isAggregate() ? covered : whole;
+	stats.rowsDecoded += decoded + (partial != 0);
+	stats.rowsSkipped += covered - decoded;
+	stats.bytesRead += decimator.isAggregate() ? (toRow - fromRow) * rowSize
+											   : decoded * rowSize;
+	stats.readNs += clock.nsecsElapsed();
+	return true;
+}
+
+
+//! Describes every setting which changes the output, so a checkpoint is
+//! only used by a job which would write exactly the same output.
+//! @returns A hash of those settings, as hex digits
+QByteArray Converter::layoutHash() const
+{
+	QString layout;
+	QTextStream ts(&layout);
+	for(int col = 0; col < settings.colCount(); ++col) {
+		ts << int(settings.colBytes.at(col)) << (settings.colCounter.at(col) ?
+				'c' : 'v') << (settings.isExported(col) ? "" : "-");
+		if(settings.typeOf(col) != PlanColumn::Unsigned)
+			ts << DecodePlan::typeName(settings.typeOf(col)) << ' ';
+		ts << settings.colNames.value(col) << '\n';
+	}
+	ts << settings.byteSwap << ' ' << settings.writeColNames << ' '
+	   << settings.precision << ' ' << settings.format << '\n';
+	ts << settings.rowFilter.simplified() << '\n';
+	if(settings.framing.isFramed()) {
+		ts << settings.framing.syncHex() << ' ' << settings.framing.lengthByte
+		   << ' ' << FrameFormat::checksumName(settings.framing.checksum)
+		   << '\n';
+	}
+	ts << qSetRealNumberPrecision(17) << settings.vMin << ' ' << settings.vMax
+	   << '\n';
+	ts << Decimator::modeName(decimator.isAggregate() ? settings.decimation :
+							  Decimator::KeepFirst) << ' ' << divCount << ' '
+	   << (decimator.isAggregate() ? chunkRows : 0) << '\n';
+	ts.flush();
+	return QCryptographicHash::hash(layout.toUtf8(),
+									QCryptographicHash::Sha1).toHex();
+}
+
+
+//! Checksums the input converted so far, for a checkpoint. Every byte of it
+//! is checksummed, but only once: each call adds the bytes converted since
+//! the last to a running checksum. Going back, as after a checkpoint which
+//! could not be resumed, starts it over, so resume() reads the whole part
+//! of the input the earlier run converted.
+//! @param offset Bytes of input converted
+//! @param checksum Receives the checksum
+//! @returns false if the input could not be read
+bool Converter::inputChecksum(MappedInput &input, quint64 offset,
+							  QByteArray &checksum)
+{
+	bool retval = (offset <= input.size());
+	if(offset < inputHashed) {
+		inputHash.reset();
+		inputHashed = 0;
+	}
+	while(retval && inputHashed < offset) {
+		quint64 bytes = qMin(offset - inputHashed, checkpointHashBytes);
+		const uchar *data = input.map(inputHashed, bytes);
+		if(data != 0) {
+			inputHash.addData(reinterpret_cast<const char*>(data), int(bytes));
+			inputHashed += bytes;
+		}
+		else retval = false;
+	}
+	if(retval) checksum = inputHash.result().toHex();
+	return retval;
+}
+
+
+//! @returns Whether the input file may still hold the rows converted up to
+//!			 a checkpoint: it is as it was then, or has only grown, as when
+//!			 rows are appended to it. Its checksum tells whether they are.
+bool Converter::inputCanResume(const Checkpoint &saved) const
+{
+	QFileInfo info(settings.infilePath);
+	quint64 size = info.size();
+	return size > saved.inputSize || (size == saved.inputSize &&
+			info.lastModified().toMSecsSinceEpoch() == saved.inputModified);
+}
+
+
+//! Continues the output of an earlier run from its checkpoint, if the layout,
+//! the input converted so far and the output written so far have not changed.
+//! All of the input the earlier run converted is read again to check it.
+//! Output written after the checkpoint, such as a half-written wave, is cut
+//! off. Otherwise the output is emptied, and the job starts over.
+//! @param kept Receives the kept rows already converted
+//! @param keepRows Kept rows the job will convert in total
+//! @returns true if the job continues from the checkpoint
+//! @see run()
+bool Converter::resume(MappedInput &input, QFile &outfile, quint64 &kept,
+					   quint64 keepRows)
+{
+	Checkpoint saved;
+	QByteArray checksum;
+	bool retval = saved.read(checkpointPath) &&
+			saved.layoutHash == checkpoint.layoutHash &&
+			saved.keptRows <= keepRows && inputCanResume(saved) &&
+			inputChecksum(input, saved.inputOffset, checksum) &&
+			checksum == saved.inputChecksum &&
+			Checkpoint::fileChecksum(settings.outfilePath, saved.outputLength,
+									 checksum) &&
+			checksum == saved.outputChecksum;
+	if(retval) retval = outfile.resize(saved.outputLength) &&
+			outfile.seek(saved.outputLength);
+	if(retval) {
+		checkpoint = saved;
+		kept = saved.keptRows;
+		rowsOutput = saved.rowsOutput;
+		// A checkpoint from before column statistics were kept has none
+		columnStatsPartial = !columnStats.restoreState(saved.columnStats);
+		checkpointColumns = columnStats;
+	}
+	else outfile.resize(0);
+	return retval;
+}
+
+
+//! Records that the output can be continued after the given kept row. The
+//! checkpoint is saved at most every checkpointIntervalMs, and when the job
+//! ends, as checksumming and writing it on every wave would cost too much.
+//! @param kept Kept rows converted, and written to the output
+//! @returns false on a write error
+//! @see convertWaves()
+bool Converter::markCheckpoint(MappedInput &input, QFile &outfile,
+							   quint64 kept)
+{
+	if(!outfile.flush()) {	// The checksum reads the file back
+		errorMessage = tr("Error writing output file.");
+		return false;
+	}
+	checkpoint.keptRows = kept;
+	checkpoint.inputOffset = qMin(kept * stride, fullRows * plan.rowSize);
+	checkpoint.outputLength = outfile.size();
+	checkpoint.rowsOutput = rowsOutput;
+	checkpointColumns = columnStats;	// No worker is running
+	checkpointDirty = true;
+	if(checkpointClock.isValid() &&
+	   checkpointClock.elapsed() < checkpointIntervalMs) return true;
+	checkpointClock.start();
+	if(!saveCheckpoint(input)) {
+		errorMessage = checkpoint.errorMessage;
+		return false;
+	}
+	return true;
+}
+
+
+//! Checksums the input and output covered by the last marked checkpoint,
+//! notes the input file's size and modification time, and writes the
+//! checkpoint to the sidecar file.
+//! @returns false on an error
+bool Converter::saveCheckpoint(MappedInput &input)
+{
+	QFileInfo info(settings.infilePath);
+	checkpoint.inputSize = info.size();
+	checkpoint.inputModified = info.lastModified().toMSecsSinceEpoch();
+	bool retval = inputChecksum(input, checkpoint.inputOffset,
+								checkpoint.inputChecksum) &&
+			Checkpoint::fileChecksum(settings.outfilePath,
+									 checkpoint.outputLength,
+									 checkpoint.outputChecksum);
+	if(!retval) checkpoint.errorMessage = tr("Cannot checksum a checkpoint.");
+	else {
+		checkpoint.columnStats = checkpointColumns.state();
+		retval = checkpoint.write(checkpointPath);
+	}
+	checkpointDirty = false;
+	return retval;
+}
+
+
+//! Converts kept rows, a wave at a time, until keepRows have been converted.
+//! @param kept Kept rows converted so far; advanced by this call
+//! @param keepRows Kept rows to convert in total
+//! @returns false on an error, true otherwise, even if cancelled
+//! @see run()
+bool Converter::convertWaves(MappedInput &input, QFile &outfile,
+							 quint64 &kept, quint64 keepRows)
+{
+	bool retval = true;
+	QList<RowChunk> chunks;
+	while(retval && kept < keepRows) {
+		reportProgress(kept, keepRows, kept == firstKept);
+		if(cancelRequested != 0) break;
+		quint64 waveRows = keepRows - kept;
+		if(waveRows > chunkRows * waveChunks)
+			waveRows = chunkRows * waveChunks;
+		// rowTextBytes bounds the text of a row, and an Arrow row is smaller
+		int taken = budget ? budget->acquire(waveRows * rowTextBytes) : 0;
+		quint64 filtered = stats.rowsFiltered;	// No worker is running
+		retval = mapWave(input, kept, waveRows, chunks) &&
+				writeChunks(outfile, chunks, parallel);
+		if(budget) budget->release(taken);
+		if(!retval) break;
+		kept += waveRows;
+		rowsOutput += waveRows - (stats.rowsFiltered - filtered);
+		// The output may be continued after the wave only if no row of it
+		// will be written differently once the input has grown: not a
+		// zero-padded partial row, and not the short or end-point last bucket.
+		// A wave cut short by cancelling is never continued.
+		bool continuable = decimator.isAggregate() ?
+				kept < keepRows : chunks.last().partial == 0;
+		if(cancelRequested != 0 && !following) continuable = false;
+		if(settings.resume && continuable &&
+		   !markCheckpoint(input, outfile, kept)) {
+			retval = false;
+			break;
+		}
+	}
+	return retval;
+}
+
+
+//! Converts a compressed input as it is decompressed, a wave at a time,
+//! as its length is not known until it has all been decompressed. Every row
+//! is kept, as a compressed input has no row limit. The trailing partial
+//! row, if any, is converted once the end has been reached.
+//! @param kept Rows converted so far; advanced by this call
+//! @returns false on an error, true otherwise, even if cancelled
+//! @see run()
+bool Converter::convertStream(MappedInput &input, QFile &outfile,
+							  quint64 &kept)
+{
+	bool retval = true;
+	quint64 rowSize = plan.rowSize;
+	quint64 waveBytes = chunkRows * waveChunks * rowSize;
+	while(retval && cancelRequested == 0) {
+		if(!input.fill((kept + 1) * rowSize + waveBytes)) {
+			errorMessage = input.errorMessage;
+			retval = false;
+			break;
+		}
+		quint64 size = input.size();
+		quint64 rows = size / rowSize;
+		fullRows = rows;
+		if(input.atEnd()) {
+			rows = numberRows(size, rowSize);
+			partialBytes = size - fullRows * rowSize;
+		}
+		if(rows > kept) retval = convertWaves(input, outfile, kept, rows);
+		if(input.atEnd()) break;
+	}
+	return retval;
+}
+
+
+//! Follows an input file which is still being written, like tail -f. Each
+//! time the file grows, its new whole rows are converted and appended to the
+//! output, which is then flushed so other programs see them at once. A
+//! trailing partial row is held back until the rest of it is written.
+//! Between bursts the thread sleeps, checking the file's size only every
+//! followPollMs. That also works on network shares, where change
+//! notifications do not report writes made by other hosts.
+//! @param kept Rows converted so far; advanced by this call
+//! @returns false on an error, true once cancelled
+//! @see run()
+bool Converter::follow(MappedInput &input, QFile &outfile, quint64 &kept)
+{
+	bool retval = outfile.flush();
+	if(!retval) errorMessage = tr("Error writing output file.");
+	while(retval && cancelRequested == 0) {
+		if(!input.refresh()) {
+			errorMessage = input.errorMessage;
+			retval = false;
+			break;
+		}
+		quint64 rows = input.size() / plan.rowSize;
+		if(rows < fullRows) {
+			errorMessage = tr("The data file was truncated while following it.");
+			retval = false;
+		}
+		else if(rows > fullRows) {
+			fullRows = rows;
+			progressRows = rows;
+			retval = convertWaves(input, outfile, kept, rows);
+			if(retval && !outfile.flush()) {
+				errorMessage = tr("Error writing output file.");
+				retval = false;
+			}
+		}
+		else {
+			reportProgress(kept, rows, false);
+			QMutexLocker locker(&followMutex);
+			if(cancelRequested == 0)
+				followWake.wait(&followMutex, followPollMs);
+		}
+	}
+	return retval;
+}
+
+
+//! Converts the input file to an output .CSV or Arrow file.
+//! Rows are decoded directly from a memory mapping of the input file. When
+//! only one in N rows is kept, the rows in between are skipped by moving the
+//! row pointer, and if they are far apart they are never read from disk.
+//! When decimating by aggregate, every row is read, and each bucket of N
+//! becomes one row. Kept rows which fail the row filter are dropped as soon
+//! as they are decoded; see RowFilter.
+//! Kept rows are split into chunks which are formatted in parallel, a wave at
+//! a time, and written in their original order. The output is the same no
+//! matter how many threads are used.
+//! With settings.follow, the job then keeps converting rows appended to the
+//! input until it is cancelled; see follow().
+//! With settings.resume, a plain CSV job continues from the checkpoint an
+//! earlier run left next to the output, if it still matches; see resume().
+//! Other outputs cannot be resumed, and are refused before they are opened.
+//! A CSV file named .gz or .zst is compressed a chunk at a time, by the
+//! thread which formatted the chunk; see compressText().
+//! A framed input is first scanned for its good frames, and only their rows
+//! are converted; bad frames are counted in the job's RunStats.
+//! A compressed input is converted as it is decompressed, in one pass; see
+//! convertStream().
+//! @returns false on any error or if cancelled before following, true
+//!			 otherwise
+bool Converter::run()
+{
+	MappedInput input;
+	QFile outfile;
+	bool retval = true;
+	if(settings.resume && !settings.isResumable()) { // Before it is emptied
+		errorMessage = tr("Only uncompressed CSV output can be resumed.");
+		retval = false;
+	}
+	if(retval) retval = !openFiles(input, outfile);
+	rowsOutput = 0;
+	compressFailed = 0;
+	stats.clear();
+	if(retval && settings.rowDataSize() < 1) {
+		errorMessage = tr("No data columns have been defined.");
+		retval = false;
+	}
+	if(retval && settings.badTypeColumn() >= 0) {
+		int col = settings.badTypeColumn();
+		errorMessage = tr("Column %1 is a float of %2 bytes. Floats must "
+						  "have 2, 4 or 8 bytes.").arg(col + 1)
+				.arg(settings.colBytes.at(col));
+		retval = false;
+	}
+	if(retval && settings.exportedCount() < 1) {
+		errorMessage = tr("No data columns have been selected for export.");
+		retval = false;
+	}
+	if(retval && !filter.parse(settings.rowFilter, settings.colNames)) {
+		errorMessage = filter.errorMessage;
+		retval = false;
+	}
+	if(retval && settings.follow && settings.format != ConvertSettings::Csv) {
+		errorMessage = tr("Only CSV output can follow a growing data file.");
+		retval = false;
+	}
+	if(retval && settings.compression != Decompressor::Uncompressed) {
+		QString name = Decompressor::compressionName(settings.compression);
+		if(settings.format != ConvertSettings::Csv) {
+			errorMessage = tr("Only CSV output can be compressed.");
+			retval = false;
+		}
+		else if(!Decompressor::isSupported(settings.compression)) {
+			errorMessage = tr("This build cannot write %1 compressed files.")
+					.arg(name);
+			retval = false;
+		}
+	}
+	if(retval && input.isCompressed() && (settings.follow || settings.resume)) {
+		errorMessage = tr("A compressed data file can be neither followed "
+						  "nor resumed.");
+		retval = false;
+	}
+	if(retval && input.isCompressed() && settings.rowLimit > 0) {
+		errorMessage = tr("A compressed data file cannot have a row limit, "
+						  "as its rows are not known until it has all been "
+						  "read.");
+		retval = false;
+	}
+	if(retval && settings.framing.isFramed()) {
+		QElapsedTimer clock;
+		clock.start();
+		bool hostBigEndian = (QSysInfo::ByteOrder == QSysInfo::BigEndian);
+		if(!input.setFraming(settings.framing, settings.rowDataSize(),
+							 settings.byteSwap != hostBigEndian)) {
+			errorMessage = input.errorMessage;
+			retval = false;
+		}
+		stats.scanNs = clock.nsecsElapsed();
+	}
+
+	if(retval) {
+		quint64 rowSize = settings.rowDataSize();
+		quint64 fileSize = input.size();
+		quint64 rowLimit = settings.rowLimit;
+		quint64 rows = numberRows(fileSize, rowSize);
+		fullRows = fileSize / rowSize;
+		if(settings.follow) { // The file's final length is not yet known
+			rows = fullRows;	// A partial row waits until it is complete
+			rowLimit = 0;
+		}
+		bool csv = (settings.format == ConvertSettings::Csv);
+		bool header = csv && settings.writeColNames; // Arrow has a schema
+		divCount = rowLimitDivisor(rows, rowLimit, header);
+		plan.compile(settings, filter.columns());
+		if(retval && !filter.compile(plan)) {
+			errorMessage = filter.errorMessage;
+			retval = false;
+		}
+
+		// A trailing partial row is padded with zeros; see mapWave()
+		partialRow.fill('\0', rowSize);
+		partialBytes = (fullRows < rows) ? fileSize - fullRows * rowSize : 0;
+
+		// One in divCount rows is kept, or one per bucket of divCount rows
+		quint64 keepRows = (rows + divCount - 1) / divCount;
+		if(rowLimit > 0) {
+			quint64 room = (rowLimit > quint64(header)) ? rowLimit - header : 0;
+			if(keepRows > room) keepRows = room;
+		}
+		Decimator::Mode mode = settings.decimation;
+		if(divCount < 2) mode = Decimator::KeepFirst;
+		if(retval && mode != Decimator::KeepFirst && filter.isActive()) {
+			errorMessage = tr("A row filter cannot be used while rows are "
+							  "reduced by %1.").arg(Decimator::modeName(mode));
+			retval = false;
+		}
+		decimator.setup(&plan, mode, divCount, fullRows, keepRows,
+						(fullRows < rows) ? reinterpret_cast<const uchar*>(
+								partialRow.constData()) : 0);
+		outputs = decimator.outputColumns(settings.colNames);
+		columnStats.setup(outputs, plan);
+		columnStatsPartial = false;
+		stride = rowSize * divCount;
+		rowTextBytes = outputs.size() * (maxValueTextBytes + 1) + 1;
+
+		int threads = settings.threads;
+		if(threads < 1) threads = QThread::idealThreadCount();
+		if(threads < 1) threads = 1;
+		parallel = (threads > 1);
+		QThreadPool *pool = QThreadPool::globalInstance();
+		if(parallel && pool->maxThreadCount() != threads)
+			pool->setMaxThreadCount(threads);
+		// Arrow batches are never smaller than rowsPerChunk, for efficiency.
+		// Aggregate chunks hold a fixed amount of input, and never depend on
+		// the number of threads, as LTTB's output depends on where they start.
+		// Compressed blocks are never smaller than rowsPerChunk either, as
+		// each is compressed on its own
+		bool compressed = (settings.compression != Decompressor::Uncompressed);
+		chunkRows = (parallel || !csv || compressed) ? rowsPerChunk
+													 : rowsPerProgressUpdate;
+		if(decimator.isAggregate())
+			chunkRows = qMax(Q_UINT64_C(1), inputRowsPerAggregateChunk /
+											divCount);
+		waveChunks = parallel ? threads * chunksPerThread : 1;
+
+		// Each wave must fit within one mapping of the input file. On 64-bit
+		// hosts any part of the file can be mapped, even once it has grown.
+		quint64 window = qMax(input.maxWindowSize(), mappedWindowBytes32);
+		quint64 windowRows = 1;
+		if(decimator.isAggregate()) {
+			quint64 reach = decimator.needsNeighbours() ? 2 : 0;
+			if(window / stride > reach) windowRows = window / stride - reach;
+		}
+		else if(window > rowSize) windowRows = (window - rowSize) / stride + 1;
+		if(chunkRows > windowRows) chunkRows = windowRows;
+		if(chunkRows * waveChunks > windowRows)
+			waveChunks = qMax(Q_UINT64_C(1), windowRows / chunkRows);
+
+		quint64 kept = 0;
+		bool resumed = false;
+		if(!settings.resume) // An old checkpoint no longer applies
+			QFile::remove(Checkpoint::pathFor(settings.outfilePath));
+		else if(retval) {
+			checkpointPath = Checkpoint::pathFor(settings.outfilePath);
+			checkpoint.layoutHash = layoutHash();
+			resumed = resume(input, outfile, kept, keepRows);
+		}
+		if(retval && header && !resumed) {
+			QByteArray names;
+			QTextStream ts(&names, QIODevice::WriteOnly);
+			if(writeColumnNames(ts)) rowsOutput += 1;
+			if(!writeOutput(outfile, compressText(names))) {
+				errorMessage = tr("Error writing output file.");
+				retval = false;
+			}
+		}
+		if(retval && !csv) {
+			arrowFields.clear();
+			for(int col = 0; col < outputs.size(); ++col) {
+				const OutputColumn &output = outputs.at(col);
+				ArrowField field;
+				QString name = output.name.trimmed();
+				const PlanColumn &source = plan.columns.at(output.source);
+				if(name.isEmpty())
+					name = QString("Column %1").arg(source.index + 1);
+				field.name = name.toUtf8();
+				field.isFloat = (output.kind == PlanColumn::Voltage);
+				field.isSigned = (output.type == PlanColumn::Signed);
+				field.bitWidth = field.isFloat ? 64 :
+						ArrowField::bitWidthForBytes(source.bytes);
+				arrowFields.append(field);
+			}
+			if(!arrowOut.begin(&outfile, arrowFields)) {
+				errorMessage = tr("Error writing output file.");
+				retval = false;
+			}
+		}
+
+		// A compressed input's rows are unknown until it has been read, so
+		// its progress is shown as busy.
+		streaming = !input.atEnd();
+		progressRows = streaming ? 0 : rows;
+		if(rowLimit > 0 && rowLimit < progressRows) progressRows = rowLimit;
+		emit progressRange(0, (progressRows > 0) ? progressSteps : 0);
+
+		firstKept = kept;
+		progressClock.start();
+		lastProgressMs = 0;
+		if(retval) retval = convertWaves(input, outfile, kept, keepRows);
+		if(retval && streaming) retval = convertStream(input, outfile, kept);
+		if(retval && cancelRequested == 0 && !input.checkEnd()) {
+			errorMessage = input.errorMessage;
+			retval = false;
+		}
+		if(retval && settings.follow && cancelRequested == 0) {
+			following = true;
+			retval = follow(input, outfile, kept);
+		}
+		if(cancelRequested != 0 && !following) { // Maybe during the last wave
+			errorMessage = tr("Processing cancelled.");
+			retval = false;
+		}
+		if(retval && !csv && !arrowOut.finish()) {
+			errorMessage = tr("Error writing output file.");
+			retval = false;
+		}
+		if(checkpointDirty && !saveCheckpoint(input) && retval) {
+			errorMessage = checkpoint.errorMessage;
+			retval = false;
+		}
+		if(retval) reportProgress(kept, kept, true);
+		stats.elapsedNs = progressClock.nsecsElapsed();
+		stats.rowsOutput = rowsOutput;
+		stats.bytesWritten = outfile.size();
+		stats.framesBad = input.badFrameCount();
+		stats.bytesUnframed = input.unframedBytes();
+		// Statistics of only the rows this run converted would pass for
+		// those of the whole output, so none are better; nor may a sidecar
+		// of an earlier output stay when statistics are not wanted. The
+		// output is complete without them, so a failed write only warns.
+		if(retval && (columnStatsPartial || !settings.columnStats))
+			QFile::remove(ColumnStats::pathFor(settings.outfilePath));
+		else if(retval && !columnStats.write(ColumnStats::pathFor(
+				settings.outfilePath)))
+			stats.warning = tr("Cannot write column statistics file.");
+		if(!settings.statsPath.isEmpty() && !stats.write(settings.statsPath)
+		   && retval) {
+			errorMessage = tr("Cannot write statistics file.");
+			retval = false;
+		}
+	}
+	input.close();
+	outfile.close();
+	// A resumable job keeps its output, to be continued by the next run.
+	// Only plain CSV output gets this far with settings.resume set.
+	if(cancelRequested != 0 && !following && !settings.resume)
+		outfile.remove();
+	return retval;
+}
@@ -0,0 +1,204 @@
+/*
+	Name        : Converter.h
+	Author      : Charles N. Burns (charlesnburns|gmail|com / burnchar|isu|edu)
+	Date        : October 2026
+	License     : GPL3. See license.txt or www.gnu.org/licenses/gpl-3.0.txt
+	Requirements: Qt 4, data to parse, any spreadsheet program.
+	Notes       : Best viewed with tab width 4.
+	Description : Header file to define the MemoryBudget and Converter
+				  classes.
+*/
+
+#ifndef CONVERTER_H
+#define CONVERTER_H
+
+#include <QObject>
+#include <QFile>
+#include <QFileInfo>
+#include <QTextStream>
+#include <QStringList>
+#include <QtEndian>
+#include <QThread>
+#include <QThreadPool>
+#include <QAtomicInt>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QSemaphore>
+#include <QtConcurrentMap>
+#include <cstring>
+#include <climits>
+#include "Config.h"
+#include "Input.h"
+#include "CsvFormatter.h"
+#include "DecodePlan.h"
+#include "ArrowWriter.h"
+#include "Decimator.h"
+#include "Checkpoint.h"
+#include "RunStats.h"
+#include "BlockCompressor.h"
+#include "RowFilter.h"
+#include "ColumnStats.h"
+#include "ConvertSettings.h"
+
+const quint64 rowsPerProgressUpdate = 1024;
+const quint64 rowsPerChunk = 16384;	// Rows formatted by one parallel task
+const int chunksPerThread = 4;		// Parallel tasks per thread per wave
+const int progressIntervalMs = 100;	// Least time between progress signals
+const int progressSteps = 1000;		// Progress signals count per-mille
+const quint64 inputRowsPerAggregateChunk = 1 << 18;	// See Decimator
+const unsigned long followPollMs = 100;	// Checks for new rows when following
+
+
+//! A run of kept rows which is formatted as one piece of the output file.
+//! Row n of the chunk starts at data + n * the converter's row stride.
+//! When decimating by aggregate, each "row" is a whole bucket of rows,
+//! and the Decimator finds the trailing partial row itself.
+struct RowChunk
+{
+	const uchar *data;		// First whole row, or 0 if count is 0
+	quint64 first;			// Index of the first row among all kept rows
+	quint64 count;			// Number of whole rows
+	const uchar *partial;	// Zero-padded trailing partial row, or 0
+};
+
+
+//! Memory which several jobs running at once share for their output, so a
+//! batch of them never holds more than a set amount. Before converting a
+//! wave, a job takes the most its output text may need, waiting while other
+//! jobs hold the rest, and gives it back once the wave is written.
+class MemoryBudget
+{
+	QSemaphore freeKiB;
+	int totalKiB;
+
+public:
+	explicit MemoryBudget(quint64 bytes);
+	int acquire(quint64 bytes);
+	void release(int kiB);
+};
+
+
+//! Converts a binary data file to a .CSV file. Needs no GUI or QApplication.
+//! run() may be called on any thread; signals are then delivered to the
+//! receivers' threads through queued connections, and cancel() may be called
+//! directly from any thread. When following a growing input file, cancel()
+//! stops the job after the rows already read, and the output is kept.
+class Converter : public QObject
+{
+	Q_OBJECT
+
+	bool openFiles(MappedInput &input, QFile &outfile);
+	bool writeColumnNames(QTextStream &ts);
+	void formatBlock(const DecodedBlock &block, CsvFormatter &out) const;
+	bool decodeNext(const RowChunk &chunk, quint64 &done, DecodedBlock &block,
+					DecimatorState &state, quint64 &filtered) const;
+	void formatChunk(const RowChunk &chunk, CsvFormatter &out) const;
+	QByteArray encodeArrowChunk(const RowChunk &chunk) const;
+	bool mapWave(MappedInput &input, quint64 kept, quint64 waveRows,
+				 QList<RowChunk> &chunks);
+	bool writeChunks(QFile &outfile, const QList<RowChunk> &chunks,
+					 bool parallel);
+	bool writeOutput(QFile &outfile, const QByteArray &bytes);
+	QByteArray compressText(const QByteArray &text) const;
+	bool convertWaves(MappedInput &input, QFile &outfile, quint64 &kept,
+					  quint64 keepRows);
+	bool convertStream(MappedInput &input, QFile &outfile, quint64 &kept);
+	bool follow(MappedInput &input, QFile &outfile, quint64 &kept);
+	QByteArray layoutHash() const;
+	bool inputChecksum(MappedInput &input, quint64 offset,
+					   QByteArray &checksum);
+	bool inputCanResume(const Checkpoint &saved) const;
+	int progressStep(quint64 rows) const;
+	bool resume(MappedInput &input, QFile &outfile, quint64 &kept,
+				quint64 keepRows);
+	bool markCheckpoint(MappedInput &input, QFile &outfile, quint64 kept);
+	bool saveCheckpoint(MappedInput &input);
+	void addChunkStats(qint64 decodeNs, qint64 formatNs, qint64 compressNs,
+					   quint64 rowsFiltered,
+					   const ColumnStats *columns = 0) const;
+
+	const ConvertSettings settings;
+	DecodePlan plan;
+	RowFilter filter;
+	Decimator decimator;
+	QVector<OutputColumn> outputs;
+	quint64 stride;			// Bytes from one kept row (or bucket) to the next
+	quint64 divCount;		// Input rows per kept row
+	quint64 fullRows;		// Whole rows in the input file
+	quint64 chunkRows;		// Kept rows per chunk
+	quint64 waveChunks;		// Chunks formatted at once
+	bool parallel;			// True to format chunks on the thread pool
+	QByteArray partialRow;	// Zero-padded trailing partial row, if any
+	quint64 partialBytes;	// Bytes of it in the input; see mapWave()
+	int rowTextBytes;
+	CsvFormatter serialText;
+	QVector<ArrowField> arrowFields;
+	ArrowWriter arrowOut;
+	MemoryBudget *budget;	// Shared with other jobs, or 0 for no limit
+	QAtomicInt cancelRequested;	// Set from any thread, read by every worker
+	mutable QAtomicInt compressFailed;	// Set by any worker, read by the writer
+	bool following;			// Converting rows appended since the job began
+	bool streaming;			// Converting a compressed input of unknown length
+	QMutex followMutex;
+	QWaitCondition followWake;	// Wakes follow() early when cancelled
+	QString checkpointPath;
+	Checkpoint checkpoint;		// Last point the output may be continued from
+	QCryptographicHash inputHash;	// Of the input before inputHashed
+	quint64 inputHashed;		// See inputChecksum()
+	bool checkpointDirty;		// checkpoint has not been saved yet
+	QElapsedTimer checkpointClock;
+	quint64 firstKept;			// Kept rows converted by an earlier run
+	mutable RunStats stats;		// Added to by const workers, under statsMutex
+	mutable ColumnStats columnStats;	// Of the output values, likewise
+	ColumnStats checkpointColumns;	// columnStats at the checkpoint
+	bool columnStatsPartial;	// Missing the rows of an earlier run
+	mutable QMutex statsMutex;
+	quint64 rowsOutput;
+	QElapsedTimer progressClock;
+	qint64 lastProgressMs;
+	quint64 progressRows;	// Rows progressSteps stand for, or 0 if unknown
+
+	void reportProgress(quint64 kept, quint64 keepRows, bool force);
+
+public:
+	QString errorMessage;
+	explicit Converter(const ConvertSettings &settings, QObject *parent = 0);
+	bool run();
+	bool wasCancelled() const { return cancelRequested != 0; }
+	quint64 rowsWritten() const { return rowsOutput; }
+	const RunStats &runStats() const { return stats; }
+	const ColumnStats &columnStatistics() const { return columnStats; }
+	void setMemoryBudget(MemoryBudget *budget) { this->budget = budget; }
+	QByteArray formatChunk(const RowChunk &chunk) const;
+
+	static quint64 numberRows(quint64 fileSize, int rowSize);
+	static quint64 rowLimitDivisor(quint64 rows, quint64 rowLimit,
+								   bool writeColNames);
+	static double rawIntToVoltage(const quint64 value, const int numBytes,
+								  const double vMin = 0.0,
+								  const double vMax = 5.0);
+
+public slots:
+	void cancel();
+
+signals:
+	void progressRange(int minimum, int maximum);
+	void progressChanged(int steps);
+	void throughputChanged(double rowsPerSecond, int secondsRemaining);
+};
+
+
+//! Function object which lets QtConcurrent call Converter::formatChunk()
+struct ChunkFormatter
+{
+	typedef QByteArray result_type;
+	const Converter *converter;
+	ChunkFormatter(const Converter *converter) : converter(converter) {}
+	QByteArray operator()(const RowChunk &chunk) const
+	{
+		return converter->formatChunk(chunk);
+	}
+};
+
+#endif // CONVERTER_H
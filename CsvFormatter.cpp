@@ -0,0 +1,311 @@
+/*
+	Name        : CsvFormatter.cpp
+	Author      : Charles N. Burns (charlesnburns|gmail|com / burnchar|isu|edu)
+	Date        : October 2026
+	License     : GPL3. See license.txt or www.gnu.org/licenses/gpl-3.0.txt
+	Requirements: Qt 4, data to parse, any spreadsheet program.
+	Notes       : Best viewed with tab width 4.
+	Description : The CsvFormatter class turns decoded values into CSV text.
+				  It replaces QTextStream in the conversion loop, which spent
+				  far more time converting numbers to UTF-16 strings and
+				  flushing than the converter spent decoding.
+*/
+
+#include "CsvFormatter.h"
+#include <cmath>
+#include <cstring>
+#include <cfloat>
+
+// The fast path needs exact double arithmetic. x87 extended precision would
+// round the error terms differently, so such builds always use QLocale.
+#if defined(FLT_EVAL_METHOD) && FLT_EVAL_METHOD != 0
+#define CSV_NO_FAST_DOUBLES
+#endif
+
+const int initialBufferBytes = 1 << 16;
+
+//! Exactly representable powers of ten
+static const double powersOf10[] = {
+	1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+	1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+static const quint64 intPowersOf10[] = {
+	Q_UINT64_C(1), Q_UINT64_C(10), Q_UINT64_C(100), Q_UINT64_C(1000),
+	Q_UINT64_C(10000), Q_UINT64_C(100000), Q_UINT64_C(1000000),
+	Q_UINT64_C(10000000), Q_UINT64_C(100000000), Q_UINT64_C(1000000000),
+	Q_UINT64_C(10000000000), Q_UINT64_C(100000000000),
+	Q_UINT64_C(1000000000000), Q_UINT64_C(10000000000000),
+	Q_UINT64_C(100000000000000), Q_UINT64_C(1000000000000000)
+};
+
+//! Two decimal digits for every value from 0 to 99
+static const char digitPairs[] =
+	"00010203040506070809101112131415161718192021222324252627282930313233343536"
+	"37383940414243444546474849505152535455565758596061626364656667686970717273"
+	"74757677787980818283848586878889909192939495969798990";
+
+
+//! Writes the decimal digits of value, right-aligned, ending just before end.
+//! @returns Pointer to the first digit written
+static inline char *writeDigits(char *end, quint64 value)
+{
+	if(value >= 100000000) {	// Eight low digits with 32-bit arithmetic
+		quint32 low = quint32(value % 100000000);
+		value /= 100000000;
+		for(int pairs = 0; pairs < 4; ++pairs) {
+			int pair = (low % 100) * 2;
+			low /= 100;
+			*--end = digitPairs[pair + 1];
+			*--end = digitPairs[pair];
+		}
+		if(value >= 100000000) return writeDigits(end, value);
+	}
+	quint32 small = quint32(value);
+	while(small >= 100) {
+		int pair = (small % 100) * 2;
+		small /= 100;
+		*--end = digitPairs[pair + 1];
+		*--end = digitPairs[pair];
+	}
+	if(small >= 10) {
+		int pair = small * 2;
+		*--end = digitPairs[pair + 1];
+		*--end = digitPairs[pair];
+	}
+	else *--end = char('0' + small);
+	return end;
+}
+
+
+//! Computes a * b and the exact rounding error of that product, so that
+//! product + error == a * b with no rounding at all.
+static inline void twoProduct(double a, double b, double &product,
+							  double &error)
+{
+	product = a * b;
+#if defined(__FMA__) || defined(FP_FAST_FMA)
+	error = fma(a, b, -product);
+#else
+	// Dekker's algorithm: split both factors into 26-bit halves
+	const double splitter = 134217729.0; // 2^27 + 1
+	double temp = splitter * a;
+	double aHigh = temp - (temp - a);
+	double aLow = a - aHigh;
+	temp = splitter * b;
+	double bHigh = temp - (temp - b);
+	double bLow = b - bHigh;
+	error = ((aHigh * bHigh - product) + aHigh * bLow + aLow * bHigh)
+			+ aLow * bLow;
+#endif
+}
+
+
+//! Constructor for CsvFormatter class
+//! @param precision Significant digits for doubles, 1 to 17, or
+//!		   roundTripPrecision for as many digits from 15 up as read back
+//!		   exactly
+CsvFormatter::CsvFormatter(int precision)
+{
+	if(precision < 0 || precision > maxPrecision) precision = defaultPrecision;
+	this->precision = precision;
+	buffer.resize(initialBufferBytes);
+	cursor = buffer.data();
+	limit = cursor + buffer.size();
+}
+
+
+//! Sets the significant digits of the doubles appended from now on.
+//! @param precision As for the constructor
+void CsvFormatter::setPrecision(int precision)
+{
+	if(precision < 0 || precision > maxPrecision) precision = defaultPrecision;
+	this->precision = precision;
+}
+
+
+//! Enlarges the buffer so that at least bytes more bytes can be appended.
+void CsvFormatter::grow(int bytes)
+{
+	int used = size();
+	int newSize = buffer.size() * 2;
+	if(newSize < used + bytes) newSize = used + bytes;
+	if(newSize < initialBufferBytes) newSize = initialBufferBytes;
+	buffer.resize(newSize);
+	cursor = buffer.data() + used;
+	limit = buffer.data() + buffer.size();
+}
+
+
+//! Appends text, such as a column name, making room for it as needed.
+void CsvFormatter::append(const QByteArray &text)
+{
+	reserve(text.size());
+	memcpy(cursor, text.constData(), text.size());
+	cursor += text.size();
+}
+
+
+//! Appends the decimal text of an unsigned integer.
+void CsvFormatter::appendUInt(quint64 value)
+{
+	char digits[24];
+	char *end = digits + sizeof(digits);
+	char *start = writeDigits(end, value);
+	int length = end - start;
+	memcpy(cursor, start, length);
+	cursor += length;
+}
+
+
+//! Appends the decimal text of a signed integer.
+void CsvFormatter::appendInt(qint64 value)
+{
+	if(value < 0) {
+		*cursor++ = '-';
+		appendUInt(0 - quint64(value));	// Also right for the most negative
+	}
+	else appendUInt(quint64(value));
+}
+
+
+//! Appends the text of a double using the formatter's precision.
+void CsvFormatter::appendDouble(double value)
+{
+	if(precision == roundTripPrecision) { // Trailing zeros are dropped, as %g
+		if(!appendDoubleFast(value, defaultPrecision, true)) {
+			// Widened only as far as needed, to at most 17 digits
+			int digits = defaultPrecision;
+			while(digits < maxPrecision &&
+				  QByteArray::number(value, 'g', digits).toDouble() != value)
+				++digits;
+			appendDoubleSlow(value, digits);
+		}
+	}
+	else if(precision > defaultPrecision ||
+			!appendDoubleFast(value, precision, false))
+		appendDoubleSlow(value, precision);
+}
+
+
+//! Appends a double the way QTextStream does, for values the fast path
+//! does not handle, such as NaN, infinity, and very large or small values.
+void CsvFormatter::appendDoubleSlow(double value, int digits)
+{
+	QByteArray text = QByteArray::number(value, 'g', digits);
+	memcpy(cursor, text.constData(), text.size());
+	cursor += text.size();
+}
+
+
+//! Appends a double exactly as printf("%.*g", digits, value) would, using
+//! only integer arithmetic and one exact multiplication.
+//! @param value The value to write
+//! @param digits Significant digits, 1 to 15
+//! @param exactOnly If true, only succeed when the text reads back as value
+//! @returns false, having written nothing, if the value is outside the range
+//!			 the fast path handles; the caller must use appendDoubleSlow()
+bool CsvFormatter::appendDoubleFast(double value, int digits, bool exactOnly)
+{
+#ifdef CSV_NO_FAST_DOUBLES
+	return false;
+#else
+	double magnitude = (value < 0) ? -value : value;
+	if(value == 0) {
+		if(1 / value < 0) *cursor++ = '-';	// Negative zero
+		*cursor++ = '0';
+		return true;
+	}
+	// Also rejects NaN and infinity
+	if(!(magnitude >= 1e-7 && magnitude < 1e15)) return false;
+
+	// Estimate the decimal exponent from the binary one, then correct it
+	int binaryExponent;
+	frexp(magnitude, &binaryExponent);
+	int exponent = int(floor((binaryExponent - 1) * 0.30102999566398120));
+	double low = powersOf10[digits - 1];
+	double high = powersOf10[digits];
+	double product = 0, error = 0;
+	for(int attempt = 0; attempt < 3; ++attempt) {
+		int scale = digits - 1 - exponent;
+		if(scale < 0 || scale > 22) return false;
+		twoProduct(magnitude, powersOf10[scale], product, error);
+		if(product >= high) exponent += 1;
+		else if(product < low) exponent -= 1;
+		else break;
+	}
+	if(product < low || product >= high) return false;
+
+	// Round to nearest, ties to even, on the exact value product + error
+	quint64 mantissa = quint64(product);
+	double fraction = product - double(mantissa);
+	double overHalf = (fraction - 0.5) + error;
+	if(overHalf > 0 || (overHalf == 0 && (mantissa & 1)))
+		mantissa += 1;
+	if(mantissa == intPowersOf10[digits]) {
+		mantissa = intPowersOf10[digits - 1];
+		exponent += 1;
+	}
+	if(exactOnly) {
+		// Dividing two exact values rounds just as strtod() would
+		int scale = digits - 1 - exponent;
+		if(scale < 0 || scale > 22) return false;
+		if(double(mantissa) / powersOf10[scale] != magnitude) return false;
+	}
+
+	// Drop trailing zeros, as %g does
+	char text[24];
+	char *end = text + sizeof(text);
+	char *start = writeDigits(end, mantissa);
+	while(end - start > 1 && end[-1] == '0') --end;
+
+	if(value < 0) *cursor++ = '-';
+	if(exponent < -4 || exponent >= digits) { // d.ddde-XX
+		*cursor++ = *start++;
+		if(start != end) {
+			*cursor++ = '.';
+			while(start != end) *cursor++ = *start++;
+		}
+		*cursor++ = 'e';
+		*cursor++ = (exponent < 0) ? '-' : '+';
+		int absExponent = (exponent < 0) ? -exponent : exponent;
+		*cursor++ = char('0' + absExponent / 10);
+		*cursor++ = char('0' + absExponent % 10);
+	}
+	else if(exponent < 0) { // 0.000ddd
+		*cursor++ = '0';
+		*cursor++ = '.';
+		for(int zeros = -1 - exponent; zeros > 0; --zeros) *cursor++ = '0';
+		memcpy(cursor, start, end - start);
+		cursor += end - start;
+	}
+	else { // ddd.ddd
+		char *point = start + exponent + 1;
+		if(point >= end) {
+			memcpy(cursor, start, end - start);
+			cursor += end - start;
+			for(; point > end; --point) *cursor++ = '0';
+		}
+		else {
+			memcpy(cursor, start, point - start);
+			cursor += point - start;
+			*cursor++ = '.';
+			memcpy(cursor, point, end - point);
+			cursor += end - point;
+		}
+	}
+	return true;
+#endif
+}
+
+
+//! Hands over the formatted text. The formatter is left empty.
+QByteArray CsvFormatter::takeText()
+{
+	buffer.resize(size());
+	QByteArray text = buffer;
+	buffer.clear();
+	cursor = buffer.data();
+	limit = cursor;
+	return text;
+}
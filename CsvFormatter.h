@@ -0,0 +1,54 @@
+/*
+	Name        : CsvFormatter.h
+	Author      : Charles N. Burns (charlesnburns|gmail|com / burnchar|isu|edu)
+	Date        : October 2026
+	License     : GPL3. See license.txt or www.gnu.org/licenses/gpl-3.0.txt
+	Requirements: Qt 4, data to parse, any spreadsheet program.
+	Notes       : Best viewed with tab width 4.
+	Description : Header file to define the CsvFormatter class.
+*/
+
+#ifndef CSVFORMATTER_H
+#define CSVFORMATTER_H
+
+#include <QByteArray>
+
+const int defaultPrecision = 15;	// Significant digits, as QTextStream used
+//! 15 significant digits, or 16 or 17 where 15 do not read back exactly
+const int roundTripPrecision = 0;
+const int maxPrecision = 17;
+const int maxValueTextBytes = 32;	// Longest text of one formatted value
+
+
+//! Formats numbers as text into a large reusable byte buffer.
+//! Doubles are written exactly as QTextStream wrote them with
+//! qSetRealNumberPrecision(), which matches printf("%.*g"), but most values
+//! take an integer-only fast path instead of QLocale's general code.
+//! Callers reserve() room for a whole row, then append without checks.
+class CsvFormatter
+{
+	QByteArray buffer;
+	char *cursor;
+	char *limit;
+	int precision;
+
+	void grow(int bytes);
+	void appendDoubleSlow(double value, int digits);
+	bool appendDoubleFast(double value, int digits, bool exactOnly);
+
+public:
+	explicit CsvFormatter(int precision = defaultPrecision);
+	void clear() { cursor = buffer.data(); }
+	void setPrecision(int precision);
+	inline void reserve(int bytes) { if(limit - cursor < bytes) grow(bytes); }
+	inline void append(char c) { *cursor++ = c; }
+	void append(const QByteArray &text);
+	void appendUInt(quint64 value);
+	void appendInt(qint64 value);
+	void appendDouble(double value);
+	const char *data() const { return buffer.constData(); }
+	int size() const { return cursor - buffer.constData(); }
+	QByteArray takeText();
+};
+
+#endif // CSVFORMATTER_H
@@ -2,16 +2,117 @@
 
 SOURCES += main.cpp \
 	Window.cpp \
-	Config.cpp
+	ColumnModel.cpp \
+	PreviewModel.cpp \
+	Config.cpp \
+	Converter.cpp \
+	ConvertSettings.cpp \
+	Input.cpp \
+	CsvFormatter.cpp \
+	DecodePlan.cpp \
+	DecodeSimd.cpp \
+	ConvertThread.cpp \
+	FileStats.cpp \
+	ArrowWriter.cpp \
+	Decimator.cpp \
+	Checkpoint.cpp \
+	RunStats.cpp \
+	Decompressor.cpp \
+	BlockCompressor.cpp \
+	BatchQueue.cpp \
+	RowFilter.cpp \
+	FrameIndex.cpp \
+	ColumnStats.cpp
 HEADERS += Window.h \
-	Config.h
+	ColumnModel.h \
+	PreviewModel.h \
+	Config.h \
+	Converter.h \
+	ConvertSettings.h \
+	Input.h \
+	CsvFormatter.h \
+	DecodePlan.h \
+	DecodeSimd.h \
+	ConvertThread.h \
+	FileStats.h \
+	ArrowWriter.h \
+	Decimator.h \
+	Checkpoint.h \
+	RunStats.h \
+	Decompressor.h \
+	BlockCompressor.h \
+	BatchQueue.h \
+	RowFilter.h \
+	FrameIndex.h \
+	ColumnStats.h
 QT += xml
 RESOURCES = embedded.qrc	# Icons for various supproted spreadsheet programs
 
 #CONFIG += static
+#CONFIG += cli	# Or run "qmake CONFIG+=cli" for the command-line converter
+#CONFIG += avx2	# Decode same-width columns with AVX2 instead of SSE2
+#CONFIG += bench	# Or run "qmake CONFIG+=bench" for the throughput benchmark
+#CONFIG += tests	# Or run "qmake CONFIG+=tests" for the engine's tests
+#CONFIG += gzip	# Read and write gzip files (.gz); links zlib
+#CONFIG += zstd	# Read and write zstd files (.zst); links libzstd
 
 static {
 	DEFINES += STATIC
 	QTPLUGIN += qjpeg qgif  # Statically link image format support
 	message("Static build.")
 }
+
+avx2 {
+	*-g++*|*clang*: QMAKE_CXXFLAGS += -mavx2
+	win32-msvc*: QMAKE_CXXFLAGS += /arch:AVX2
+	message("AVX2 build.")
+}
+
+gzip {
+	DEFINES += WITH_ZLIB
+	LIBS += -lz
+	message("gzip support.")
+}
+
+zstd {
+	DEFINES += WITH_ZSTD
+	LIBS += -lzstd
+	message("zstd support.")
+}
+
+cli {
+	TARGET = cnb-data-parser
+	QT -= gui
+	CONFIG += console
+	CONFIG -= app_bundle
+	SOURCES -= main.cpp Window.cpp ColumnModel.cpp PreviewModel.cpp
+	HEADERS -= Window.h ColumnModel.h PreviewModel.h	# The rest is shared
+	SOURCES += cli.cpp
+	RESOURCES =
+	message("Command-line build.")
+}
+
+bench {
+	TARGET = cnb-data-parser-bench
+	QT -= gui
+	CONFIG += console
+	CONFIG -= app_bundle
+	SOURCES -= main.cpp Window.cpp ColumnModel.cpp PreviewModel.cpp
+	HEADERS -= Window.h ColumnModel.h PreviewModel.h
+	SOURCES += bench.cpp
+	RESOURCES =
+	message("Benchmark build.")
+}
+
+tests {
+	TARGET = cnb-data-parser-tests
+	QT -= gui
+	QT += testlib
+	CONFIG += console
+	CONFIG -= app_bundle
+	SOURCES -= main.cpp Window.cpp ColumnModel.cpp PreviewModel.cpp
+	HEADERS -= Window.h ColumnModel.h PreviewModel.h
+	SOURCES += tests.cpp
+	RESOURCES =
+	message("Test build.")
+}
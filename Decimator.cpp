@@ -0,0 +1,279 @@
+/*
+	Name        : Decimator.cpp
+	Author      : Charles N. Burns (charlesnburns|gmail|com / burnchar|isu|edu)
+	Date        : October 2026
+	License     : GPL3. See license.txt or www.gnu.org/licenses/gpl-3.0.txt
+	Requirements: Qt 4, data to parse, any spreadsheet program.
+	Notes       : Best viewed with tab width 4.
+	Description : The Decimator class turns buckets of input rows into single
+				  output rows by mean, by minimum and maximum, or by
+				  Largest-Triangle-Three-Buckets (Steinarsson, 2013).
+*/
+
+#include "Decimator.h"
+#include <cmath>
+
+//! Constructor for Decimator class. Keeps 1 row in N until setup() is called.
+Decimator::Decimator()
+{
+	this->plan = 0;
+	this->mode = KeepFirst;
+	this->bucketRows = 1;
+	this->rowSize = 0;
+	this->fullRows = 0;
+	this->buckets = 0;
+	this->partialRow = 0;
+}
+
+
+//! Prepares the decimator for one job.
+//! @param plan The job's compiled column layout
+//! @param mode How each bucket becomes an output row
+//! @param bucketRows Input rows per bucket, the row limit divisor
+//! @param fullRows Whole rows in the input file
+//! @param buckets Output rows the job will produce
+//! @param partialRow Zero-padded trailing partial row, or 0 if there is none
+void Decimator::setup(const DecodePlan *plan, Mode mode, quint64 bucketRows,
+					  quint64 fullRows, quint64 buckets,
+					  const uchar *partialRow)
+{
+	this->plan = plan;
+	this->mode = mode;
+	this->bucketRows = bucketRows;
+	this->rowSize = plan->rowSize;
+	this->fullRows = fullRows;
+	this->buckets = buckets;
+	this->partialRow = partialRow;
+}
+
+
+//! Lists the columns of the output file. MinMax writes two columns for each
+//! voltage column; every other mode writes the exported input columns
+//! unchanged. Columns decoded only for the row filter are not written.
+//! @param names The name of each input column
+QVector<OutputColumn> Decimator::outputColumns(const QStringList &names) const
+{
+	QVector<OutputColumn> columns;
+	for(int col = 0; col < plan->columnCount(); ++col) {
+		if(!plan->columns.at(col).exported) continue;
+		OutputColumn column;
+		column.kind = plan->columns.at(col).kind;
+		column.type = plan->columns.at(col).type;
+		column.source = col;
+		column.name = names.value(plan->columns.at(col).index);
+		if(mode == MinMax && column.kind == PlanColumn::Voltage) {
+			QString name = column.name;
+			column.name = (name + " min").trimmed();
+			columns.append(column);
+			column.name = (name + " max").trimmed();
+		}
+		columns.append(column);
+	}
+	return columns;
+}
+
+
+//! Counts the input rows in a bucket. The last bucket may be short.
+//! @param partial Set to true if the trailing partial row is in the bucket
+//! @returns The number of whole rows in the bucket
+quint64 Decimator::bucketWholeRows(quint64 bucket, bool &partial) const
+{
+	quint64 start = bucket * bucketRows;
+	quint64 end = start + bucketRows;
+	partial = (partialRow != 0 && start <= fullRows && fullRows < end);
+	if(end > fullRows) end = fullRows;
+	return (end > start) ? end - start : 0;
+}
+
+
+//! Decodes the next block of rows of a bucket, the partial row last.
+//! @param data First row of the bucket
+//! @param done Rows of the bucket already decoded; advanced by this call
+//! @returns false once the whole bucket has been decoded
+bool Decimator::decodeBucket(const uchar *data, quint64 bucket, quint64 &done,
+							 DecodedBlock &block) const
+{
+	bool partial;
+	quint64 whole = bucketWholeRows(bucket, partial);
+	if(done < whole) {
+		int rows = decodeBlockRows;
+		if(whole - done < quint64(rows)) rows = whole - done;
+		plan->decode(data + done * rowSize, rowSize, rows, block);
+	}
+	else if(partial && done == whole)
+		plan->decode(partialRow, rowSize, 1, block);
+	else return false;
+	done += block.rows;
+	return true;
+}
+
+
+//! Computes the mean of each voltage column of a bucket.
+//! @param y Receives the means, indexed by input column
+//! @returns The mean row number, which is the x coordinate of the means
+double Decimator::bucketMean(const uchar *data, quint64 bucket,
+							 QVector<double> &y, DecimatorState &state) const
+{
+	int columns = plan->columnCount();
+	y.fill(0.0, columns);
+	quint64 done = 0;
+	while(decodeBucket(data, bucket, done, state.rows)) {
+		for(int col = 0; col < columns; ++col) {
+			if(plan->columns.at(col).kind != PlanColumn::Voltage) continue;
+			const double *real = state.rows.realColumn(col);
+			for(int row = 0; row < state.rows.rows; ++row) y[col] += real[row];
+		}
+	}
+	for(int col = 0; col < columns; ++col) y[col] /= done;
+	return bucket * bucketRows + (done - 1) / 2.0;
+}
+
+
+//! Reduces a bucket to its mean, or to its minimum and maximum.
+void Decimator::reduceStats(const uchar *data, quint64 bucket, int outRow,
+							DecodedBlock &out, DecimatorState &state) const
+{
+	int columns = plan->columnCount();
+	state.sum.fill(0.0, columns);
+	state.minimum.fill(HUGE_VAL, columns);
+	state.maximum.fill(-HUGE_VAL, columns);
+	state.first.resize(columns);
+	quint64 done = 0;
+	while(decodeBucket(data, bucket, done, state.rows)) {
+		const DecodedBlock &rows = state.rows;
+		for(int col = 0; col < columns; ++col) {
+			if(done == quint64(rows.rows)) // First block of the bucket
+				state.first[col] = rows.rawColumn(col)[0];
+			if(plan->columns.at(col).kind != PlanColumn::Voltage) continue;
+			const double *real = rows.realColumn(col);
+			double sum = 0, low = state.minimum[col], high = state.maximum[col];
+			for(int row = 0; row < rows.rows; ++row) {
+				sum += real[row];
+				if(real[row] < low) low = real[row];
+				if(real[row] > high) high = real[row];
+			}
+			state.sum[col] += sum;
+			state.minimum[col] = low;
+			state.maximum[col] = high;
+		}
+	}
+
+	int outCol = 0;
+	for(int col = 0; col < columns; ++col) {
+		out.rawColumn(outCol)[outRow] = state.first[col];
+		if(plan->columns.at(col).kind != PlanColumn::Voltage) ++outCol;
+		else if(mode == Mean)
+			out.realColumn(outCol++)[outRow] = state.sum[col] / done;
+		else {
+			out.realColumn(outCol++)[outRow] = state.minimum[col];
+			out.rawColumn(outCol)[outRow] = state.first[col];
+			out.realColumn(outCol++)[outRow] = state.maximum[col];
+		}
+	}
+}
+
+
+//! Picks the row of a bucket which forms the largest triangle with the row
+//! picked from the bucket before and the mean of the bucket after, summing
+//! the areas of all voltage columns. The first and last buckets keep their
+//! first and last rows, as LTTB always keeps the end points.
+//! At the start of a chunk the row picked before is not known, so the mean
+//! of the bucket before stands in for it. Chunks always start at the same
+//! buckets, so the output does not depend on the number of threads.
+void Decimator::reduceLttb(const uchar *data, quint64 bucket, int outRow,
+						   DecodedBlock &out, DecimatorState &state) const
+{
+	int columns = plan->columnCount();
+	qint64 bucketBytes = bucketRows * rowSize;
+	bool partial;
+	quint64 whole = bucketWholeRows(bucket, partial);
+	quint64 count = whole + (partial ? 1 : 0);
+	quint64 start = bucket * bucketRows;
+
+	quint64 picked = 0;
+	if(bucket + 1 >= buckets) picked = count - 1;
+	else if(bucket > 0) {
+		if(!state.anchored)
+			state.anchorX = bucketMean(data - bucketBytes, bucket - 1,
+									   state.anchorY, state);
+		double targetX = bucketMean(data + bucketBytes, bucket + 1,
+									state.targetY, state);
+		double bestArea = -1;
+		quint64 done = 0;
+		while(decodeBucket(data, bucket, done, state.rows)) {
+			quint64 base = done - state.rows.rows;
+			for(int row = 0; row < state.rows.rows; ++row) {
+				double x = start + base + row;
+				double area = 0;
+				for(int col = 0; col < columns; ++col) {
+					if(plan->columns.at(col).kind != PlanColumn::Voltage)
+						continue;
+					double y = state.rows.realColumn(col)[row];
+					double yA = state.anchorY.at(col);
+					area += fabs((state.anchorX - targetX) * (y - yA) -
+								 (state.anchorX - x) *
+								 (state.targetY.at(col) - yA));
+				}
+				if(area > bestArea) {
+					bestArea = area;
+					picked = base + row;
+				}
+			}
+		}
+	}
+
+	const uchar *row = (picked < whole) ? data + picked * rowSize : partialRow;
+	plan->decode(row, rowSize, 1, state.rows);
+	state.anchored = true;
+	state.anchorX = start + picked;
+	state.anchorY.resize(columns);
+	for(int col = 0; col < columns; ++col) {
+		out.rawColumn(col)[outRow] = state.rows.rawColumn(col)[0];
+		out.realColumn(col)[outRow] = state.rows.realColumn(col)[0];
+		state.anchorY[col] = state.rows.realColumn(col)[0];
+	}
+}
+
+
+//! Reduces consecutive buckets to output rows.
+//! @param data First row of the first bucket. With Lttb, the buckets just
+//!		   before and after must also be readable, where they exist.
+//! @param bucket Index of the first bucket in the job
+//! @param count Number of buckets, at most decodeBlockRows
+//! @param out Receives one row per bucket, in outputColumns() order
+//! @param state Working space. Reset it before the first bucket of a chunk.
+void Decimator::reduce(const uchar *data, quint64 bucket, int count,
+					   DecodedBlock &out, DecimatorState &state) const
+{
+	if(state.rows.raw.size() != plan->columnCount() * decodeBlockRows)
+		state.rows.resize(plan->columnCount());
+	qint64 bucketBytes = bucketRows * rowSize;
+	for(int index = 0; index < count; ++index) {
+		if(mode == Lttb) reduceLttb(data, bucket + index, index, out, state);
+		else reduceStats(data, bucket + index, index, out, state);
+		data += bucketBytes;
+	}
+	out.rows = count;
+}
+
+
+//! @returns The mode stored in a settings file under the given name
+Decimator::Mode Decimator::modeFromName(const QString &name)
+{
+	if(name == "mean") return Mean;
+	if(name == "minmax") return MinMax;
+	if(name == "lttb") return Lttb;
+	return KeepFirst;
+}
+
+
+//! @returns The name under which a mode is stored in a settings file
+QString Decimator::modeName(Mode mode)
+{
+	switch(mode) {
+	case Mean: return "mean";
+	case MinMax: return "minmax";
+	case Lttb: return "lttb";
+	default: return "first";
+	}
+}
@@ -0,0 +1,96 @@
+/*
+	Name        : Decimator.h
+	Author      : Charles N. Burns (charlesnburns|gmail|com / burnchar|isu|edu)
+	Date        : October 2026
+	License     : GPL3. See license.txt or www.gnu.org/licenses/gpl-3.0.txt
+	Requirements: Qt 4, data to parse, any spreadsheet program.
+	Notes       : Best viewed with tab width 4.
+	Description : Header file to define the Decimator class.
+*/
+
+#ifndef DECIMATOR_H
+#define DECIMATOR_H
+
+#include <QVector>
+#include <QString>
+#include <QStringList>
+#include "DecodePlan.h"
+
+//! One column of the output file, and the input column it comes from.
+struct OutputColumn
+{
+	PlanColumn::Kind kind;
+	PlanColumn::Type type;
+	int source;		// Index into DecodePlan::columns
+	QString name;
+};
+
+
+//! Working space of a Decimator, one per thread. For LTTB it also carries
+//! the point chosen in the previous bucket from one block to the next.
+struct DecimatorState
+{
+	DecimatorState() : anchored(false), anchorX(0) {}
+
+	DecodedBlock rows;		// Input rows of the bucket being reduced
+	bool anchored;
+	double anchorX;
+	QVector<double> anchorY;
+	QVector<double> targetY;
+	QVector<double> sum;
+	QVector<double> minimum;
+	QVector<double> maximum;
+	QVector<quint64> first;
+};
+
+
+//! Reduces each bucket of N consecutive input rows to one output row, where
+//! N is the row limit divisor. Each bucket is read once, in order, with
+//! memory proportional to the number of columns, so the limited output still
+//! shows spikes which keeping 1 row in N would drop.
+//!  Mean:   the mean of each voltage column
+//!  MinMax: the lowest and highest value of each voltage column, as two
+//!          output columns
+//!  Lttb:   the whole row which Largest-Triangle-Three-Buckets picks as the
+//!          most visually significant in its bucket
+//! Counter columns always hold the counter of the bucket's first row, except
+//! with Lttb, which keeps the picked row intact.
+class Decimator
+{
+public:
+	enum Mode { KeepFirst, Mean, MinMax, Lttb };
+
+private:
+	const DecodePlan *plan;
+	Mode mode;
+	quint64 bucketRows;
+	qint64 rowSize;
+	quint64 fullRows;			// Whole rows in the input file
+	quint64 buckets;			// Buckets in the job
+	const uchar *partialRow;	// Zero-padded trailing partial row, or 0
+
+	quint64 bucketWholeRows(quint64 bucket, bool &partial) const;
+	bool decodeBucket(const uchar *data, quint64 bucket, quint64 &done,
+					  DecodedBlock &block) const;
+	double bucketMean(const uchar *data, quint64 bucket,
+					  QVector<double> &y, DecimatorState &state) const;
+	void reduceStats(const uchar *data, quint64 bucket, int outRow,
+					 DecodedBlock &out, DecimatorState &state) const;
+	void reduceLttb(const uchar *data, quint64 bucket, int outRow,
+					DecodedBlock &out, DecimatorState &state) const;
+
+public:
+	Decimator();
+	void setup(const DecodePlan *plan, Mode mode, quint64 bucketRows,
+			   quint64 fullRows, quint64 buckets, const uchar *partialRow);
+	bool isAggregate() const { return mode != KeepFirst; }
+	bool needsNeighbours() const { return mode == Lttb; }
+	QVector<OutputColumn> outputColumns(const QStringList &names) const;
+	void reduce(const uchar *data, quint64 bucket, int count,
+				DecodedBlock &out, DecimatorState &state) const;
+
+	static Mode modeFromName(const QString &name);
+	static QString modeName(Mode mode);
+};
+
+#endif // DECIMATOR_H
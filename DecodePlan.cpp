@@ -0,0 +1,365 @@
+/*
+	Name        : DecodePlan.cpp
+	Author      : Charles N. Burns (charlesnburns|gmail|com / burnchar|isu|edu)
+	Date        : October 2026
+	License     : GPL3. See license.txt or www.gnu.org/licenses/gpl-3.0.txt
+	Requirements: Qt 4, data to parse, any spreadsheet program.
+	Notes       : Best viewed with tab width 4.
+	Description : The DecodePlan class turns the column layout into a list of
+				  column kernels, one template instance per byte width, byte
+				  order, column kind and type, and runs them over blocks of
+				  rows.
+*/
+
+#include "DecodePlan.h"
+#include "ConvertSettings.h"
+#include "DecodeSimd.h"
+#include <QSysInfo>
+#include <cstring>
+
+//! Column kernel for counters: the raw value is the output.
+template<int Bytes, bool BigEndian>
+static void counterKernel(const PlanColumn &column, const uchar *data,
+						  qint64 stride, int rows, quint64 *raw, double *)
+{
+	data += column.offset;
+	for(int row = 0; row < rows; ++row, data += stride)
+		raw[row] = extractRaw<Bytes, BigEndian>(data);
+}
+
+
+//! Column kernel for voltages, scaled exactly as rawIntToVoltage() does.
+template<int Bytes, bool BigEndian>
+static void voltageKernel(const PlanColumn &column, const uchar *data,
+						  qint64 stride, int rows, quint64 *raw, double *real)
+{
+	const double divisor = column.divisor;
+	const double vMin = column.vMin;
+	data += column.offset;
+	for(int row = 0; row < rows; ++row, data += stride) {
+		quint64 value = extractRaw<Bytes, BigEndian>(data);
+		raw[row] = value;
+		real[row] = (value / divisor) + vMin;
+	}
+}
+
+
+//! Sign-extends a two's complement integer of Bytes bytes to 64 bits.
+template<int Bytes>
+static inline quint64 signExtend(quint64 value)
+{
+	const int shift = 64 - (Bytes << 3);
+	return quint64(qint64(value << shift) >> shift);
+}
+
+
+//! Column kernel for signed counters: the raw value, sign-extended, is the
+//! output.
+template<int Bytes, bool BigEndian>
+static void signedCounterKernel(const PlanColumn &column, const uchar *data,
+								qint64 stride, int rows, quint64 *raw,
+								double *)
+{
+	data += column.offset;
+	for(int row = 0; row < rows; ++row, data += stride)
+		raw[row] = signExtend<Bytes>(extractRaw<Bytes, BigEndian>(data));
+}
+
+
+//! Column kernel for signed voltages. Flipping the sign bit turns the value
+//! into offset binary, the unsigned value it lies above the most negative
+//! one, which is then scaled exactly as an unsigned voltage is.
+template<int Bytes, bool BigEndian>
+static void signedVoltageKernel(const PlanColumn &column, const uchar *data,
+								qint64 stride, int rows, quint64 *raw,
+								double *real)
+{
+	const quint64 signBit = Q_UINT64_C(1) << ((Bytes << 3) - 1);
+	const double divisor = column.divisor;
+	const double vMin = column.vMin;
+	data += column.offset;
+	for(int row = 0; row < rows; ++row, data += stride) {
+		quint64 value = extractRaw<Bytes, BigEndian>(data);
+		raw[row] = signExtend<Bytes>(value);
+		real[row] = ((value ^ signBit) / divisor) + vMin;
+	}
+}
+
+
+//! Converts the bits of an IEEE 754 float of Bytes bytes to a double.
+template<int Bytes> inline double floatFromBits(quint64 bits);
+
+template<> inline double floatFromBits<2>(quint64 bits)
+{
+	// Half precision: 1 sign bit, 5 exponent bits, 10 mantissa bits. Every
+	// half is exactly a double, so the fields are moved, not computed.
+	quint64 sign = (bits & 0x8000) << 48;
+	quint64 exponent = (bits >> 10) & 0x1f;
+	quint64 mantissa = bits & 0x3ff;
+	if(exponent == 0) { // Zero or subnormal
+		double value = mantissa / 16777216.0; // 2^24
+		return sign ? -value : value;
+	}
+	if(exponent == 0x1f) exponent = 0x7ff;	// Infinity or NaN
+	else exponent += 1023 - 15;
+	bits = sign | (exponent << 52) | (mantissa << 42);
+	double value;
+	memcpy(&value, &bits, sizeof(value));
+	return value;
+}
+
+template<> inline double floatFromBits<4>(quint64 bits)
+{
+	quint32 single = quint32(bits);
+	float value;
+	memcpy(&value, &single, sizeof(value));
+	return value;
+}
+
+template<> inline double floatFromBits<8>(quint64 bits)
+{
+	double value;
+	memcpy(&value, &bits, sizeof(value));
+	return value;
+}
+
+
+//! Column kernel for floats: the raw value holds the bits, and the value
+//! is written unscaled.
+template<int Bytes, bool BigEndian>
+static void floatKernel(const PlanColumn &column, const uchar *data,
+						qint64 stride, int rows, quint64 *raw, double *real)
+{
+	data += column.offset;
+	for(int row = 0; row < rows; ++row, data += stride) {
+		quint64 bits = extractRaw<Bytes, BigEndian>(data);
+		raw[row] = bits;
+		real[row] = floatFromBits<Bytes>(bits);
+	}
+}
+
+
+//! Kernels indexed by [big endian][bytes]
+#define KERNEL_ROW(kernel, bigEndian) { 0, \
+	kernel<1, bigEndian>, kernel<2, bigEndian>, kernel<3, bigEndian>, \
+	kernel<4, bigEndian>, kernel<5, bigEndian>, kernel<6, bigEndian>, \
+	kernel<7, bigEndian>, kernel<8, bigEndian> }
+
+static const ColumnKernel counterKernels[2][maxColumnBytes + 1] = {
+	KERNEL_ROW(counterKernel, false), KERNEL_ROW(counterKernel, true)
+};
+static const ColumnKernel voltageKernels[2][maxColumnBytes + 1] = {
+	KERNEL_ROW(voltageKernel, false), KERNEL_ROW(voltageKernel, true)
+};
+
+static const ColumnKernel signedCounterKernels[2][maxColumnBytes + 1] = {
+	KERNEL_ROW(signedCounterKernel, false),
+	KERNEL_ROW(signedCounterKernel, true)
+};
+static const ColumnKernel signedVoltageKernels[2][maxColumnBytes + 1] = {
+	KERNEL_ROW(signedVoltageKernel, false),
+	KERNEL_ROW(signedVoltageKernel, true)
+};
+
+#undef KERNEL_ROW
+
+//! Float kernels, for the widths of IEEE 754 half, single and double
+#define FLOAT_ROW(bigEndian) { 0, 0, floatKernel<2, bigEndian>, 0, \
+	floatKernel<4, bigEndian>, 0, 0, 0, floatKernel<8, bigEndian> }
+
+static const ColumnKernel floatKernels[2][maxColumnBytes + 1] = {
+	FLOAT_ROW(false), FLOAT_ROW(true)
+};
+
+#undef FLOAT_ROW
+
+
+//! Makes room for a full block of the given number of columns.
+void DecodedBlock::resize(int columns)
+{
+	raw.resize(columns * decodeBlockRows);
+	real.resize(columns * decodeBlockRows);
+	rowMajorRaw.resize(columns * decodeBlockRows);
+	rowMajorReal.resize(columns * decodeBlockRows);
+	rows = 0;
+}
+
+
+//! Constructor for DecodePlan class
+DecodePlan::DecodePlan()
+{
+	this->rowSize = 0;
+	this->spanStart = 0;
+	this->spanBytes = 0;
+	this->uniformBytes = 0;
+}
+
+
+//! The largest value which fits in an unsigned integer of numBytes bytes.
+//! This is the raw value which means "high voltage".
+quint64 DecodePlan::maxRawValue(int numBytes)
+{
+	if(numBytes >= 8) return ~Q_UINT64_C(0);
+	return (Q_UINT64_C(1) << (numBytes << 3)) - 1;
+}
+
+
+//! @returns Whether a column of a type may have numBytes bytes. Integers
+//!			 may have 1 to 8, and floats 2, 4 or 8.
+bool DecodePlan::typeFits(PlanColumn::Type type, int numBytes)
+{
+	if(type == PlanColumn::Float)
+		return numBytes == 2 || numBytes == 4 || numBytes == 8;
+	return numBytes >= 1 && numBytes <= maxColumnBytes;
+}
+
+
+//! @returns The type stored in a settings file under the given name
+PlanColumn::Type DecodePlan::typeFromName(const QString &name)
+{
+	if(name == "signed") return PlanColumn::Signed;
+	if(name == "float") return PlanColumn::Float;
+	return PlanColumn::Unsigned;
+}
+
+
+//! @returns The name under which a type is stored in a settings file
+QString DecodePlan::typeName(PlanColumn::Type type)
+{
+	switch(type) {
+	case PlanColumn::Signed: return "signed";
+	case PlanColumn::Float: return "float";
+	default: return "unsigned";
+	}
+}
+
+
+//! Builds the plan for a column layout.
+//! "Swap byte order" means the data is stored in the opposite byte order to
+//! this computer's, so on the usual little-endian hosts it means big-endian.
+//! Only exported columns are compiled; the others are skipped by offset.
+//! @param settings The job's settings. Each column's byte count must fit
+//!		   its type; see typeFits().
+//! @param filterColumns Input columns the row filter needs, which are also
+//!		   compiled if they are not exported
+void DecodePlan::compile(const ConvertSettings &settings,
+						 const QList<int> &filterColumns)
+{
+	bool hostBigEndian = (QSysInfo::ByteOrder == QSysInfo::BigEndian);
+	bool bigEndian = (settings.byteSwap != hostBigEndian);
+	double range = settings.vMax - settings.vMin;
+
+	columns.clear();
+	rowSize = 0;
+	QVector<int> offsets;
+	for(int col = 0; col < settings.colCount(); ++col) {
+		offsets.append(rowSize);
+		rowSize += settings.colBytes.at(col);
+	}
+	for(int pass = 0; pass < 2; ++pass) { // Exported columns first
+		for(int col = 0; col < settings.colCount(); ++col) {
+			bool exported = settings.isExported(col);
+			if(pass == 0 ? !exported :
+			   exported || !filterColumns.contains(col)) continue;
+			PlanColumn column;
+			column.index = col;
+			column.exported = exported;
+			column.bytes = settings.colBytes.at(col);
+			column.offset = offsets.at(col);
+			column.bigEndian = bigEndian;
+			column.vMin = settings.vMin;
+			column.divisor = maxRawValue(column.bytes) / range;
+			column.type = settings.typeOf(col);
+			if(column.type == PlanColumn::Float) {
+				column.kind = PlanColumn::Voltage;
+				column.kernel = floatKernels[bigEndian][column.bytes];
+			}
+			else if(settings.colCounter.at(col)) {
+				column.kind = PlanColumn::Counter;
+				column.kernel = (column.type == PlanColumn::Signed) ?
+						signedCounterKernels[bigEndian][column.bytes] :
+						counterKernels[bigEndian][column.bytes];
+			}
+			else {
+				column.kind = PlanColumn::Voltage;
+				column.kernel = (column.type == PlanColumn::Signed) ?
+						signedVoltageKernels[bigEndian][column.bytes] :
+						voltageKernels[bigEndian][column.bytes];
+			}
+			columns.append(column);
+		}
+	}
+
+	spanStart = rowSize;
+	int spanEnd = 0;
+	for(int col = 0; col < columns.size(); ++col) {
+		const PlanColumn &column = columns.at(col);
+		spanStart = qMin(spanStart, column.offset);
+		spanEnd = qMax(spanEnd, column.offset + column.bytes);
+	}
+	spanBytes = qMax(0, spanEnd - spanStart);
+
+	// The uniform decoder reads the columns as one run of unsigned values, so
+	// they must also be contiguous, and in the order of the row
+	uniformBytes = 0;
+	if(!columns.isEmpty() && uniformDecodeSupported(columns.at(0).bytes)) {
+		uniformBytes = columns.at(0).bytes;
+		for(int col = 0; col < columns.size(); ++col)
+			if(columns.at(col).bytes != uniformBytes ||
+			   columns.at(col).type != PlanColumn::Unsigned ||
+			   columns.at(col).offset != spanStart + col * uniformBytes)
+				uniformBytes = 0;
+	}
+}
+
+
+//! Decodes a block of rows, one column at a time.
+//! @param data The first row of the block
+//! @param stride Bytes from the start of one row to the start of the next
+//! @param rows Number of rows, at most decodeBlockRows
+//! @param block Receives the values. Must have been resized for this plan.
+void DecodePlan::decode(const uchar *data, qint64 stride, int rows,
+						DecodedBlock &block) const
+{
+	if(uniformBytes != 0) decodeUniform(data, stride, rows, block);
+	else for(int col = 0; col < columns.size(); ++col) {
+		const PlanColumn &column = columns.at(col);
+		column.kernel(column, data, stride, rows, block.rawColumn(col),
+					  block.realColumn(col));
+	}
+	block.rows = rows;
+}
+
+
+//! Decodes a block of rows whose columns all have the same width. Adjacent
+//! rows form one run of values, so the vector decoder sees as many values at
+//! once as possible; the results are then spread out into columns. When only
+//! some columns are exported, or rows are skipped, each row is one run.
+//! @see decode()
+void DecodePlan::decodeUniform(const uchar *data, qint64 stride, int rows,
+							   DecodedBlock &block) const
+{
+	int count = columns.size();
+	const PlanColumn &first = columns.at(0);
+	quint64 *raw = block.rowMajorRaw.data();
+	double *real = block.rowMajorReal.data();
+	data += spanStart;
+	if(stride == spanBytes) { // Every column of every row
+		decodeUniformRun(data, rows * count, uniformBytes, first.bigEndian,
+						 first.divisor, first.vMin, raw, real);
+	}
+	else for(int row = 0; row < rows; ++row) {
+		decodeUniformRun(data + row * stride, count, uniformBytes,
+						 first.bigEndian, first.divisor, first.vMin,
+						 raw + row * count, real + row * count);
+	}
+
+	for(int col = 0; col < count; ++col) {
+		quint64 *rawColumn = block.rawColumn(col);
+		double *realColumn = block.realColumn(col);
+		for(int row = 0; row < rows; ++row) {
+			rawColumn[row] = raw[row * count + col];
+			realColumn[row] = real[row * count + col];
+		}
+	}
+}
@@ -0,0 +1,144 @@
+/*
+	Name        : DecodePlan.h
+	Author      : Charles N. Burns (charlesnburns|gmail|com / burnchar|isu|edu)
+	Date        : October 2026
+	License     : GPL3. See license.txt or www.gnu.org/licenses/gpl-3.0.txt
+	Requirements: Qt 4, data to parse, any spreadsheet program.
+	Notes       : Best viewed with tab width 4.
+	Description : Header file to define the DecodePlan and DecodedBlock classes.
+*/
+
+#ifndef DECODEPLAN_H
+#define DECODEPLAN_H
+
+#include <QVector>
+#include <QList>
+#include <QString>
+
+class ConvertSettings;
+struct PlanColumn;
+
+const quint8 maxColumnBytes = 8;	// Widest column, in bytes
+const int decodeBlockRows = 256;	// Rows decoded by one pass of the kernels
+
+
+//! Assembles an unsigned integer from Bytes bytes in the given byte order.
+//! The loop is unrolled by the compiler into a load and, where needed, a
+//! byte swap instruction.
+template<int Bytes, bool BigEndian>
+inline quint64 extractRaw(const uchar *bytes)
+{
+	quint64 value = 0;
+	for(int index = 0; index < Bytes; ++index) {
+		int shift = (BigEndian ? (Bytes - 1 - index) : index) << 3;
+		value |= quint64(bytes[index]) << shift;
+	}
+	return value;
+}
+
+
+//! Decoded values of up to decodeBlockRows rows, stored column by column so
+//! each column kernel writes one contiguous array.
+class DecodedBlock
+{
+public:
+	DecodedBlock() : rows(0) {}
+	void resize(int columns);
+	quint64 *rawColumn(int col) { return raw.data() + col * decodeBlockRows; }
+	double *realColumn(int col) { return real.data() + col * decodeBlockRows; }
+	const quint64 *rawColumn(int col) const
+	{
+		return raw.constData() + col * decodeBlockRows;
+	}
+	const double *realColumn(int col) const
+	{
+		return real.constData() + col * decodeBlockRows;
+	}
+
+	int rows;
+	QVector<quint64> raw;	// Value read from the file; see PlanColumn::Type
+	QVector<double> real;	// Voltage or float value, for voltage columns
+	QVector<quint64> rowMajorRaw;	// Scratch space for the uniform decoder
+	QVector<double> rowMajorReal;
+};
+
+
+//! Decodes one column of a block of rows.
+//! @param column The column to decode
+//! @param data The first row of the block
+//! @param stride Bytes from the start of one row to the start of the next
+//! @param rows Number of rows to decode
+//! @param raw Receives the raw value of each row
+//! @param real Receives the voltage of each row, for voltage columns
+typedef void (*ColumnKernel)(const PlanColumn &column, const uchar *data,
+							 qint64 stride, int rows, quint64 *raw,
+							 double *real);
+
+
+//! One column of a DecodePlan, with everything the kernel needs precomputed.
+//! The type tells how the bytes are read:
+//!  Unsigned: an unsigned integer, held as is in the raw value
+//!  Signed:   a two's complement integer, held sign-extended to 64 bits. As a
+//!            voltage, the most negative value is the low voltage and the
+//!            most positive the high one, as with a bipolar ADC.
+//!  Float:    an IEEE 754 half, single or double of 2, 4 or 8 bytes, held as
+//!            its bits. Floats are always voltage columns, and their value
+//!            is written as it is, without scaling.
+struct PlanColumn
+{
+	enum Kind { Counter, Voltage };
+	enum Type { Unsigned, Signed, Float };
+
+	Kind kind;
+	Type type;
+	int index;			// Column of the input row
+	bool exported;		// False if only decoded for the row filter
+	int offset;			// Bytes from the start of the row
+	int bytes;
+	bool bigEndian;
+	double divisor;		// maxVal / (vMax - vMin), as rawIntToVoltage() uses
+	double vMin;
+	ColumnKernel kernel;
+};
+
+
+//! A column layout compiled once per job. Every decision which depends only
+//! on the layout -- byte order, width, counter or voltage, voltage scale -- is
+//! made here, so the kernels run with no widget access and no branches that
+//! depend on the data. Each type has its own kernel for each width, so no
+//! kernel tests a value's type. Layouts of unsigned columns which all have
+//! the same supported width are decoded a whole run of rows at a time with
+//! vector instructions.
+//! Columns which are not exported are left out of the plan. They still count
+//! toward the row size, so the exported columns are found by their offsets
+//! alone, and the bytes of the others are never decoded, formatted, or, when
+//! they lie outside the decoded span, fetched. Columns the row filter needs
+//! but which are not exported follow the exported ones, so the first columns
+//! of a decoded block are always the exported ones.
+class DecodePlan
+{
+	void decodeUniform(const uchar *data, qint64 stride, int rows,
+					   DecodedBlock &block) const;
+
+public:
+	DecodePlan();
+	void compile(const ConvertSettings &settings,
+				 const QList<int> &filterColumns = QList<int>());
+	void decode(const uchar *data, qint64 stride, int rows,
+				DecodedBlock &block) const;
+	int columnCount() const { return columns.size(); }
+	bool isUniform() const { return uniformBytes != 0; }
+
+	QVector<PlanColumn> columns;
+	int rowSize;
+	int spanStart;		// Offset of the first decoded byte of a row
+	int spanBytes;		// Bytes from there to the last decoded byte
+	int uniformBytes;	// Width of every column if all match, otherwise 0
+
+	static quint64 maxRawValue(int numBytes);
+	static bool typeFits(PlanColumn::Type type, int numBytes);
+	static PlanColumn::Type typeFromName(const QString &name);
+	static QString typeName(PlanColumn::Type type);
+};
+
+#endif // DECODEPLAN_H
@@ -0,0 +1,287 @@
+/*
+	Name        : DecodeSimd.cpp
+	Author      : Charles N. Burns (charlesnburns|gmail|com / burnchar|isu|edu)
+	Date        : October 2026
+	License     : GPL3. See license.txt or www.gnu.org/licenses/gpl-3.0.txt
+	Requirements: Qt 4, data to parse, any spreadsheet program.
+	Notes       : Best viewed with tab width 4.
+	Description : Vectorized decoding of runs of same-width values, such as
+				  16 two-byte ADC channels. Each step loads a whole vector of
+				  values, byte swaps them, zero-extends them, and scales them
+				  to voltages. AVX2 is used when the compiler targets it (see
+				  CONFIG += avx2 in DataParser.pro), SSE2 otherwise on x86, and
+				  the scalar kernels everywhere else.
+
+				  Scaling divides by the same divisor as rawIntToVoltage(), so
+				  the vector and scalar results are bit-for-bit equal.
+*/
+
+#include "DecodeSimd.h"
+#include "DecodePlan.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define DECODE_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || \
+	(defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define DECODE_SSE2
+#endif
+
+
+//! Decodes values one at a time. Handles every width, and the tail of a run
+//! which is too short for a full vector.
+template<int Bytes, bool BigEndian>
+static void decodeRunScalar(const uchar *data, int count, double divisor,
+							double vMin, quint64 *raw, double *real)
+{
+	for(int index = 0; index < count; ++index, data += Bytes) {
+		quint64 value = extractRaw<Bytes, BigEndian>(data);
+		raw[index] = value;
+		real[index] = (value / divisor) + vMin;
+	}
+}
+
+
+#if defined(DECODE_SSE2)
+
+//! Stores four 32-bit values as raw 64-bit values and as voltages.
+//! @param Unsigned31 True if every value is below 2^31, so a signed
+//!		   conversion to double is exact without adjusting the sign bit.
+template<bool Unsigned31>
+static inline void storeFour(__m128i values, __m128d divisor, __m128d vMin,
+							 quint64 *raw, double *real)
+{
+	const __m128i zero = _mm_setzero_si128();
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(raw),
+					 _mm_unpacklo_epi32(values, zero));
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(raw + 2),
+					 _mm_unpackhi_epi32(values, zero));
+	__m128d low, high;
+	if(Unsigned31) {
+		low = _mm_cvtepi32_pd(values);
+		high = _mm_cvtepi32_pd(
+				_mm_shuffle_epi32(values, _MM_SHUFFLE(1, 0, 3, 2)));
+	}
+	else { // Flip the sign bit, convert as signed, then add 2^31 back
+		const __m128i bias = _mm_set1_epi32(int(0x80000000u));
+		const __m128d biasDouble = _mm_set1_pd(2147483648.0);
+		__m128i flipped = _mm_xor_si128(values, bias);
+		low = _mm_add_pd(_mm_cvtepi32_pd(flipped), biasDouble);
+		flipped = _mm_shuffle_epi32(flipped, _MM_SHUFFLE(1, 0, 3, 2));
+		high = _mm_add_pd(_mm_cvtepi32_pd(flipped), biasDouble);
+	}
+	_mm_storeu_pd(real, _mm_add_pd(_mm_div_pd(low, divisor), vMin));
+	_mm_storeu_pd(real + 2, _mm_add_pd(_mm_div_pd(high, divisor), vMin));
+}
+
+
+//! Swaps the bytes of each 16-bit lane.
+static inline __m128i swap16(__m128i values)
+{
+	return _mm_or_si128(_mm_slli_epi16(values, 8), _mm_srli_epi16(values, 8));
+}
+
+
+//! Swaps the bytes of each 32-bit lane. SSE2 has no byte shuffle.
+static inline __m128i swap32(__m128i values)
+{
+	values = swap16(values);
+	return _mm_or_si128(_mm_slli_epi32(values, 16), _mm_srli_epi32(values, 16));
+}
+
+
+//! Decodes as many values as fill whole vectors.
+//! @returns The number of values decoded
+template<int Bytes, bool BigEndian>
+static int decodeRunVector(const uchar *data, int count, double divisor,
+						   double vMin, quint64 *raw, double *real)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128d divisors = _mm_set1_pd(divisor);
+	const __m128d offsets = _mm_set1_pd(vMin);
+	int index = 0;
+	if(Bytes == 1) {
+		for(; index + 8 <= count; index += 8) {
+			__m128i bytes = _mm_loadl_epi64(
+					reinterpret_cast<const __m128i*>(data + index));
+			__m128i words = _mm_unpacklo_epi8(bytes, zero);
+			storeFour<true>(_mm_unpacklo_epi16(words, zero), divisors,
+							offsets, raw + index, real + index);
+			storeFour<true>(_mm_unpackhi_epi16(words, zero), divisors,
+							offsets, raw + index + 4, real + index + 4);
+		}
+	}
+	else if(Bytes == 2) {
+		for(; index + 8 <= count; index += 8) {
+			__m128i words = _mm_loadu_si128(
+					reinterpret_cast<const __m128i*>(data + index * 2));
+			if(BigEndian) words = swap16(words);
+			storeFour<true>(_mm_unpacklo_epi16(words, zero), divisors,
+							offsets, raw + index, real + index);
+			storeFour<true>(_mm_unpackhi_epi16(words, zero), divisors,
+							offsets, raw + index + 4, real + index + 4);
+		}
+	}
+	else if(Bytes == 4) {
+		for(; index + 4 <= count; index += 4) {
+			__m128i dwords = _mm_loadu_si128(
+					reinterpret_cast<const __m128i*>(data + index * 4));
+			if(BigEndian) dwords = swap32(dwords);
+			storeFour<false>(dwords, divisors, offsets,
+							 raw + index, real + index);
+		}
+	}
+	return index;
+}
+
+#elif defined(DECODE_AVX2)
+
+//! Stores eight 32-bit values as raw 64-bit values and as voltages.
+//! @param Unsigned31 True if every value is below 2^31, so a signed
+//!		   conversion to double is exact without adjusting the sign bit.
+template<bool Unsigned31>
+static inline void storeEight(__m256i values, __m256d divisor, __m256d vMin,
+							  quint64 *raw, double *real)
+{
+	__m128i low = _mm256_castsi256_si128(values);
+	__m128i high = _mm256_extracti128_si256(values, 1);
+	_mm256_storeu_si256(reinterpret_cast<__m256i*>(raw),
+						_mm256_cvtepu32_epi64(low));
+	_mm256_storeu_si256(reinterpret_cast<__m256i*>(raw + 4),
+						_mm256_cvtepu32_epi64(high));
+	__m256d lowDouble, highDouble;
+	if(Unsigned31) {
+		lowDouble = _mm256_cvtepi32_pd(low);
+		highDouble = _mm256_cvtepi32_pd(high);
+	}
+	else { // Flip the sign bit, convert as signed, then add 2^31 back
+		const __m128i bias = _mm_set1_epi32(int(0x80000000u));
+		const __m256d biasDouble = _mm256_set1_pd(2147483648.0);
+		lowDouble = _mm256_add_pd(
+				_mm256_cvtepi32_pd(_mm_xor_si128(low, bias)), biasDouble);
+		highDouble = _mm256_add_pd(
+				_mm256_cvtepi32_pd(_mm_xor_si128(high, bias)), biasDouble);
+	}
+	_mm256_storeu_pd(real, _mm256_add_pd(_mm256_div_pd(lowDouble, divisor),
+										 vMin));
+	_mm256_storeu_pd(real + 4, _mm256_add_pd(
+			_mm256_div_pd(highDouble, divisor), vMin));
+}
+
+
+//! Decodes as many values as fill whole vectors.
+//! @returns The number of values decoded
+template<int Bytes, bool BigEndian>
+static int decodeRunVector(const uchar *data, int count, double divisor,
+						   double vMin, quint64 *raw, double *real)
+{
+	const __m256d divisors = _mm256_set1_pd(divisor);
+	const __m256d offsets = _mm256_set1_pd(vMin);
+	const __m128i swap16 = _mm_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6,
+										 9, 8, 11, 10, 13, 12, 15, 14);
+	const __m256i swap32 = _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4,
+											11, 10, 9, 8, 15, 14, 13, 12,
+											3, 2, 1, 0, 7, 6, 5, 4,
+											11, 10, 9, 8, 15, 14, 13, 12);
+	int index = 0;
+	if(Bytes == 1) {
+		for(; index + 8 <= count; index += 8) {
+			__m128i bytes = _mm_loadl_epi64(
+					reinterpret_cast<const __m128i*>(data + index));
+			storeEight<true>(_mm256_cvtepu8_epi32(bytes), divisors, offsets,
+							 raw + index, real + index);
+		}
+	}
+	else if(Bytes == 2) {
+		for(; index + 8 <= count; index += 8) {
+			__m128i words = _mm_loadu_si128(
+					reinterpret_cast<const __m128i*>(data + index * 2));
+			if(BigEndian) words = _mm_shuffle_epi8(words, swap16);
+			storeEight<true>(_mm256_cvtepu16_epi32(words), divisors, offsets,
+							 raw + index, real + index);
+		}
+	}
+	else if(Bytes == 4) {
+		for(; index + 8 <= count; index += 8) {
+			__m256i dwords = _mm256_loadu_si256(
+					reinterpret_cast<const __m256i*>(data + index * 4));
+			if(BigEndian) dwords = _mm256_shuffle_epi8(dwords, swap32);
+			storeEight<false>(dwords, divisors, offsets,
+							  raw + index, real + index);
+		}
+	}
+	return index;
+}
+
+#else
+
+template<int Bytes, bool BigEndian>
+static int decodeRunVector(const uchar *, int, double, double, quint64 *,
+						   double *)
+{
+	return 0;
+}
+
+#endif
+
+
+//! Decodes a run with vectors, then finishes the tail one value at a time.
+template<int Bytes, bool BigEndian>
+static void decodeRun(const uchar *data, int count, double divisor,
+					  double vMin, quint64 *raw, double *real)
+{
+	int done = decodeRunVector<Bytes, BigEndian>(data, count, divisor, vMin,
+												 raw, real);
+	decodeRunScalar<Bytes, BigEndian>(data + done * Bytes, count - done,
+									  divisor, vMin, raw + done, real + done);
+}
+
+
+//! @returns true if decodeUniformRun() handles values of this many bytes
+bool uniformDecodeSupported(int bytes)
+{
+	return bytes == 1 || bytes == 2 || bytes == 4;
+}
+
+
+//! @returns The name of the vector instructions the decoder was built for
+const char *uniformDecodeInstructionSet()
+{
+#if defined(DECODE_AVX2)
+	return "AVX2";
+#elif defined(DECODE_SSE2)
+	return "SSE2";
+#else
+	return "scalar";
+#endif
+}
+
+
+//! Decodes a contiguous run of same-width unsigned values, computing both the
+//! raw value and the voltage of each.
+//! @param data The first byte of the first value
+//! @param count Number of values
+//! @param bytes Width of each value; see uniformDecodeSupported()
+//! @param bigEndian True if the values are stored most significant byte first
+//! @param divisor maxVal / (vMax - vMin), as rawIntToVoltage() uses
+//! @param vMin Voltage of a raw value of 0
+//! @param raw Receives count raw values
+//! @param real Receives count voltages
+void decodeUniformRun(const uchar *data, int count, int bytes, bool bigEndian,
+					  double divisor, double vMin, quint64 *raw, double *real)
+{
+	switch(bytes) {
+	case 1:
+		decodeRun<1, false>(data, count, divisor, vMin, raw, real);
+		break;
+	case 2:
+		if(bigEndian) decodeRun<2, true>(data, count, divisor, vMin, raw, real);
+		else decodeRun<2, false>(data, count, divisor, vMin, raw, real);
+		break;
+	case 4:
+		if(bigEndian) decodeRun<4, true>(data, count, divisor, vMin, raw, real);
+		else decodeRun<4, false>(data, count, divisor, vMin, raw, real);
+		break;
+	}
+}
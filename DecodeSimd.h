@@ -0,0 +1,22 @@
+/*
+	Name        : DecodeSimd.h
+	Author      : Charles N. Burns (charlesnburns|gmail|com / burnchar|isu|edu)
+	Date        : October 2026
+	License     : GPL3. See license.txt or www.gnu.org/licenses/gpl-3.0.txt
+	Requirements: Qt 4, data to parse, any spreadsheet program.
+	Notes       : Best viewed with tab width 4.
+	Description : Declares the vectorized decoder for layouts in which every
+				  column has the same byte width.
+*/
+
+#ifndef DECODESIMD_H
+#define DECODESIMD_H
+
+#include <QtGlobal>
+
+bool uniformDecodeSupported(int bytes);
+const char *uniformDecodeInstructionSet();
+void decodeUniformRun(const uchar *data, int count, int bytes, bool bigEndian,
+					  double divisor, double vMin, quint64 *raw, double *real);
+
+#endif // DECODESIMD_H
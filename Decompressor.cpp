@@ -0,0 +1,360 @@
+/*
+	Name        : Decompressor.cpp
+	Author      : Charles N. Burns (charlesnburns|gmail|com / burnchar|isu|edu)
+	Date        : October 2026
+	License     : GPL3. See license.txt or www.gnu.org/licenses/gpl-3.0.txt
+	Requirements: Qt 4, data to parse, any spreadsheet program.
+				  zlib for gzip files and libzstd for zstd files; see
+				  DataParser.pro.
+	Notes       : Best viewed with tab width 4.
+	Description : The Decompressor class lets compressed captures be converted
+				  directly, without first unpacking them to disk.
+*/
+
+#include "Decompressor.h"
+#include <QMutexLocker>
+#ifdef WITH_ZLIB
+#include <string.h>
+#include <zlib.h>
+#endif
+#ifdef WITH_ZSTD
+#include <zstd.h>
+#endif
+
+//! Constructor for Decompressor class
+Decompressor::Decompressor()
+{
+	this->compression = Uncompressed;
+	this->ended = true;
+	this->stopping = false;
+}
+
+
+//! Destructor for Decompressor class. Stops the thread if it is running.
+Decompressor::~Decompressor()
+{
+	stop();
+}
+
+
+//! Starts decompressing a file on the thread.
+//! @param fileURI Path of the compressed data file
+//! @param compression How it is compressed. Must be supported.
+//! @returns false if the compression is not supported, true otherwise
+bool Decompressor::begin(const QString &fileURI, Compression compression)
+{
+	bool retval = isSupported(compression) && compression != Uncompressed;
+	stop();
+	if(!retval) {
+		errorMessage = QObject::tr("Unsupported compression.");
+	}
+	else {
+		this->fileURI = fileURI;
+		this->compression = compression;
+		queue.clear();
+		error.clear();
+		ended = false;
+		stopping = false;
+		start();
+	}
+	return retval;
+}
+
+
+//! Takes the next block of decompressed data, waiting for it if need be.
+//! @param block Receives the block
+//! @returns false at the end of the data or on an error, which is then in
+//!			 errorMessage; true otherwise
+bool Decompressor::next(QByteArray &block)
+{
+	QMutexLocker locker(&mutex);
+	while(queue.isEmpty() && !ended) queueChanged.wait(&mutex);
+	if(queue.isEmpty()) {
+		errorMessage = error;
+		return false;
+	}
+	block = queue.dequeue();
+	queueChanged.wakeAll();
+	return true;
+}
+
+
+//! Stops the thread, discarding blocks it has not handed over, and waits
+//! for it to end.
+void Decompressor::stop()
+{
+	{
+		QMutexLocker locker(&mutex);
+		stopping = true;
+		queueChanged.wakeAll();
+	}
+	wait();
+	queue.clear();
+}
+
+
+//! Queues a full block for the reader, waiting while the queue is full.
+//! The block is handed over and left empty.
+//! @returns false if the reader has stopped the thread
+bool Decompressor::push(QByteArray &block)
+{
+	QMutexLocker locker(&mutex);
+	while(queue.size() >= decompressQueueBlocks && !stopping)
+		queueChanged.wait(&mutex);
+	if(stopping) return false;
+	queue.enqueue(block);
+	block = QByteArray();
+	queueChanged.wakeAll();
+	return true;
+}
+
+
+//! Records why the thread ended early, unless the reader stopped it.
+void Decompressor::fail(const QString &message)
+{
+	QMutexLocker locker(&mutex);
+	if(!stopping) error = message;
+}
+
+
+//! Reads and decompresses the whole file, then marks the queue ended.
+void Decompressor::run()
+{
+	QFile file(fileURI);
+	if(!file.open(QIODevice::ReadOnly))
+		fail(QObject::tr("Cannot open data file for reading."));
+	else if(compression == Gzip) inflateGzip(file);
+	else if(compression == Zstd) decompressZstd(file);
+	QMutexLocker locker(&mutex);
+	ended = true;
+	queueChanged.wakeAll();
+}
+
+
+//! Inflates a gzip file. Files made by concatenating gzip files, as
+//! "cat a.gz b.gz" does, hold several members; each is inflated in turn.
+//! @returns false on an error or if stopped
+bool Decompressor::inflateGzip(QFile &file)
+{
+	bool retval = true;
+#ifdef WITH_ZLIB
+	z_stream zs;
+	memset(&zs, 0, sizeof(zs));
+	if(inflateInit2(&zs, 15 + 16) != Z_OK) { // 16: Expect a gzip header
+		fail(QObject::tr("Out of memory."));
+		return false;
+	}
+	QByteArray in;
+	in.resize(compressedReadBytes);
+	QByteArray out;
+	out.resize(decompressedBlockBytes);
+	zs.next_out = reinterpret_cast<Bytef*>(out.data());
+	zs.avail_out = uInt(out.size());
+	bool inMember = false;
+	bool pending = false;	// inflate() may hold output it had no room for
+	while(retval) {
+		if(zs.avail_in == 0 && !pending) {
+			qint64 got = file.read(in.data(), in.size());
+			if(got < 0) {
+				fail(QObject::tr("Error reading data file."));
+				retval = false;
+				break;
+			}
+			if(got == 0) {
+				if(inMember) {
+					fail(QObject::tr("The compressed data file is truncated."));
+					retval = false;
+				}
+				break;
+			}
+			zs.next_in = reinterpret_cast<Bytef*>(in.data());
+			zs.avail_in = uInt(got);
+		}
+		int status = inflate(&zs, Z_NO_FLUSH);
+		if(status == Z_STREAM_END) {
+			inMember = false;
+			inflateReset(&zs);	// Another member may follow
+		}
+		else if(status == Z_OK || status == Z_BUF_ERROR) inMember = true;
+		else {
+			fail(QObject::tr("The compressed data file is damaged."));
+			retval = false;
+		}
+		pending = (zs.avail_out == 0);
+		if(retval && pending) {
+			retval = push(out);
+			out.resize(decompressedBlockBytes);
+			zs.next_out = reinterpret_cast<Bytef*>(out.data());
+			zs.avail_out = uInt(out.size());
+		}
+	}
+	if(retval && zs.avail_out < uInt(out.size())) {
+		out.resize(out.size() - int(zs.avail_out));
+		retval = push(out);
+	}
+	inflateEnd(&zs);
+#else
+	Q_UNUSED(file);
+	retval = false;
+#endif
+	return retval;
+}
+
+
+//! Decompresses a zstd file, which may hold several frames.
+//! @returns false on an error or if stopped
+bool Decompressor::decompressZstd(QFile &file)
+{
+	bool retval = true;
+#ifdef WITH_ZSTD
+	ZSTD_DStream *zds = ZSTD_createDStream();
+	if(zds == 0 || ZSTD_isError(ZSTD_initDStream(zds))) {
+		ZSTD_freeDStream(zds);
+		fail(QObject::tr("Out of memory."));
+		return false;
+	}
+	QByteArray in;
+	in.resize(int(qMax(ZSTD_DStreamInSize(), size_t(compressedReadBytes))));
+	QByteArray out;
+	out.resize(decompressedBlockBytes);
+	ZSTD_inBuffer input = { in.constData(), 0, 0 };
+	ZSTD_outBuffer output = { out.data(), size_t(out.size()), 0 };
+	size_t hint = 1;		// 0 once a frame has been decoded and flushed
+	bool pending = false;	// The decoder may hold output it had no room for
+	while(retval) {
+		if(input.pos == input.size && !pending) {
+			qint64 got = file.read(in.data(), in.size());
+			if(got < 0) {
+				fail(QObject::tr("Error reading data file."));
+				retval = false;
+				break;
+			}
+			if(got == 0) {
+				if(hint != 0) {
+					fail(QObject::tr("The compressed data file is truncated."));
+					retval = false;
+				}
+				break;
+			}
+			input.size = size_t(got);
+			input.pos = 0;
+		}
+		hint = ZSTD_decompressStream(zds, &output, &input);
+		if(ZSTD_isError(hint)) {
+			fail(QObject::tr("The compressed data file is damaged."));
+			retval = false;
+		}
+		pending = (output.pos == output.size);
+		if(retval && pending) {
+			retval = push(out);
+			out.resize(decompressedBlockBytes);
+			output.dst = out.data();
+			output.pos = 0;
+		}
+	}
+	if(retval && output.pos > 0) {
+		out.resize(int(output.pos));
+		retval = push(out);
+	}
+	ZSTD_freeDStream(zds);
+#else
+	Q_UNUSED(file);
+	retval = false;
+#endif
+	return retval;
+}
+
+
+//! Tells how a file is compressed from its first bytes.
+//! @returns Uncompressed if the file is not compressed, or cannot be read
+Decompressor::Compression Decompressor::compressionOf(const QString &fileURI)
+{
+	Compression retval = Uncompressed;
+	QFile file(fileURI);
+	if(file.open(QIODevice::ReadOnly)) {
+		QByteArray magic = file.read(4);
+		if(magic.startsWith("\x1f\x8b")) retval = Gzip;
+		else if(magic == QByteArray("\x28\xb5\x2f\xfd", 4)) retval = Zstd;
+	}
+	return retval;
+}
+
+
+//! @returns The name users know a compression by
+QString Decompressor::compressionName(Compression compression)
+{
+	if(compression == Gzip) return "gzip";
+	if(compression == Zstd) return "zstd";
+	return "uncompressed";
+}
+
+
+//! @returns Whether this build can decompress a compression
+bool Decompressor::isSupported(Compression compression)
+{
+	bool retval = (compression == Uncompressed);
+#ifdef WITH_ZLIB
+	if(compression == Gzip) retval = true;
+#endif
+#ifdef WITH_ZSTD
+	if(compression == Zstd) retval = true;
+#endif
+	return retval;
+}
+
+
+//! Reads the uncompressed size a compressed file records, without
+//! decompressing it. Needs neither zlib nor libzstd.
+//!  gzip: the ISIZE field which ends the file. It holds the size modulo
+//!        2^32, which is exact only if the file is too small to hold 4 GiB,
+//!        deflate compressing at most maxDeflateRatio:1. Larger files must
+//!        be decompressed to be measured, which is never done.
+//!  zstd: the content size in the header of the first frame, when the
+//!        compressor wrote one. zstd does when it compresses a whole file.
+//! A file of concatenated members or frames records only the size of one;
+//! such files are rare for captures. The size is only shown, never relied
+//! on: a conversion reads the file to its end whatever it records.
+//! @param size Receives the uncompressed size
+//! @returns false if the file records no usable size
+bool Decompressor::storedSize(const QString &fileURI, Compression compression,
+							  quint64 &size)
+{
+	bool retval = false;
+	QFile file(fileURI);
+	if(!file.open(QIODevice::ReadOnly)) {
+		retval = false;
+	}
+	else if(compression == Gzip) {
+		quint64 fileSize = file.size();
+		QByteArray trailer;
+		if(fileSize >= 18 && file.seek(fileSize - 4)) trailer = file.read(4);
+		if(trailer.size() == 4 &&
+		   fileSize * maxDeflateRatio < (Q_UINT64_C(1) << 32)) {
+			const uchar *p = reinterpret_cast<const uchar*>(trailer.constData());
+			size = quint64(p[0]) | quint64(p[1]) << 8 |
+					quint64(p[2]) << 16 | quint64(p[3]) << 24;
+			retval = true;
+		}
+	}
+	else if(compression == Zstd) {
+		QByteArray header = file.read(18);	// The longest frame header
+		const uchar *p = reinterpret_cast<const uchar*>(header.constData());
+		if(header.size() >= 6) {
+			int descriptor = p[4];
+			bool singleSegment = (descriptor >> 5) & 1;
+			static const int dictIdBytes[] = { 0, 1, 2, 4 };
+			static const int sizeBytes[] = { 0, 2, 4, 8 };
+			int fieldBytes = sizeBytes[descriptor >> 6];
+			if(fieldBytes == 0 && singleSegment) fieldBytes = 1;
+			int at = 5 + (singleSegment ? 0 : 1) + dictIdBytes[descriptor & 3];
+			if(fieldBytes > 0 && at + fieldBytes <= header.size()) {
+				size = 0;
+				for(int byte = fieldBytes - 1; byte >= 0; --byte)
+					size = (size << 8) | p[at + byte];
+				if(fieldBytes == 2) size += 256;
+				retval = true;
+			}
+		}
+	}
+	return retval;
+}
@@ -0,0 +1,77 @@
+/*
+	Name        : Decompressor.h
+	Author      : Charles N. Burns (charlesnburns|gmail|com / burnchar|isu|edu)
+	Date        : October 2026
+	License     : GPL3. See license.txt or www.gnu.org/licenses/gpl-3.0.txt
+	Requirements: Qt 4, data to parse, any spreadsheet program.
+				  zlib for gzip files and libzstd for zstd files; see
+				  DataParser.pro.
+	Notes       : Best viewed with tab width 4.
+	Description : Header file to define the Decompressor class.
+*/
+
+#ifndef DECOMPRESSOR_H
+#define DECOMPRESSOR_H
+
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QQueue>
+#include <QByteArray>
+#include <QString>
+#include <QFile>
+
+//! Bytes of decompressed data in each block handed to the reader
+const int decompressedBlockBytes = 1 << 20;
+//! Most blocks decompressed ahead of the reader, which caps the memory used
+const int decompressQueueBlocks = 8;
+//! Bytes of compressed data read from the file at once
+const int compressedReadBytes = 256 << 10;
+//! Most bytes deflate can expand to from one byte of compressed data
+const quint64 maxDeflateRatio = 1032;
+
+
+//! Decompresses a gzip or zstd data file on its own thread, a block at a
+//! time, so the file is read and inflated while the rows decoded from the
+//! previous blocks are converted. Blocks are taken in order with next().
+//! The thread runs at most decompressQueueBlocks ahead of the reader.
+class Decompressor : public QThread
+{
+public:
+	//! Compression of a data file, told by its first bytes, not its name
+	enum Compression { Uncompressed, Gzip, Zstd };
+
+private:
+	QString fileURI;
+	Compression compression;
+	QMutex mutex;
+	QWaitCondition queueChanged;
+	QQueue<QByteArray> queue;
+	bool ended;				// No more blocks will be queued
+	bool stopping;			// The reader wants no more blocks
+	QString error;			// Why the thread ended early, if it did
+
+	bool push(QByteArray &block);
+	void fail(const QString &message);
+	bool inflateGzip(QFile &file);
+	bool decompressZstd(QFile &file);
+
+protected:
+	void run();
+
+public:
+	QString errorMessage;
+	Decompressor();
+	~Decompressor();
+	bool begin(const QString &fileURI, Compression compression);
+	bool next(QByteArray &block);
+	void stop();
+
+	static Compression compressionOf(const QString &fileURI);
+	static QString compressionName(Compression compression);
+	static bool isSupported(Compression compression);
+	static bool storedSize(const QString &fileURI, Compression compression,
+						   quint64 &size);
+};
+
+#endif // DECOMPRESSOR_H
@@ -0,0 +1,142 @@
+/*
+	Name        : FileStats.cpp
+	Author      : Charles N. Burns (charlesnburns|gmail|com / burnchar|isu|edu)
+	Date        : October 2026
+	License     : GPL3. See license.txt or www.gnu.org/licenses/gpl-3.0.txt
+	Requirements: Qt 4, data to parse, any spreadsheet program.
+	Notes       : Best viewed with tab width 4.
+	Description : The FileStatsCache class keeps the size of the input file
+				  without touching the disk on the GUI thread. RowStats turns
+				  that size into everything the window displays about it.
+*/
+
+#include "FileStats.h"
+#include "Converter.h"
+#include "Decompressor.h"
+#include <QDir>
+#include <QStringList>
+
+//! Reads the size of a file. Runs on a worker thread.
+//! The size of a compressed file is the size of the data it records it
+//! holds, or 0 if it records none; it is never decompressed to be measured.
+static FileSnapshot statFile(const QString &path)
+{
+	FileSnapshot snapshot;
+	QFileInfo info(path);
+	snapshot.path = path;
+	snapshot.isFile = info.isFile();
+	snapshot.size = snapshot.isFile ? info.size() : 0;
+	Decompressor::Compression compression = snapshot.isFile ?
+			Decompressor::compressionOf(path) : Decompressor::Uncompressed;
+	if(compression != Decompressor::Uncompressed &&
+	   !Decompressor::storedSize(path, compression, snapshot.size))
+		snapshot.size = 0;
+	return snapshot;
+}
+
+
+//! Constructor for FileStatsCache class
+FileStatsCache::FileStatsCache(QObject *parent) : QObject(parent)
+{
+	this->valid = false;
+	this->restatWanted = false;
+	this->current.isFile = false;
+	this->current.size = 0;
+	connect(&pending, SIGNAL(finished()), this, SLOT(statFinished()));
+	connect(&watcher, SIGNAL(fileChanged(QString)), this, SLOT(fileChanged()));
+	connect(&watcher, SIGNAL(directoryChanged(QString)),
+			this, SLOT(fileChanged()));
+}
+
+
+//! Chooses the file the cache describes. Does nothing if it already does;
+//! otherwise the cache becomes invalid until changed() is emitted.
+//! @param path Path of the file, which need not exist
+void FileStatsCache::setPath(const QString &path)
+{
+	if(path == wantedPath) return;
+	wantedPath = path;
+	valid = false;
+	requestStat();
+}
+
+
+//! Starts a stat of the wanted file, or queues one if a stat is running.
+//! Only one runs at a time, so typing a path never piles up stat calls.
+void FileStatsCache::requestStat()
+{
+	if(pending.isRunning()) restatWanted = true;
+	else startStat();
+}
+
+
+//! Stats the wanted file on the global thread pool.
+void FileStatsCache::startStat()
+{
+	restatWanted = false;
+	pending.setFuture(QtConcurrent::run(statFile, wantedPath));
+}
+
+
+//! Keeps the result of a stat, if it is for the wanted file, and starts the
+//! next one if the path or the file changed meanwhile.
+void FileStatsCache::statFinished()
+{
+	FileSnapshot result = pending.result();
+	bool stale = (result.path != wantedPath);
+	if(stale || restatWanted) startStat();
+	if(stale) return;
+	bool same = valid && result.isFile == current.isFile &&
+				result.size == current.size;
+	current = result;
+	valid = true;
+	if(!same) {
+		watch(result);
+		emit changed();
+	}
+}
+
+
+//! Watches the file for changes, or its directory for the file's creation.
+void FileStatsCache::watch(const FileSnapshot &snapshot)
+{
+	QStringList paths = watcher.files() + watcher.directories();
+	if(!paths.isEmpty()) watcher.removePaths(paths);
+	if(snapshot.isFile) watcher.addPath(snapshot.path);
+	else if(!snapshot.path.isEmpty()) {
+		QFileInfo info(snapshot.path);
+		if(info.absoluteDir().exists()) watcher.addPath(info.absolutePath());
+	}
+}
+
+
+//! The watched file or directory changed; the cached size may be wrong.
+void FileStatsCache::fileChanged()
+{
+	requestStat();
+}
+
+
+//! Constructor for RowStats class. The stats are unknown until computed.
+RowStats::RowStats()
+{
+	this->known = false;
+	this->rows = 0;
+	this->divisor = 1;
+	this->partialRowBytes = 0;
+}
+
+
+//! Computes the row count, row limit divisor and partial row size at once.
+//! @param fileSize Size of the input file in bytes
+//! @param rowSize Size of one row of input data in bytes
+//! @param rowLimit Maximum number of rows in the output file, 0 for no limit
+//! @param writeColNames True if the first output row holds column names
+void RowStats::compute(quint64 fileSize, int rowSize, quint64 rowLimit,
+					   bool writeColNames)
+{
+	known = (rowSize > 0);
+	rows = Converter::numberRows(fileSize, rowSize);
+	divisor = Converter::rowLimitDivisor(rows, rowLimit, writeColNames);
+	partialRowBytes = known ? int(fileSize % rowSize) : 0;
+}
@@ -0,0 +1,79 @@
+/*
+	Name        : FileStats.h
+	Author      : Charles N. Burns (charlesnburns|gmail|com / burnchar|isu|edu)
+	Date        : October 2026
+	License     : GPL3. See license.txt or www.gnu.org/licenses/gpl-3.0.txt
+	Requirements: Qt 4, data to parse, any spreadsheet program.
+	Notes       : Best viewed with tab width 4.
+	Description : Header file to define the FileStatsCache and RowStats
+				  classes.
+*/
+
+#ifndef FILESTATS_H
+#define FILESTATS_H
+
+#include <QObject>
+#include <QString>
+#include <QFileInfo>
+#include <QFileSystemWatcher>
+#include <QFutureWatcher>
+#include <QtConcurrentRun>
+
+//! The result of one stat of a file.
+struct FileSnapshot
+{
+	QString path;
+	bool isFile;
+	quint64 size;
+};
+
+
+//! Keeps the size of one file, read on a worker thread so a slow disk or
+//! network share never stalls the GUI. The file is stat'ed again only when
+//! the path changes or QFileSystemWatcher reports a change to the file.
+class FileStatsCache : public QObject
+{
+	Q_OBJECT
+
+	QString wantedPath;		// The file the cache should describe
+	FileSnapshot current;	// Last result for wantedPath, if valid
+	bool valid;
+	bool restatWanted;		// Stat again when the running stat finishes
+	QFileSystemWatcher watcher;
+	QFutureWatcher<FileSnapshot> pending;
+
+	void startStat();
+	void requestStat();
+	void watch(const FileSnapshot &snapshot);
+
+private slots:
+	void statFinished();
+	void fileChanged();
+
+public:
+	explicit FileStatsCache(QObject *parent = 0);
+	void setPath(const QString &path);
+	bool isValid() const { return valid; }
+	bool isFile() const { return valid && current.isFile; }
+	quint64 size() const { return current.size; }
+
+signals:
+	void changed();
+};
+
+
+//! What the size of an input file means under a given column layout.
+class RowStats
+{
+public:
+	RowStats();
+	void compute(quint64 fileSize, int rowSize, quint64 rowLimit,
+				 bool writeColNames);
+
+	bool known;				// False until compute() is given a usable layout
+	quint64 rows;			// Counting a trailing partial row as a row
+	quint64 divisor;		// Keep 1 in this many rows; see rowLimitDivisor()
+	int partialRowBytes;	// Bytes in the trailing partial row, 0 if none
+};
+
+#endif // FILESTATS_H
@@ -0,0 +1,406 @@
+/*
+	Name        : FrameIndex.cpp
+	Author      : Charles N. Burns (charlesnburns|gmail|com / burnchar|isu|edu)
+	Date        : October 2026
+	License     : GPL3. See license.txt or www.gnu.org/licenses/gpl-3.0.txt
+	Requirements: Qt 4, data to parse, any spreadsheet program.
+	Notes       : Best viewed with tab width 4.
+	Description : The FrameIndex class lets captures of framed records, such as
+				  those from a radio link, be converted even when bytes were
+				  dropped or damaged, by finding where each good frame starts.
+				  The sync word is searched for with AVX2 when the compiler
+				  targets it, SSE2 otherwise on x86, and memchr() elsewhere.
+*/
+
+#include "FrameIndex.h"
+#include <QObject>
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define FRAME_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || \
+	(defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define FRAME_SSE2
+#endif
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+
+//! @returns The index of the lowest set bit of a non-zero mask
+static inline int lowestBit(quint32 mask)
+{
+#if defined(__GNUC__)
+	return __builtin_ctz(mask);
+#elif defined(_MSC_VER)
+	unsigned long index;
+	_BitScanForward(&index, mask);
+	return int(index);
+#else
+	int index = 0;
+	while(!(mask & 1)) {
+		mask >>= 1;
+		++index;
+	}
+	return index;
+#endif
+}
+
+
+//! Constructor for FrameFormat class. The file is not framed.
+FrameFormat::FrameFormat()
+{
+	this->lengthByte = false;
+	this->checksum = NoChecksum;
+}
+
+
+//! @returns The bytes of the checksum which ends each frame
+int FrameFormat::checksumBytes() const
+{
+	switch(checksum) {
+	case Sum8: return 1;
+	case Xor8: return 1;
+	case Crc16: return 2;
+	case Crc32: return 4;
+	default: return 0;
+	}
+}
+
+
+//! Sets the sync word from hex digits, such as "A55A" or "eb 90". Empty
+//! text means the file is not framed.
+//! @returns false, leaving the sync word unchanged, if the text is not an
+//!			 even number of hex digits, or is longer than maxSyncBytes
+bool FrameFormat::setSyncHex(const QString &hex)
+{
+	QString digits = hex;
+	digits.remove(' ');
+	bool retval = (digits.size() % 2 == 0 &&
+				   digits.size() <= maxSyncBytes * 2);
+	QByteArray bytes;
+	for(int index = 0; retval && index < digits.size(); index += 2) {
+		int value = digits.mid(index, 2).toInt(&retval, 16);
+		bytes.append(char(value));
+	}
+	if(retval) sync = bytes;
+	return retval;
+}
+
+
+//! @returns The sync word as hex digits, or an empty string if unframed
+QString FrameFormat::syncHex() const
+{
+	return QString(sync.toHex().toUpper());
+}
+
+
+//! @returns The checksum stored in a settings file under the given name
+FrameFormat::Checksum FrameFormat::checksumFromName(const QString &name)
+{
+	if(name == "sum8") return Sum8;
+	if(name == "xor8") return Xor8;
+	if(name == "crc16") return Crc16;
+	if(name == "crc32") return Crc32;
+	return NoChecksum;
+}
+
+
+//! @returns The name under which a checksum is stored in a settings file
+QString FrameFormat::checksumName(Checksum checksum)
+{
+	switch(checksum) {
+	case Sum8: return "sum8";
+	case Xor8: return "xor8";
+	case Crc16: return "crc16";
+	case Crc32: return "crc32";
+	default: return "none";
+	}
+}
+
+
+//! Constructor for FrameIndex class
+FrameIndex::FrameIndex()
+{
+	this->bigEndian = false;
+	this->payloadBytes = 0;
+	this->frameBytes = 0;
+	this->rows = 0;
+	this->scanned = 0;
+	this->locked = true;
+	this->badFrames = 0;
+}
+
+
+//! Prepares to scan a file from its start.
+//! @param format How the rows are framed. Must have a sync word.
+//! @param payloadBytes Bytes of one row
+//! @param bigEndian True if the checksum is stored big-endian
+//! @returns false if the format cannot hold such rows
+bool FrameIndex::setup(const FrameFormat &format, int payloadBytes,
+					   bool bigEndian)
+{
+	bool retval = true;
+	if(!format.isFramed() || format.sync.size() > maxSyncBytes) {
+		errorMessage = QObject::tr("The sync word must have 1 to %1 bytes.")
+				.arg(maxSyncBytes);
+		retval = false;
+	}
+	else if(format.lengthByte && payloadBytes > 255) {
+		errorMessage = QObject::tr("A length byte cannot count the %1 bytes "
+								   "of a row.").arg(payloadBytes);
+		retval = false;
+	}
+	else {
+		this->format = format;
+		this->bigEndian = bigEndian;
+		this->payloadBytes = payloadBytes;
+		frameBytes = format.headerBytes() + payloadBytes +
+				format.checksumBytes();
+		runs.clear();
+		rows = 0;
+		scanned = 0;
+		locked = true;
+		badFrames = 0;
+
+		bool tabled = (format.checksum == FrameFormat::Crc16 ||
+					   format.checksum == FrameFormat::Crc32);
+		crcTable.resize(tabled ? 256 : 0);
+		for(quint32 byte = 0; tabled && byte < 256; ++byte) {
+			quint32 crc;
+			if(format.checksum == FrameFormat::Crc16) {
+				crc = byte << 8;
+				for(int bit = 0; bit < 8; ++bit)
+					crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+				crc &= 0xffff;
+			}
+			else {
+				crc = byte;
+				for(int bit = 0; bit < 8; ++bit)
+					crc = (crc & 1) ? (crc >> 1) ^ 0xedb88320u : crc >> 1;
+			}
+			crcTable[byte] = crc;
+		}
+	}
+	return retval;
+}
+
+
+//! Finds the frames in a range of the file, continuing from where the last
+//! scan stopped. Stops before a frame which cannot yet be checked, so the
+//! next scan, given more of the file, picks it up.
+//! @param data The bytes of the range
+//! @param start Position of the range in the file. Must not be after
+//!		   scannedTo().
+//! @param end Position of the end of the range in the file
+//! @param atEnd True if the range ends the file, so the last frame need not
+//!		   be followed by another sync word
+void FrameIndex::scan(const uchar *data, quint64 start, quint64 end,
+					  bool atEnd)
+{
+	quint64 at = scanned;
+	for(;;) {
+		if(locked) {
+			FrameCheck check = checkFrame(data, start, at, end, atEnd);
+			if(check == Incomplete) break;
+			if(check == Good) {
+				addFrame(at);
+				at += frameBytes;
+				continue;
+			}
+			++badFrames;
+			locked = false;
+			++at;
+		}
+
+		// Resynchronize, at the first sync word which starts a good frame
+		if(end < at || end - at < quint64(frameBytes)) break;
+		quint64 last = end - frameBytes;	// Last start of a whole frame
+		quint64 found = at + findSync(data + (at - start), last - at + 1);
+		if(found > last) {
+			at = last + 1;
+			break;
+		}
+		FrameCheck check = checkFrame(data, start, found, end, atEnd);
+		if(check == Incomplete) {
+			at = found;
+			break;
+		}
+		locked = (check == Good);
+		at = locked ? found : found + 1;
+	}
+	scanned = at;
+}
+
+
+//! Checks the frame at a position. Without a checksum, a frame is only good
+//! if another sync word follows it, or it ends the file; otherwise a frame
+//! which lost a byte would be taken whole, with a byte of the next frame.
+//! @see scan()
+FrameIndex::FrameCheck FrameIndex::checkFrame(const uchar *data,
+											  quint64 start, quint64 at,
+											  quint64 end, bool atEnd) const
+{
+	if(end < at || end - at < quint64(frameBytes)) return Incomplete;
+	if(!isFrame(data + (at - start))) return Bad;
+	if(format.checksum != FrameFormat::NoChecksum) return Good;
+	quint64 next = at + frameBytes;
+	int syncBytes = format.sync.size();
+	if(end - next >= quint64(syncBytes))
+		return (memcmp(data + (next - start), format.sync.constData(),
+					   syncBytes) == 0) ? Good : Bad;
+	return atEnd ? Good : Incomplete;
+}
+
+
+//! @returns Whether a whole frame starting at frame is good
+bool FrameIndex::isFrame(const uchar *frame) const
+{
+	const int syncBytes = format.sync.size();
+	if(memcmp(frame, format.sync.constData(), syncBytes) != 0) return false;
+	if(format.lengthByte && frame[syncBytes] != payloadBytes) return false;
+	int checksumBytes = format.checksumBytes();
+	if(checksumBytes == 0) return true;
+
+	int covered = frameBytes - syncBytes - checksumBytes;
+	const uchar *stored = frame + frameBytes - checksumBytes;
+	quint32 value = 0;
+	for(int index = 0; index < checksumBytes; ++index) {
+		int shift = (bigEndian ? checksumBytes - 1 - index : index) << 3;
+		value |= quint32(stored[index]) << shift;
+	}
+	return value == checksumOf(frame + syncBytes, covered);
+}
+
+
+//! @returns The frame format's checksum of count bytes
+quint32 FrameIndex::checksumOf(const uchar *bytes, int count) const
+{
+	const quint32 *table = crcTable.constData();
+	quint32 value = 0;
+	switch(format.checksum) {
+	case FrameFormat::Sum8:
+		for(int index = 0; index < count; ++index) value += bytes[index];
+		return value & 0xff;
+	case FrameFormat::Xor8:
+		for(int index = 0; index < count; ++index) value ^= bytes[index];
+		return value;
+	case FrameFormat::Crc16:
+		value = 0xffff;
+		for(int index = 0; index < count; ++index)
+			value = ((value << 8) & 0xffff) ^
+					table[((value >> 8) ^ bytes[index]) & 0xff];
+		return value;
+	case FrameFormat::Crc32:
+		value = 0xffffffffu;
+		for(int index = 0; index < count; ++index)
+			value = (value >> 8) ^ table[(value ^ bytes[index]) & 0xff];
+		return ~value;
+	default:
+		return 0;
+	}
+}
+
+
+//! Finds the first position at which the sync word starts. Vectors of
+//! positions are tested for the first two bytes of the sync word at once,
+//! so noise is passed over many bytes per instruction, and only the rare
+//! positions which match both are compared in full.
+//! @param data The first position to test
+//! @param count Positions to test. The whole sync word must be readable at
+//!		   each, and a byte past the last for a sync word of 2 or more bytes.
+//! @returns The index of the position, or count if there is none
+quint64 FrameIndex::findSync(const uchar *data, quint64 count) const
+{
+	const char *sync = format.sync.constData();
+	const int syncBytes = format.sync.size();
+	quint64 index = 0;
+#if defined(FRAME_AVX2)
+	const __m256i first = _mm256_set1_epi8(sync[0]);
+	const __m256i second = _mm256_set1_epi8(syncBytes > 1 ? sync[1] : 0);
+	for(; index + 32 <= count; index += 32) {
+		const __m256i *at = reinterpret_cast<const __m256i*>(data + index);
+		quint32 mask = quint32(_mm256_movemask_epi8(
+				_mm256_cmpeq_epi8(_mm256_loadu_si256(at), first)));
+		if(syncBytes > 1) {
+			const __m256i *next = reinterpret_cast<const __m256i*>(
+					data + index + 1);
+			mask &= quint32(_mm256_movemask_epi8(
+					_mm256_cmpeq_epi8(_mm256_loadu_si256(next), second)));
+		}
+		for(; mask != 0; mask &= mask - 1) {
+			quint64 found = index + lowestBit(mask);
+			if(memcmp(data + found, sync, syncBytes) == 0) return found;
+		}
+	}
+#elif defined(FRAME_SSE2)
+	const __m128i first = _mm_set1_epi8(sync[0]);
+	const __m128i second = _mm_set1_epi8(syncBytes > 1 ? sync[1] : 0);
+	for(; index + 16 <= count; index += 16) {
+		const __m128i *at = reinterpret_cast<const __m128i*>(data + index);
+		quint32 mask = quint32(_mm_movemask_epi8(
+				_mm_cmpeq_epi8(_mm_loadu_si128(at), first)));
+		if(syncBytes > 1) {
+			const __m128i *next = reinterpret_cast<const __m128i*>(
+					data + index + 1);
+			mask &= quint32(_mm_movemask_epi8(
+					_mm_cmpeq_epi8(_mm_loadu_si128(next), second)));
+		}
+		for(; mask != 0; mask &= mask - 1) {
+			quint64 found = index + lowestBit(mask);
+			if(memcmp(data + found, sync, syncBytes) == 0) return found;
+		}
+	}
+#endif
+	while(index < count) { // memchr() is vectorized by most C libraries
+		const void *found = memchr(data + index, uchar(sync[0]),
+								   size_t(count - index));
+		if(found == 0) break;
+		index = static_cast<const uchar*>(found) - data;
+		if(memcmp(data + index, sync, syncBytes) == 0) return index;
+		++index;
+	}
+	return count;
+}
+
+
+//! Records a good frame, adding it to the last run if it follows it.
+void FrameIndex::addFrame(quint64 offset)
+{
+	if(!runs.isEmpty()) {
+		Run &run = runs.last();
+		if(run.offset + run.frames * frameBytes == offset) {
+			++run.frames;
+			++rows;
+			return;
+		}
+	}
+	Run run;
+	run.offset = offset;
+	run.firstRow = rows;
+	run.frames = 1;
+	runs.append(run);
+	++rows;
+}
+
+
+//! Finds where a row is in the file.
+//! @param row A row number, less than rowCount()
+//! @param following Receives the number of rows, from this one on, whose
+//!		   frames follow one another, bytesPerFrame() apart
+//! @returns The position in the file of the first byte of the row
+quint64 FrameIndex::rowOffset(quint64 row, quint64 &following) const
+{
+	int low = 0, high = runs.size() - 1;	// Binary search for the run
+	while(low < high) {
+		int middle = (low + high + 1) / 2;
+		if(runs.at(middle).firstRow <= row) low = middle;
+		else high = middle - 1;
+	}
+	const Run &run = runs.at(low);
+	quint64 index = row - run.firstRow;
+	following = run.frames - index;
+	return run.offset + index * frameBytes + format.headerBytes();
+}
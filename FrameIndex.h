@@ -0,0 +1,106 @@
+/*
+	Name        : FrameIndex.h
+	Author      : Charles N. Burns (charlesnburns|gmail|com / burnchar|isu|edu)
+	Date        : October 2026
+	License     : GPL3. See license.txt or www.gnu.org/licenses/gpl-3.0.txt
+	Requirements: Qt 4, data to parse, any spreadsheet program.
+	Notes       : Best viewed with tab width 4.
+	Description : Header file to define the FrameFormat and FrameIndex classes.
+*/
+
+#ifndef FRAMEINDEX_H
+#define FRAMEINDEX_H
+
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+
+//! Most bytes in a sync word
+const int maxSyncBytes = 8;
+
+
+//! How each row of a framed data file is wrapped, as a radio link or serial
+//! logger sends it:
+//!   sync word | length byte (optional) | row | checksum (optional)
+//! The length byte counts the bytes of the row. The checksum covers the
+//! length byte and the row, and is stored in the data's byte order.
+//!  Sum8:  the low byte of the sum of the bytes
+//!  Xor8:  the exclusive-or of the bytes
+//!  Crc16: CRC-16/CCITT-FALSE (polynomial 0x1021, initial value 0xFFFF)
+//!  Crc32: the CRC-32 of zlib, Ethernet and PNG
+class FrameFormat
+{
+public:
+	enum Checksum { NoChecksum, Sum8, Xor8, Crc16, Crc32 };
+
+	FrameFormat();
+	bool isFramed() const { return !sync.isEmpty(); }
+	int headerBytes() const { return sync.size() + (lengthByte ? 1 : 0); }
+	int checksumBytes() const;
+	bool setSyncHex(const QString &hex);
+	QString syncHex() const;
+
+	static Checksum checksumFromName(const QString &name);
+	static QString checksumName(Checksum checksum);
+
+	QByteArray sync;	// Starts every frame; empty if the file is not framed
+	bool lengthByte;
+	Checksum checksum;
+};
+
+
+//! Finds the frames of a framed data file, so its rows can be read as if
+//! they were stored one after another. Good frames are recorded as runs of
+//! adjacent frames, so memory grows with the number of corrupt stretches,
+//! not with the size of the file.
+//! While frames follow one another, each is only checked. When one is bad,
+//! such as after a dropped byte, the scan is resynchronized: the bytes
+//! after it are searched with vector instructions for the next sync word
+//! which starts a good frame. Without a checksum, every frame must also be
+//! followed by a sync word, so neither a sync pattern within a row nor a
+//! frame which lost a byte is taken for a good frame.
+//! A file may be scanned in pieces, as it grows or through a moving window;
+//! each scan continues where the last one stopped.
+class FrameIndex
+{
+	enum FrameCheck { Good, Bad, Incomplete };
+
+	//! Frames which follow one another in the file
+	struct Run
+	{
+		quint64 offset;		// Of the first frame in the file
+		quint64 firstRow;	// Row number of the first frame
+		quint64 frames;
+	};
+
+	FrameFormat format;
+	bool bigEndian;			// Byte order of a checksum
+	int payloadBytes;		// Bytes of one row
+	int frameBytes;			// Bytes of one frame
+	QVector<quint32> crcTable;
+	QVector<Run> runs;
+	quint64 rows;			// Good frames found
+	quint64 scanned;		// File position the next scan starts at
+	bool locked;			// A frame is expected at scanned
+	quint64 badFrames;
+
+	FrameCheck checkFrame(const uchar *data, quint64 start, quint64 at,
+						  quint64 end, bool atEnd) const;
+	bool isFrame(const uchar *frame) const;
+	quint32 checksumOf(const uchar *bytes, int count) const;
+	quint64 findSync(const uchar *data, quint64 count) const;
+	void addFrame(quint64 offset);
+
+public:
+	QString errorMessage;
+	FrameIndex();
+	bool setup(const FrameFormat &format, int payloadBytes, bool bigEndian);
+	void scan(const uchar *data, quint64 start, quint64 end, bool atEnd);
+	quint64 scannedTo() const { return scanned; }
+	quint64 rowCount() const { return rows; }
+	quint64 badFrameCount() const { return badFrames; }
+	quint64 bytesPerFrame() const { return frameBytes; }
+	quint64 rowOffset(quint64 row, quint64 &following) const;
+};
+
+#endif // FRAMEINDEX_H
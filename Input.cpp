@@ -0,0 +1,496 @@
+/*
+	Name        : Input.cpp
+	Author      : Charles N. Burns (charlesnburns|gmail|com / burnchar|isu|edu)
+	Date        : October 2026
+	License     : GPL3. See license.txt or www.gnu.org/licenses/gpl-3.0.txt
+	Requirements: Qt 4, data to parse, any spreadsheet program.
+	Notes       : Best viewed with tab width 4.
+	Description : The MappedInput class gives the converter direct access to
+				  the bytes of the input file, so rows are decoded straight from
+				  the page cache instead of through one read() per column.
+*/
+
+#include "Input.h"
+#include <cstring>
+#ifdef Q_OS_UNIX
+#include <fcntl.h>
+#include <sys/types.h>
+#endif
+
+//! Constructor for MappedInput class
+MappedInput::MappedInput()
+{
+	this->window = 0;
+	this->windowStart = 0;
+	this->windowLength = 0;
+	this->fileSize = 0;
+	this->compression = Decompressor::Uncompressed;
+	this->stream = 0;
+	this->streamStart = 0;
+	this->streamEnded = false;
+	this->frames = 0;
+	this->frameRowBytes = 0;
+	this->pattern = NoPattern;
+	this->patternWork = 0;
+	this->sequentialRate = defaultSequentialBytesPerSec;
+	this->sparseRate = defaultSparseRowsPerSec;
+}
+
+
+//! Destructor for MappedInput class. Unmaps and closes the file.
+MappedInput::~MappedInput()
+{
+	close();
+}
+
+
+//! Opens the input file. Nothing is mapped until map() is called.
+//! A compressed file starts being decompressed at once.
+//! @param fileURI Path of the data file
+//! @returns false if the file cannot be opened, true otherwise
+bool MappedInput::open(const QString &fileURI)
+{
+	bool retval = true;
+	close();
+	file.setFileName(fileURI);
+	if(!file.open(QIODevice::ReadOnly)) {
+		errorMessage = QObject::tr("Cannot open data file for reading.");
+		retval = false;
+	}
+	else {
+		compression = Decompressor::compressionOf(fileURI);
+		if(compression == Decompressor::Uncompressed) fileSize = file.size();
+		else retval = openStream();
+	}
+	return retval;
+}
+
+
+//! Starts the thread which decompresses a compressed file.
+//! @returns false if the file cannot be decompressed
+bool MappedInput::openStream()
+{
+	bool retval = Decompressor::isSupported(compression);
+	if(!retval) {
+		errorMessage = QObject::tr("This build cannot read %1 compressed "
+								   "data files.")
+				.arg(Decompressor::compressionName(compression));
+	}
+	else {
+		stream = new Decompressor;
+		retval = stream->begin(file.fileName(), compression);
+		if(!retval) errorMessage = stream->errorMessage;
+	}
+	return retval;
+}
+
+
+//! Unmaps the current window, if any, and closes the file.
+void MappedInput::close()
+{
+	unmapWindow();
+	delete stream;	// Stops its thread
+	stream = 0;
+	streamBuffer.clear();
+	streamStart = 0;
+	streamEnded = false;
+	delete frames;
+	frames = 0;
+	frameRowBytes = 0;
+	frameBuffer.clear();
+	compression = Decompressor::Uncompressed;
+	if(file.isOpen()) file.close();
+	fileSize = 0;
+	pattern = NoPattern;
+	patternWork = 0;
+	sequentialRate = defaultSequentialBytesPerSec;
+	sparseRate = defaultSparseRowsPerSec;
+}
+
+
+//! Rereads the size of the file, which may have grown since it was opened.
+//! The frames of a framed file are then found in the bytes it grew by.
+//! Time spent waiting for it to grow is not time spent reading, so the
+//! throughput measurement of adviseRows() starts over.
+//! A compressed file cannot grow while it is read; see fill().
+//! @returns false if the file is no longer open, is compressed or cannot be
+//!			 scanned for frames, true otherwise
+bool MappedInput::refresh()
+{
+	bool retval = file.isOpen() && stream == 0;
+	if(!retval) errorMessage = QObject::tr("Error reading data file.");
+	else {
+		fileSize = file.size();
+		if(frames != 0) retval = scanFrames();
+	}
+	patternWork = 0;
+	patternClock.start();
+	return retval;
+}
+
+
+//! Reads the file as framed rows from now on, and finds the frames of the
+//! whole file. Must be called before anything is mapped.
+//! @param format How each row is framed
+//! @param rowBytes Bytes of the row in each frame
+//! @param bigEndian Byte order of the checksum
+//! @returns false if the format is invalid, the file is compressed or the
+//!			 file cannot be scanned
+bool MappedInput::setFraming(const FrameFormat &format, int rowBytes,
+							 bool bigEndian)
+{
+	bool retval = (stream == 0);
+	if(!retval) {
+		errorMessage = QObject::tr("A compressed data file cannot be framed.");
+	}
+	else {
+		frames = new FrameIndex;
+		frameRowBytes = rowBytes;
+		retval = frames->setup(format, rowBytes, bigEndian);
+		if(!retval) {
+			errorMessage = frames->errorMessage;
+			delete frames;
+			frames = 0;
+		}
+		else retval = scanFrames();
+	}
+	return retval;
+}
+
+
+//! Finds the frames of the file from where the last scan stopped to the
+//! end, a window at a time. Frames are only checked while they follow one
+//! another, so this runs at about the speed the file can be read.
+//! @returns false if the file cannot be mapped
+bool MappedInput::scanFrames()
+{
+	bool retval = true;
+	if(pattern != Sequential) hintPattern(Sequential);
+	pattern = Sequential;
+	while(retval && frames->scannedTo() < fileSize) {
+		quint64 start = frames->scannedTo();
+		quint64 length = qMin(fileWindowSize(), fileSize - start);
+		const uchar *data = mapFile(start, length);
+		retval = (data != 0);
+		if(retval) {
+			quint64 end = start + length;
+			frames->scan(data, start, end, end == fileSize);
+			// A frame longer than the window waits for the file to grow
+			if(frames->scannedTo() == start) break;
+		}
+	}
+	return retval;
+}
+
+
+//! @returns Bytes of data: of the rows of good frames if the file is framed,
+//!			 or decompressed so far if it is compressed
+quint64 MappedInput::size() const
+{
+	if(frames != 0) return frames->rowCount() * frameRowBytes;
+	if(stream != 0) return streamStart + streamBuffer.size();
+	return fileSize;
+}
+
+
+//! Decompresses a compressed file until size() reaches a number of bytes,
+//! or the file ends. Does nothing for any other file.
+//! @param bytes Size the data should reach
+//! @returns false if the file is damaged
+bool MappedInput::fill(quint64 bytes)
+{
+	bool retval = true;
+	while(retval && stream != 0 && !streamEnded && size() < bytes) {
+		QByteArray block;
+		if(!stream->next(block)) {
+			streamEnded = true;
+			errorMessage = stream->errorMessage;
+			retval = errorMessage.isEmpty();
+		}
+		else if(streamBuffer.isEmpty()) streamBuffer = block;
+		else streamBuffer.append(block);
+	}
+	return retval;
+}
+
+
+//! @returns true unless the file is compressed and not yet fully
+//!			 decompressed, so that size() may still grow
+bool MappedInput::atEnd() const
+{
+	return stream == 0 || streamEnded;
+}
+
+
+//! @returns Frames of a framed file found to be bad, such as by a dropped
+//!			 byte or a wrong checksum; 0 if the file is not framed
+quint64 MappedInput::badFrameCount() const
+{
+	return (frames != 0) ? frames->badFrameCount() : 0;
+}
+
+
+//! @returns Bytes of a framed file outside its good frames, such as those
+//!			 skipped while resynchronizing; 0 if the file is not framed
+quint64 MappedInput::unframedBytes() const
+{
+	if(frames == 0) return 0;
+	return fileSize - frames->rowCount() * frames->bytesPerFrame();
+}
+
+
+//! Checks that a compressed file was decompressed to its end without error,
+//! once every row has been read.
+//! @returns false if the data is damaged, or was not all read
+bool MappedInput::checkEnd()
+{
+	bool retval = true;
+	if(stream != 0) {
+		quint64 end = size();
+		retval = fill(end + 1);
+		if(retval && size() != end) {
+			errorMessage = QObject::tr("Not all of the compressed data file "
+									   "was read.");
+			retval = false;
+		}
+	}
+	return retval;
+}
+
+
+//! Releases the currently mapped window of the file.
+void MappedInput::unmapWindow()
+{
+	if(window != 0) file.unmap(window);
+	window = 0;
+	windowStart = 0;
+	windowLength = 0;
+}
+
+
+//! @returns The largest number of bytes which will be mapped at once
+quint64 MappedInput::maxWindowSize() const
+{
+	if(stream != 0 || frames != 0) return mappedWindowBytes32; // In memory
+	return fileWindowSize();
+}
+
+
+//! @returns The number of bytes of the file mapped at once
+quint64 MappedInput::fileWindowSize() const
+{
+	if(sizeof(void*) >= 8) return fileSize;
+	return mappedWindowBytes32;
+}
+
+
+//! Gives access to a range of bytes of the input file. The pointer stays
+//! valid until the next call to map() or close().
+//! @param offset Position in the file of the first byte needed
+//! @param length Number of bytes needed. Must not exceed maxWindowSize().
+//! @returns Pointer to the byte at offset, or 0 on error
+const uchar *MappedInput::map(quint64 offset, quint64 length)
+{
+	const uchar *retval = 0;
+	if(offset + length > size()) {
+		errorMessage = QObject::tr("Error reading data file.");
+	}
+	else if(stream != 0) retval = mapStream(offset, length);
+	else if(frames != 0) retval = mapFrames(offset, length);
+	else retval = mapFile(offset, length);
+	return retval;
+}
+
+
+//! Gives access to a range of bytes of the file itself, moving the window
+//! if it does not hold the whole range.
+//! @returns Pointer to the byte at offset, or 0 on error
+const uchar *MappedInput::mapFile(quint64 offset, quint64 length)
+{
+	const uchar *retval = 0;
+	if(window != 0 && offset >= windowStart &&
+	   offset + length <= windowStart + windowLength) {
+		retval = window + (offset - windowStart);
+	}
+	else {
+		unmapWindow();
+		quint64 mapLength = fileWindowSize();
+		if(mapLength < length) mapLength = length;
+		if(mapLength > fileSize - offset) mapLength = fileSize - offset;
+		window = file.map(offset, mapLength);
+		if(window == 0) {
+			errorMessage = QObject::tr("Unable to map data file: %1")
+					.arg(file.errorString());
+		}
+		else {
+			windowStart = offset;
+			windowLength = mapLength;
+			retval = window;
+		}
+	}
+	return retval;
+}
+
+
+//! Gives access to a range of the rows of a framed file, which are copied
+//! out of their frames. Each run of adjacent good frames is mapped at once,
+//! or as much of it as fits in the window.
+//! @returns Pointer to the byte at offset, or 0 on error
+const uchar *MappedInput::mapFrames(quint64 offset, quint64 length)
+{
+	frameBuffer.resize(int(length));
+	uchar *out = reinterpret_cast<uchar*>(frameBuffer.data());
+	quint64 frameBytes = frames->bytesPerFrame();
+	quint64 windowFrames = qMax(Q_UINT64_C(1), fileWindowSize() / frameBytes);
+	quint64 done = 0;
+	while(done < length) {
+		quint64 row = (offset + done) / frameRowBytes;
+		quint64 skip = (offset + done) % frameRowBytes;	// In the first row
+		quint64 following;
+		quint64 from = frames->rowOffset(row, following);
+		quint64 count = (skip + (length - done) + frameRowBytes - 1) /
+				frameRowBytes;
+		count = qMin(count, qMin(following, windowFrames));
+		const uchar *data = mapFile(from, (count - 1) * frameBytes +
+									frameRowBytes);
+		if(data == 0) return 0;
+		for(quint64 frame = 0; frame < count; ++frame) {
+			quint64 bytes = qMin(frameRowBytes - skip, length - done);
+			memcpy(out + done, data + frame * frameBytes + skip, bytes);
+			done += bytes;
+			skip = 0;
+		}
+	}
+	return out;
+}
+
+
+//! Gives access to a range of the decompressed data. Bytes before offset
+//! are dropped, and blocks are taken from the decompressing thread until the
+//! range is complete. Blocks wholly before offset are never kept at all.
+//! @returns Pointer to the byte at offset, or 0 on error
+const uchar *MappedInput::mapStream(quint64 offset, quint64 length)
+{
+	if(offset < streamStart) {
+		errorMessage = QObject::tr("A compressed data file can only be read "
+								   "from start to end.");
+		return 0;
+	}
+	quint64 drop = qMin(offset - streamStart, quint64(streamBuffer.size()));
+	if(drop > 0) {
+		streamBuffer.remove(0, int(drop));
+		streamStart += drop;
+	}
+	while(streamStart + streamBuffer.size() < offset + length) {
+		QByteArray block;
+		if(!stream->next(block)) {
+			streamEnded = true;
+			errorMessage = stream->errorMessage;
+			if(errorMessage.isEmpty()) errorMessage = QObject::tr(
+					"The compressed data file ended early.");
+			return 0;
+		}
+		if(streamStart < offset) { // Then streamBuffer is empty
+			int skip = int(qMin(offset - streamStart, quint64(block.size())));
+			block.remove(0, skip);
+			streamStart += skip;
+		}
+		if(streamBuffer.isEmpty()) streamBuffer = block;
+		else streamBuffer.append(block);
+	}
+	return reinterpret_cast<const uchar*>(streamBuffer.constData()) +
+			(offset - streamStart);
+}
+
+
+//! Tells the kernel which rows of the file will be read next, so it fetches
+//! them as one batch while they are queued for conversion. Rows close together
+//! are fetched as one sequential range, and the kernel keeps reading ahead.
+//! Rows far apart are fetched one by one, without readahead, so the bytes
+//! between them are never read. That is much faster for a large row limit
+//! divisor on a spinning disk or a network share, and for a few columns of
+//! rows wider than a page, as only the needed part of each row is fetched.
+//! The cheaper way is chosen
+//! from the gap between rows and the throughput measured for each way.
+//! Hints never change what is read, only when; errors are ignored.
+//! A compressed file needs none, as it is read ahead by its own thread, nor
+//! does a framed file, as its rows were read when its frames were found.
+//! @param offset Position in the file of the first byte needed of the first
+//!		   row
+//! @param stride Bytes from the start of one row to the start of the next
+//! @param count Number of rows
+//! @param length Bytes needed of each row, from the first byte needed
+void MappedInput::adviseRows(quint64 offset, quint64 stride, quint64 count,
+							 quint64 length)
+{
+	if(stream != 0 || frames != 0) return;
+	measurePattern();
+	if(count < 1 || offset >= fileSize) return;
+	quint64 span = (count - 1) * stride + length;
+	if(span > fileSize - offset) span = fileSize - offset;
+
+	ReadPattern wanted = (count / sparseRate < span / sequentialRate) ?
+			Sparse : Sequential;
+	if(wanted != pattern) {
+		hintPattern(wanted);
+		pattern = wanted;
+		patternWork = 0;
+		patternClock.start();
+	}
+	if(wanted == Sparse) {
+		for(quint64 row = 0; row < count; ++row) {
+			quint64 start = offset + row * stride;
+			if(start >= fileSize) break;
+			prefetch(start, qMin(length, fileSize - start));
+		}
+		patternWork += count;
+	}
+	else {
+		prefetch(offset, qMin(span, maxReadAheadBytes));
+		patternWork += span;
+	}
+}
+
+
+//! Updates the throughput of the current read pattern from the time taken to
+//! read and convert the rows advised since its clock was started. Too short a
+//! time gives no useful measure, so the work keeps adding up until then.
+void MappedInput::measurePattern()
+{
+	if(pattern == NoPattern || patternWork <= 0) return;
+	qint64 elapsed = patternClock.elapsed();
+	if(elapsed < minMeasuredMs) return;
+	double rate = patternWork * 1000.0 / elapsed;
+	if(pattern == Sparse) sparseRate = (sparseRate + rate) / 2;
+	else sequentialRate = (sequentialRate + rate) / 2;
+	patternWork = 0;
+	patternClock.start();
+}
+
+
+//! Sets how far the kernel reads ahead of each read of the whole file.
+void MappedInput::hintPattern(ReadPattern pattern)
+{
+#ifdef POSIX_FADV_SEQUENTIAL
+	posix_fadvise(file.handle(), 0, 0, (pattern == Sparse) ?
+					  POSIX_FADV_RANDOM : POSIX_FADV_SEQUENTIAL);
+#else
+	Q_UNUSED(pattern);
+#endif
+}
+
+
+//! Asks the kernel to start reading a range of the file into the page cache.
+//! Returns at once; the range is read in the background.
+void MappedInput::prefetch(quint64 offset, quint64 length)
+{
+#ifdef POSIX_FADV_WILLNEED
+	// Offsets beyond a 32-bit off_t cannot be hinted; they are still read
+	if(quint64(off_t(offset + length)) != offset + length) return;
+	posix_fadvise(file.handle(), off_t(offset), off_t(length),
+				  POSIX_FADV_WILLNEED);
+#else
+	Q_UNUSED(offset);
+	Q_UNUSED(length);
+#endif
+}
@@ -0,0 +1,107 @@
+/*
+	Name        : Input.h
+	Author      : Charles N. Burns (charlesnburns|gmail|com / burnchar|isu|edu)
+	Date        : October 2026
+	License     : GPL3. See license.txt or www.gnu.org/licenses/gpl-3.0.txt
+	Requirements: Qt 4, data to parse, any spreadsheet program.
+	Notes       : Best viewed with tab width 4.
+	Description : Header file to define the MappedInput class.
+*/
+
+#ifndef INPUT_H
+#define INPUT_H
+
+#include <QObject>
+#include <QFile>
+#include <QString>
+#include <QElapsedTimer>
+#include <QByteArray>
+#include "Decompressor.h"
+#include "FrameIndex.h"
+
+//! Largest part of the input file mapped at once on 32-bit hosts
+const quint64 mappedWindowBytes32 = Q_UINT64_C(64) << 20;
+//! Most bytes the kernel is asked to read ahead by one sequential hint
+const quint64 maxReadAheadBytes = Q_UINT64_C(64) << 20;
+//! Throughput assumed until it is measured: a spinning disk, which reads
+//! 100 MB/s in sequence but only about 100 scattered rows per second
+const double defaultSequentialBytesPerSec = 100e6;
+const double defaultSparseRowsPerSec = 100;
+//! Shortest time over which throughput is measured
+const qint64 minMeasuredMs = 50;
+
+
+//! Read-only memory mapping of a data file. On 64-bit hosts the whole file is
+//! mapped once. On 32-bit hosts, where address space is scarce, a window of
+//! the file is mapped and moved forward as the file is read.
+//! adviseRows() tells the kernel which rows will be needed next, so they are
+//! read in large batches instead of one page fault at a time.
+//! A gzip or zstd file cannot be mapped. It is decompressed on its own thread
+//! instead, and map() hands out the decompressed bytes, which must then be
+//! asked for in order: no range may start before the previous one. Its
+//! length is not known until it has all been decompressed, so size() is the
+//! data decompressed so far, which fill() extends, and atEnd() tells once
+//! that is all of it. It is never decompressed only to be measured.
+//! A framed file, set up by setFraming(), is read as the rows of its good
+//! frames, one after another: size() and map() see only those rows, which
+//! map() copies out of their frames.
+class MappedInput
+{
+	QFile file;
+	uchar *window;
+	quint64 windowStart;
+	quint64 windowLength;
+	quint64 fileSize;
+
+	Decompressor::Compression compression;
+	Decompressor *stream;		// Of a compressed file, else 0
+	QByteArray streamBuffer;	// Decompressed bytes not yet passed by map()
+	quint64 streamStart;		// Position of streamBuffer in the data
+	bool streamEnded;			// Every block has been decompressed
+
+	FrameIndex *frames;			// Of a framed file, else 0
+	quint64 frameRowBytes;		// Bytes of the row in each frame
+	QByteArray frameBuffer;		// Rows last copied out of their frames
+
+	enum ReadPattern { NoPattern, Sequential, Sparse };
+	ReadPattern pattern;		// Of the rows last passed to adviseRows()
+	double patternWork;			// Bytes (Sequential) or rows (Sparse) since
+	QElapsedTimer patternClock;	// this clock was started
+	double sequentialRate;		// Bytes per second, measured
+	double sparseRate;			// Rows per second, measured
+
+	void unmapWindow();
+	bool openStream();
+	const uchar *mapStream(quint64 offset, quint64 length);
+	const uchar *mapFile(quint64 offset, quint64 length);
+	const uchar *mapFrames(quint64 offset, quint64 length);
+	quint64 fileWindowSize() const;
+	bool scanFrames();
+	void measurePattern();
+	void hintPattern(ReadPattern pattern);
+	void prefetch(quint64 offset, quint64 length);
+
+public:
+	QString errorMessage;
+	MappedInput();
+	~MappedInput();
+	bool open(const QString &fileURI);
+	void close();
+	bool refresh();
+	bool checkEnd();
+	bool fill(quint64 bytes);
+	bool atEnd() const;
+	quint64 size() const;
+	bool isCompressed() const { return stream != 0; }
+	bool setFraming(const FrameFormat &format, int rowBytes, bool bigEndian);
+	bool isFramed() const { return frames != 0; }
+	quint64 badFrameCount() const;
+	quint64 unframedBytes() const;
+	quint64 maxWindowSize() const;
+	const uchar *map(quint64 offset, quint64 length);
+	void adviseRows(quint64 offset, quint64 stride, quint64 count,
+					quint64 length);
+	QFile &device() { return file; }
+};
+
+#endif // INPUT_H
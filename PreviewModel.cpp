@@ -0,0 +1,376 @@
+/*
+	Name        : PreviewModel.cpp
+	Author      : Charles N. Burns (charlesnburns|gmail|com / burnchar|isu|edu)
+	Date        : October 2026
+	License     : GPL3. See license.txt or www.gnu.org/licenses/gpl-3.0.txt
+	Requirements: Qt 4, data to parse, any spreadsheet program.
+	Notes       : Best viewed with tab width 4.
+	Description : The PreviewModel class decodes a few hundred rows of the
+				  input file with the layout being edited, so a layout can be
+				  checked without converting the whole file.
+*/
+
+#include "PreviewModel.h"
+#include "FrameIndex.h"
+#include <QFile>
+#include <QtAlgorithms>
+#include <algorithm>
+#include <cstring>
+
+//! @returns Whether two requests need the same rows read. Byte order
+//! matters only to the checksums of frames; unframed rows are kept raw.
+static bool sameRequest(const PreviewRequest &a, const PreviewRequest &b)
+{
+	return a.path == b.path && a.fileSize == b.fileSize &&
+			a.rowSize == b.rowSize && a.framing.sync == b.framing.sync &&
+			a.framing.lengthByte == b.framing.lengthByte &&
+			a.framing.checksum == b.framing.checksum &&
+			(!a.framing.isFramed() || a.bigEndian == b.bigEndian);
+}
+
+
+//! Keeps the rows of the first frames of a framed file.
+//! @param start The first bytes of the file
+//! @param atEnd True if they are the whole file
+static void takeFrames(PreviewSample &sample, const QByteArray &start,
+					   bool atEnd)
+{
+	const PreviewRequest &request = sample.request;
+	FrameIndex frames;
+	if(!frames.setup(request.framing, request.rowSize, request.bigEndian)) {
+		sample.errorMessage = frames.errorMessage;
+		return;
+	}
+	const uchar *data = reinterpret_cast<const uchar*>(start.constData());
+	frames.scan(data, 0, start.size(), atEnd);
+	quint64 count = qMin(frames.rowCount(), quint64(previewHeadRows));
+	sample.bytes.resize(int(count * request.rowSize));
+	for(quint64 row = 0; row < count; ++row) {
+		quint64 following;
+		quint64 offset = frames.rowOffset(row, following);
+		memcpy(sample.bytes.data() + row * request.rowSize, data + offset,
+			   request.rowSize);
+		sample.rowNumbers.append(row);
+	}
+}
+
+
+//! Keeps the first rows of a file, or of its frames.
+//! @param start The first bytes of the file
+//! @param atEnd True if they are the whole file
+static void takeStart(PreviewSample &sample, const QByteArray &start,
+					  bool atEnd)
+{
+	if(sample.request.framing.isFramed()) {
+		takeFrames(sample, start, atEnd);
+		return;
+	}
+	int rowSize = sample.request.rowSize;
+	int count = qMin(start.size() / rowSize, previewHeadRows);
+	sample.bytes = start.left(count * rowSize);
+	for(int row = 0; row < count; ++row) sample.rowNumbers.append(row);
+}
+
+
+//! @returns The bytes needed to find the rows of the first previewHeadRows
+//!			 frames, with room for bad frames among them
+static qint64 startBytes(const PreviewRequest &request)
+{
+	qint64 frameBytes = request.rowSize;
+	if(request.framing.isFramed()) {
+		frameBytes += request.framing.headerBytes() +
+				request.framing.checksumBytes();
+		return 2 * previewHeadRows * frameBytes + 65536;
+	}
+	return previewHeadRows * frameBytes;
+}
+
+
+//! Reads the start of a compressed file, decompressing no more than that.
+static void readCompressed(PreviewSample &sample,
+						   Decompressor::Compression compression)
+{
+	QString name = Decompressor::compressionName(compression);
+	if(sample.request.framing.isFramed()) {
+		sample.errorMessage = QObject::tr("A compressed data file cannot be "
+										  "framed.");
+		return;
+	}
+	if(!Decompressor::isSupported(compression)) {
+		sample.errorMessage = QObject::tr("This build cannot read %1 "
+										  "compressed data files.").arg(name);
+		return;
+	}
+	Decompressor stream;	// Stops its thread when it goes out of scope
+	QByteArray start, block;
+	qint64 wanted = startBytes(sample.request);
+	bool more = stream.begin(sample.request.path, compression);
+	while(more && start.size() < wanted && (more = stream.next(block)))
+		start.append(block);
+	if(!stream.errorMessage.isEmpty())
+		sample.errorMessage = stream.errorMessage;
+	else takeStart(sample, start.left(int(wanted)), !more);
+}
+
+
+//! Reads the first and last rows of an uncompressed file, and a sample of
+//! the rows between them. The sample is drawn from a fixed seed, so it is
+//! the same for the same number of rows.
+static void readRows(PreviewSample &sample, QFile &file)
+{
+	quint64 rowSize = sample.request.rowSize;
+	quint64 rows = quint64(file.size()) / rowSize;
+	sample.fileRows = rows;
+	int edgeRows = previewHeadRows + previewTailRows;
+	if(rows <= quint64(edgeRows + previewSampleRows)) { // Read every row
+		sample.bytes = file.read(qint64(rows * rowSize));
+		for(quint64 row = 0; row < rows; ++row) sample.rowNumbers.append(row);
+		return;
+	}
+
+	QVector<quint64> picked;
+	quint64 range = rows - edgeRows;
+	quint64 state = Q_UINT64_C(0x9e3779b97f4a7c15);
+	for(int count = 0; count < previewSampleRows; ++count) {
+		state = state * Q_UINT64_C(6364136223846793005) +
+				Q_UINT64_C(1442695040888963407);
+		picked.append(previewHeadRows + (state >> 11) % range);
+	}
+	qSort(picked);
+	picked.erase(std::unique(picked.begin(), picked.end()), picked.end());
+
+	sample.bytes = file.read(previewHeadRows * rowSize);
+	for(int row = 0; row < previewHeadRows; ++row)
+		sample.rowNumbers.append(row);
+	for(int index = 0; index < picked.size(); ++index) {
+		file.seek(qint64(picked.at(index) * rowSize));
+		sample.bytes.append(file.read(qint64(rowSize)));
+		sample.rowNumbers.append(picked.at(index));
+	}
+	file.seek(qint64((rows - previewTailRows) * rowSize));
+	sample.bytes.append(file.read(qint64(previewTailRows * rowSize)));
+	for(quint64 row = rows - previewTailRows; row < rows; ++row)
+		sample.rowNumbers.append(row);
+}
+
+
+//! Reads the rows a preview needs. Runs on a worker thread.
+static PreviewSample readSample(const PreviewRequest &request)
+{
+	PreviewSample sample;
+	sample.request = request;
+	sample.fileRows = 0;
+	if(request.rowSize < 1) return sample;
+	Decompressor::Compression compression =
+			Decompressor::compressionOf(request.path);
+	QFile file(request.path);
+	if(compression != Decompressor::Uncompressed)
+		readCompressed(sample, compression);
+	else if(!file.open(QIODevice::ReadOnly)) {
+		sample.errorMessage = QObject::tr("Cannot open data file for "
+										  "reading.");
+	}
+	else if(request.framing.isFramed()) {
+		qint64 wanted = startBytes(request);
+		takeStart(sample, file.read(wanted), wanted >= file.size());
+	}
+	else readRows(sample, file);
+
+	// A read error, or a file which shrank meanwhile, leaves rows short
+	int rowSize = request.rowSize;
+	if(sample.bytes.size() != sample.rowNumbers.size() * rowSize) {
+		int count = qMin(sample.bytes.size() / rowSize,
+						 sample.rowNumbers.size());
+		sample.bytes.resize(count * rowSize);
+		sample.rowNumbers.resize(count);
+	}
+	return sample;
+}
+
+
+//! Constructor for PreviewModel class. Nothing is shown until update().
+PreviewModel::PreviewModel(QObject *parent) : QAbstractTableModel(parent)
+{
+	this->wanted.fileSize = 0;
+	this->wanted.rowSize = 0;
+	this->wanted.bigEndian = false;
+	this->rereadWanted = false;
+	this->valid = false;
+	this->columns = 0;
+	this->rows = 0;
+	connect(&pending, SIGNAL(finished()), this, SLOT(readFinished()));
+}
+
+
+//! Shows the rows of a file under a layout. If the rows already read are
+//! the ones needed, they are decoded again at once; otherwise the rows
+//! shown stay until the new ones are read.
+//! @param settings The file and its layout, as for a Converter
+//! @param fileSize Size of the file as last seen, so rows are read again
+//!		   when it changes
+void PreviewModel::update(const ConvertSettings &settings, quint64 fileSize)
+{
+	bool hostBigEndian = (QSysInfo::ByteOrder == QSysInfo::BigEndian);
+	PreviewRequest request;
+	request.path = settings.infilePath.trimmed();
+	request.fileSize = fileSize;
+	request.rowSize = settings.rowDataSize();
+	request.framing = settings.framing;
+	request.bigEndian = (settings.byteSwap != hostBigEndian);
+
+	this->settings = settings;
+	this->settings.colExport.clear();	// Every column is shown
+	if(!sameRequest(request, wanted)) {
+		wanted = request;
+		if(pending.isRunning()) rereadWanted = true;
+		else startRead();
+	}
+	if(valid && sameRequest(sample.request, wanted)) decode();
+}
+
+
+//! Reads the wanted rows on the global thread pool.
+void PreviewModel::startRead()
+{
+	rereadWanted = false;
+	pending.setFuture(QtConcurrent::run(readSample, wanted));
+}
+
+
+//! Keeps the rows read, if they are the wanted ones, and decodes them.
+//! Starts the next read if the file or row size changed meanwhile.
+void PreviewModel::readFinished()
+{
+	PreviewSample result = pending.result();
+	bool stale = !sameRequest(result.request, wanted);
+	if(stale || rereadWanted) startRead();
+	if(stale) return;
+	sample = result;
+	valid = true;
+	decode();
+}
+
+
+//! Decodes the rows read with the current layout, and shows them.
+void PreviewModel::decode()
+{
+	int newColumns = 0;
+	int newRows = 0;
+	QVector<quint64> newRaw;
+	QVector<double> newReal;
+	layoutError.clear();
+	if(settings.rowDataSize() < 1)
+		layoutError = tr("No data columns have been defined.");
+	else if(settings.badTypeColumn() >= 0) {
+		int col = settings.badTypeColumn();
+		layoutError = tr("Column %1 is a float of %2 bytes. Floats must "
+						 "have 2, 4 or 8 bytes.").arg(col + 1)
+				.arg(settings.colBytes.at(col));
+	}
+	else {
+		plan.compile(settings);
+		newColumns = plan.columnCount();
+		newRows = sample.rowNumbers.size();
+		newRaw.resize(newColumns * newRows);
+		newReal.resize(newColumns * newRows);
+		DecodedBlock block;
+		block.resize(newColumns);
+		const uchar *data = reinterpret_cast<const uchar*>(
+				sample.bytes.constData());
+		for(int first = 0; first < newRows; first += decodeBlockRows) {
+			int count = qMin(decodeBlockRows, newRows - first);
+			plan.decode(data + first * plan.rowSize, plan.rowSize, count,
+						block);
+			for(int col = 0; col < newColumns; ++col) {
+				memcpy(newRaw.data() + col * newRows + first,
+					   block.rawColumn(col), count * sizeof(quint64));
+				memcpy(newReal.data() + col * newRows + first,
+					   block.realColumn(col), count * sizeof(double));
+			}
+		}
+	}
+	formatter.setPrecision(settings.precision);
+
+	// Keep the view's scroll position unless the table changed shape
+	bool reshaped = (newColumns != columns || newRows != rows);
+	if(reshaped) beginResetModel();
+	columns = newColumns;
+	rows = newRows;
+	raw = newRaw;
+	real = newReal;
+	if(reshaped) endResetModel();
+	else if(rows > 0 && columns > 0) {
+		emit dataChanged(index(0, 0), index(rows - 1, columns - 1));
+		emit headerDataChanged(Qt::Horizontal, 0, columns - 1);
+		emit headerDataChanged(Qt::Vertical, 0, rows - 1);
+	}
+	emit changed();
+}
+
+
+//! @returns One line telling which rows are shown, or why none are
+QString PreviewModel::summary() const
+{
+	if(!layoutError.isEmpty()) return layoutError;
+	if(!valid) return tr("Reading rows...");
+	if(!sample.errorMessage.isEmpty()) return sample.errorMessage;
+	if(rows < 1) return tr("No rows to show.");
+	if(sample.fileRows == 0) return tr("The first %1 rows.").arg(rows);
+	if(quint64(rows) == sample.fileRows) return tr("All %1 rows.").arg(rows);
+	return tr("The first %1, %2 sampled and the last %3 of %4 rows.")
+			.arg(previewHeadRows).arg(rows - previewHeadRows - previewTailRows)
+			.arg(previewTailRows).arg(sample.fileRows);
+}
+
+
+//! @returns The number of rows shown
+int PreviewModel::rowCount(const QModelIndex &parent) const
+{
+	return parent.isValid() ? 0 : rows;
+}
+
+
+//! @returns The number of columns shown: every column of the layout
+int PreviewModel::columnCount(const QModelIndex &parent) const
+{
+	return parent.isValid() ? 0 : columns;
+}
+
+
+//! @returns A value formatted as the converter writes it
+QVariant PreviewModel::data(const QModelIndex &index, int role) const
+{
+	if(!index.isValid() || index.row() >= rows || index.column() >= columns)
+		return QVariant();
+	if(role == Qt::TextAlignmentRole)
+		return int(Qt::AlignRight | Qt::AlignVCenter);
+	if(role != Qt::DisplayRole) return QVariant();
+	const PlanColumn &column = plan.columns.at(index.column());
+	int cell = index.column() * rows + index.row();
+	formatter.clear();
+	formatter.reserve(maxValueTextBytes);
+	if(column.kind == PlanColumn::Voltage)
+		formatter.appendDouble(real.at(cell));
+	else if(column.type == PlanColumn::Signed)
+		formatter.appendInt(qint64(raw.at(cell)));
+	else formatter.appendUInt(raw.at(cell));
+	return QString::fromLatin1(formatter.data(), formatter.size());
+}
+
+
+//! @returns The names of the columns, and the numbers of the rows in the
+//!			 file, counting from 1
+QVariant PreviewModel::headerData(int section, Qt::Orientation orientation,
+								  int role) const
+{
+	if(role != Qt::DisplayRole) return QVariant();
+	if(orientation == Qt::Vertical) {
+		if(section >= sample.rowNumbers.size()) return QVariant();
+		return QString::number(sample.rowNumbers.at(section) + 1);
+	}
+	if(section >= columns) return QVariant();
+	int input = plan.columns.at(section).index;
+	QString name = settings.colNames.value(input).trimmed();
+	if(name.isEmpty()) name = tr("Column %1").arg(input + 1);
+	return name;
+}
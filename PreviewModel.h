@@ -0,0 +1,100 @@
+/*
+	Name        : PreviewModel.h
+	Author      : Charles N. Burns (charlesnburns|gmail|com / burnchar|isu|edu)
+	Date        : October 2026
+	License     : GPL3. See license.txt or www.gnu.org/licenses/gpl-3.0.txt
+	Requirements: Qt 4, data to parse, any spreadsheet program.
+	Notes       : Best viewed with tab width 4.
+	Description : Header file to define the PreviewModel class.
+*/
+
+#ifndef PREVIEWMODEL_H
+#define PREVIEWMODEL_H
+
+#include <QAbstractTableModel>
+#include <QFutureWatcher>
+#include <QtConcurrentRun>
+#include <QVector>
+#include <QStringList>
+#include "Converter.h"
+
+//! Rows of the input file shown by the preview: from its start, spread
+//! through it, and from its end
+const int previewHeadRows = 200;
+const int previewSampleRows = 200;
+const int previewTailRows = 200;
+
+
+//! Which rows of which file a preview needs. Only these decide what is
+//! read; the rest of the layout only changes how the rows are decoded.
+struct PreviewRequest
+{
+	QString path;
+	quint64 fileSize;	// As last seen, so a change to the file rereads it
+	int rowSize;
+	FrameFormat framing;
+	bool bigEndian;		// Byte order of a frame's checksum
+};
+
+
+//! The bytes of the rows of a preview, read on a worker thread.
+struct PreviewSample
+{
+	PreviewRequest request;
+	QVector<quint64> rowNumbers;	// Of each row in the file, ascending
+	QByteArray bytes;				// The rows, one after another
+	quint64 fileRows;	// Whole rows in the file, or 0 if only its start
+	QString errorMessage;			// was read, or it cannot be read
+};
+
+
+//! The first and last rows of the input file and a random sample of the
+//! rest, decoded with the layout shown in the window, as a table. Rows are
+//! read on the global thread pool only when the file or the row size
+//! changes; a change to the byte order, a voltage or a column's type only
+//! decodes the few hundred rows already read again, at once. Cells are
+//! formatted as the converter writes them, only when they are shown.
+//! The sample is the same each time for the same file and row size.
+//! A compressed or framed file is previewed from its start only, as its
+//! other rows cannot be found without reading all of it.
+class PreviewModel : public QAbstractTableModel
+{
+	Q_OBJECT
+
+	PreviewRequest wanted;
+	bool rereadWanted;		// Read again when the running read finishes
+	QFutureWatcher<PreviewSample> pending;
+	PreviewSample sample;	// Last rows read, if valid
+	bool valid;
+
+	ConvertSettings settings;	// Of the decoded values
+	DecodePlan plan;
+	QVector<quint64> raw;	// Decoded values, column after column
+	QVector<double> real;
+	mutable CsvFormatter formatter;	// Of the cells being shown
+	int columns;			// Decoded columns; 0 if the layout is invalid
+	int rows;
+	QString layoutError;	// Why nothing was decoded, if so
+
+	void startRead();
+	void decode();
+
+private slots:
+	void readFinished();
+
+public:
+	explicit PreviewModel(QObject *parent = 0);
+	void update(const ConvertSettings &settings, quint64 fileSize);
+	QString summary() const;
+
+	int rowCount(const QModelIndex &parent = QModelIndex()) const;
+	int columnCount(const QModelIndex &parent = QModelIndex()) const;
+	QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const;
+	QVariant headerData(int section, Qt::Orientation orientation,
+						int role = Qt::DisplayRole) const;
+
+signals:
+	void changed();
+};
+
+#endif // PREVIEWMODEL_H
@@ -0,0 +1,902 @@
+/*
+	Name        : RowFilter.cpp
+	Author      : Charles N. Burns (charlesnburns|gmail|com / burnchar|isu|edu)
+	Date        : October 2026
+	License     : GPL3. See license.txt or www.gnu.org/licenses/gpl-3.0.txt
+	Requirements: Qt 4, data to parse, any spreadsheet program.
+	Notes       : Best viewed with tab width 4.
+	Description : The RowFilter class keeps only the rows of interest, such as
+				  those where a channel crosses a threshold, so the rest are
+				  never formatted or written.
+*/
+
+#include "RowFilter.h"
+#include <QObject>
+#include <cmath>
+
+//! Largest magnitude of a number which is used in integer arithmetic
+static const double maxWholeNumber = 9.2e18;
+
+
+//! Constructor for RowFilter class. The filter keeps every row until an
+//! expression is parsed.
+RowFilter::RowFilter()
+{
+	this->position = 0;
+	this->root = -1;
+}
+
+
+//! Parses an expression. An empty expression keeps every row.
+//! @param text The expression
+//! @param names The name of each input column
+//! @returns false if the expression is not valid, true otherwise
+bool RowFilter::parse(const QString &text, const QStringList &names)
+{
+	this->text = text;
+	this->names = names;
+	position = 0;
+	nodes.clear();
+	code.clear();
+	root = -1;
+	bool retval = true;
+	if(!text.trimmed().isEmpty()) {
+		root = parseOr();
+		skipSpace();
+		if(root >= 0 && position < text.size()) {
+			fail(QObject::tr("Row filter: unexpected \"%1\" at character %2.")
+				 .arg(text.at(position)).arg(position + 1));
+			root = -1;
+		}
+		retval = (root >= 0);
+	}
+	return retval;
+}
+
+
+//! Type-checks the parsed expression against the job's columns, and
+//! compiles it. Every column it names must be in the plan.
+//! @returns false if the expression cannot be evaluated, true otherwise
+bool RowFilter::compile(const DecodePlan &plan)
+{
+	bool retval = true;
+	code.clear();
+	if(root >= 0) {
+		int maxDepth = 0;
+		retval = check(root, plan);
+		if(retval && nodes.at(root).type != Boolean) {
+			retval = fail(QObject::tr("Row filter: the expression must be a "
+									  "comparison, such as ch3 > 2.5."));
+		}
+		if(retval) retval = generate(root, 0, maxDepth);
+		if(!retval) root = -1;
+	}
+	return retval;
+}
+
+
+//! @returns The input columns the expression names, which must be decoded
+QList<int> RowFilter::columns() const
+{
+	QList<int> retval;
+	for(int index = 0; index < nodes.size(); ++index) {
+		const Node &node = nodes.at(index);
+		if(node.kind == ColumnNode && !retval.contains(node.column))
+			retval.append(node.column);
+	}
+	return retval;
+}
+
+
+//! Runs the filter on a decoded block, and moves the rows it keeps to the
+//! front of each column.
+//! @param block Decoded rows, with every column of the plan
+//! @returns The number of rows dropped
+int RowFilter::apply(DecodedBlock &block) const
+{
+	if(root < 0) return 0;
+	qint64 stack[maxFilterDepth][decodeBlockRows];
+	int rows = block.rows;
+	int top = -1;
+	for(int index = 0; index < code.size(); ++index) {
+		const Instruction &in = code.at(index);
+		if(in.op == PushColumn) {
+			const quint64 *raw = block.rawColumn(in.column);
+			qint64 *out = stack[++top];
+			for(int row = 0; row < rows; ++row) out[row] = qint64(raw[row]);
+			continue;
+		}
+		if(in.op == PushConstant) {
+			qint64 *out = stack[++top];
+			for(int row = 0; row < rows; ++row) out[row] = in.value;
+			continue;
+		}
+		if(in.op == TestRange) {
+			const quint64 *raw = block.rawColumn(in.column);
+			qint64 *out = stack[++top];
+			for(int row = 0; row < rows; ++row) {
+				quint64 key = raw[row] ^ in.flip;
+				out[row] = (key >= in.low && key <= in.high) != (in.value != 0);
+			}
+			continue;
+		}
+		if(in.op == TestValueRange) {
+			const double *real = block.realColumn(in.column);
+			qint64 *out = stack[++top];
+			for(int row = 0; row < rows; ++row)
+				out[row] = (real[row] >= in.lowValue &&
+							real[row] <= in.highValue) != (in.value != 0);
+			continue;
+		}
+		qint64 *a = stack[top];
+		if(in.op == Negate) { // Wraps like unsigned, as do + - and *
+			for(int row = 0; row < rows; ++row)
+				a[row] = qint64(0 - quint64(a[row]));
+			continue;
+		}
+		if(in.op == Not) {
+			for(int row = 0; row < rows; ++row) a[row] = !a[row];
+			continue;
+		}
+		const qint64 *b = stack[top--];
+		a = stack[top];
+		switch(in.op) {
+		case Add:
+			for(int row = 0; row < rows; ++row)
+				a[row] = qint64(quint64(a[row]) + quint64(b[row]));
+			break;
+		case Subtract:
+			for(int row = 0; row < rows; ++row)
+				a[row] = qint64(quint64(a[row]) - quint64(b[row]));
+			break;
+		case Multiply:
+			for(int row = 0; row < rows; ++row)
+				a[row] = qint64(quint64(a[row]) * quint64(b[row]));
+			break;
+		case Divide:	// x / 0 is 0, rather than a crash
+			for(int row = 0; row < rows; ++row) {
+				if(b[row] == 0) a[row] = 0;
+				else if(b[row] == -1) a[row] = qint64(0 - quint64(a[row]));
+				else a[row] /= b[row];
+			}
+			break;
+		case Modulo:	// x % 0 is 0
+			for(int row = 0; row < rows; ++row) {
+				if(b[row] == 0 || b[row] == -1) a[row] = 0;
+				else a[row] %= b[row];
+			}
+			break;
+		case Less:
+			for(int row = 0; row < rows; ++row) a[row] = a[row] < b[row];
+			break;
+		case LessEqual:
+			for(int row = 0; row < rows; ++row) a[row] = a[row] <= b[row];
+			break;
+		case Greater:
+			for(int row = 0; row < rows; ++row) a[row] = a[row] > b[row];
+			break;
+		case GreaterEqual:
+			for(int row = 0; row < rows; ++row) a[row] = a[row] >= b[row];
+			break;
+		case Equal:
+			for(int row = 0; row < rows; ++row) a[row] = a[row] == b[row];
+			break;
+		case NotEqual:
+			for(int row = 0; row < rows; ++row) a[row] = a[row] != b[row];
+			break;
+		case And:
+			for(int row = 0; row < rows; ++row) a[row] = a[row] & b[row];
+			break;
+		case Or:
+			for(int row = 0; row < rows; ++row) a[row] = a[row] | b[row];
+			break;
+		default:
+			break;
+		}
+	}
+
+	// Gather the kept rows of each column
+	const qint64 *keep = stack[0];
+	int kept = 0;
+	int picked[decodeBlockRows];
+	for(int row = 0; row < rows; ++row) if(keep[row]) picked[kept++] = row;
+	if(kept < rows) {
+		int columns = block.raw.size() / decodeBlockRows;
+		for(int col = 0; col < columns; ++col) {
+			quint64 *raw = block.rawColumn(col);
+			double *real = block.realColumn(col);
+			for(int row = 0; row < kept; ++row) {
+				raw[row] = raw[picked[row]];
+				real[row] = real[picked[row]];
+			}
+		}
+		block.rows = kept;
+	}
+	return rows - kept;
+}
+
+
+//! Skips spaces in the expression.
+void RowFilter::skipSpace()
+{
+	while(position < text.size() && text.at(position).isSpace()) ++position;
+}
+
+
+//! Takes a token from the expression, if it is next.
+//! @returns true if the token was taken
+bool RowFilter::take(const char *token)
+{
+	skipSpace();
+	int length = int(qstrlen(token));
+	bool retval = (text.mid(position, length) == QLatin1String(token));
+	if(retval) position += length;
+	return retval;
+}
+
+
+//! Adds a node to the parsed expression.
+//! @returns Its index, or -1 if an operand failed to parse
+int RowFilter::addNode(NodeKind kind, OpCode op, int left, int right)
+{
+	if((kind == UnaryNode || kind == BinaryNode) && left < 0) return -1;
+	if(kind == BinaryNode && right < 0) return -1;
+	Node node;
+	node.kind = kind;
+	node.type = Constant;
+	node.op = op;
+	node.number = 0;
+	node.exact = false;
+	node.negative = false;
+	node.magnitude = 0;
+	node.column = -1;
+	node.source = -1;
+	node.left = left;
+	node.right = right;
+	node.flip = 0;
+	node.low = 0;
+	node.high = 0;
+	node.lowValue = 0;
+	node.highValue = 0;
+	node.negate = false;
+	nodes.append(node);
+	return nodes.size() - 1;
+}
+
+
+//! Parses operands joined by ||.
+//! @returns The node, or -1 on an error
+int RowFilter::parseOr()
+{
+	int left = parseAnd();
+	while(left >= 0 && take("||")) left = addNode(BinaryNode, Or, left,
+												  parseAnd());
+	return left;
+}
+
+
+//! Parses operands joined by &&.
+//! @returns The node, or -1 on an error
+int RowFilter::parseAnd()
+{
+	int left = parseComparison();
+	while(left >= 0 && take("&&")) left = addNode(BinaryNode, And, left,
+												  parseComparison());
+	return left;
+}
+
+
+//! Parses a sum, or one comparison of two sums.
+//! @returns The node, or -1 on an error
+int RowFilter::parseComparison()
+{
+	int left = parseSum();
+	if(left < 0) return -1;
+	OpCode op;
+	if(take("<=")) op = LessEqual;
+	else if(take(">=")) op = GreaterEqual;
+	else if(take("==")) op = Equal;
+	else if(take("!=")) op = NotEqual;
+	else if(take("<")) op = Less;
+	else if(take(">")) op = Greater;
+	else return left;
+	return addNode(BinaryNode, op, left, parseSum());
+}
+
+
+//! Parses terms joined by + and -.
+//! @returns The node, or -1 on an error
+int RowFilter::parseSum()
+{
+	int left = parseProduct();
+	while(left >= 0) {
+		OpCode op;
+		if(take("+")) op = Add;
+		else if(take("-")) op = Subtract;
+		else break;
+		left = addNode(BinaryNode, op, left, parseProduct());
+	}
+	return left;
+}
+
+
+//! Parses factors joined by *, / and %.
+//! @returns The node, or -1 on an error
+int RowFilter::parseProduct()
+{
+	int left = parseUnary();
+	while(left >= 0) {
+		OpCode op;
+		if(take("*")) op = Multiply;
+		else if(take("/")) op = Divide;
+		else if(take("%")) op = Modulo;
+		else break;
+		left = addNode(BinaryNode, op, left, parseUnary());
+	}
+	return left;
+}
+
+
+//! Parses a value, which may be negated with - or inverted with !.
+//! @returns The node, or -1 on an error
+int RowFilter::parseUnary()
+{
+	if(take("-")) return addNode(UnaryNode, Negate, parseUnary(), -1);
+	if(take("!")) return addNode(UnaryNode, Not, parseUnary(), -1);
+	return parsePrimary();
+}
+
+
+//! Parses a number, a column, or an expression in parentheses.
+//! @returns The node, or -1 on an error
+int RowFilter::parsePrimary()
+{
+	skipSpace();
+	if(position >= text.size()) {
+		fail(QObject::tr("Row filter: the expression ends too soon."));
+		return -1;
+	}
+	if(take("(")) {
+		int inner = parseOr();
+		if(inner >= 0 && !take(")")) {
+			fail(QObject::tr("Row filter: a \")\" is missing."));
+			inner = -1;
+		}
+		return inner;
+	}
+
+	QChar c = text.at(position);
+	int start = position;
+	int column = -1;
+	if(c.isDigit() || c == '.') {
+		while(position < text.size() &&
+			  (text.at(position).isDigit() || text.at(position) == '.'))
+			++position;
+		if(position < text.size() && text.at(position).toLower() == 'e') {
+			int exponent = position + 1;
+			if(exponent < text.size() && (text.at(exponent) == '+' ||
+										  text.at(exponent) == '-'))
+				++exponent;
+			if(exponent < text.size() && text.at(exponent).isDigit()) {
+				position = exponent;
+				while(position < text.size() && text.at(position).isDigit())
+					++position;
+			}
+		}
+		QString literal = text.mid(start, position - start);
+		bool ok;
+		double number = literal.toDouble(&ok);
+		if(!ok) {
+			fail(QObject::tr("Row filter: \"%1\" is not a number.")
+				 .arg(literal));
+			return -1;
+		}
+		int node = addNode(NumberNode, PushConstant, -1, -1);
+		nodes[node].number = number;
+		nodes[node].magnitude = literal.toULongLong(&ok);
+		nodes[node].exact = ok;	// Only if written as a whole number
+		return node;
+	}
+	if(c == '$') { // Column number
+		++position;
+		while(position < text.size() && text.at(position).isDigit())
+			++position;
+		column = text.mid(start + 1, position - start - 1).toInt() - 1;
+		if(column < 0 || column >= names.size()) {
+			fail(QObject::tr("Row filter: there is no column %1.")
+				 .arg(text.mid(start, position - start)));
+			return -1;
+		}
+	}
+	else if(c == '[') { // Column name with spaces
+		int end = text.indexOf(']', position);
+		if(end < 0) {
+			fail(QObject::tr("Row filter: a \"]\" is missing."));
+			return -1;
+		}
+		position = end + 1;
+		column = findColumn(text.mid(start + 1, end - start - 1).trimmed());
+	}
+	else if(c.isLetter() || c == '_') {
+		while(position < text.size() && (text.at(position).isLetterOrNumber()
+										 || text.at(position) == '_'))
+			++position;
+		column = findColumn(text.mid(start, position - start));
+	}
+	else {
+		fail(QObject::tr("Row filter: unexpected \"%1\" at character %2.")
+			 .arg(c).arg(position + 1));
+		return -1;
+	}
+	if(column < 0) return -1;
+	int node = addNode(ColumnNode, PushColumn, -1, -1);
+	nodes[node].column = column;
+	return node;
+}
+
+
+//! Finds a column by name, ignoring case if no name matches exactly.
+//! @returns The input column, or -1 if no column or several have the name
+int RowFilter::findColumn(const QString &name)
+{
+	QList<int> found;
+	for(int col = 0; col < names.size(); ++col)
+		if(names.at(col).trimmed() == name) found.append(col);
+	if(found.isEmpty()) {
+		for(int col = 0; col < names.size(); ++col)
+			if(names.at(col).trimmed().compare(name, Qt::CaseInsensitive) == 0)
+				found.append(col);
+	}
+	if(found.size() == 1) return found.first();
+	if(found.isEmpty())
+		fail(QObject::tr("Row filter: there is no column named \"%1\".")
+			 .arg(name));
+	else fail(QObject::tr("Row filter: more than one column is named \"%1\"; "
+						  "use its number, such as $%2.")
+			  .arg(name).arg(found.first() + 1));
+	return -1;
+}
+
+
+//! Records why the expression cannot be used.
+//! @returns false
+bool RowFilter::fail(const QString &message)
+{
+	errorMessage = message;
+	return false;
+}
+
+
+//! Works out the type of a node and its operands. Arithmetic on numbers
+//! alone is done here, once, and a comparison of a column with a number
+//! becomes a range test.
+//! @returns false if the node cannot be evaluated
+bool RowFilter::check(int index, const DecodePlan &plan)
+{
+	Node node = nodes.at(index);
+	bool retval = true;
+	if(node.kind == NumberNode) {
+		node.type = Constant;
+	}
+	else if(node.kind == ColumnNode) {
+		for(int col = 0; col < plan.columnCount(); ++col)
+			if(plan.columns.at(col).index == node.column) node.source = col;
+		if(node.source < 0) return fail(QObject::tr("Row filter: column %1 "
+													"is not decoded.")
+										.arg(node.column + 1));
+		node.type = (plan.columns.at(node.source).kind == PlanColumn::Counter)
+				? Integer : Voltage;
+	}
+	else if(node.kind == UnaryNode) {
+		if(!check(node.left, plan)) return false;
+		NodeType type = nodes.at(node.left).type;
+		if(node.op == Not) {
+			if(type == Boolean) node.type = Boolean;
+			else retval = fail(QObject::tr("Row filter: ! must be followed "
+										   "by a comparison."));
+		}
+		else if(type == Constant) {
+			const Node &left = nodes.at(node.left);
+			node.kind = NumberNode;
+			node.number = -left.number;
+			node.exact = left.exact;
+			node.magnitude = left.magnitude;
+			node.negative = !left.negative && left.magnitude != 0;
+			node.type = Constant;
+		}
+		else if(type == Integer) node.type = Integer;
+		else retval = fail(QObject::tr("Row filter: only counters and numbers "
+									   "can be negated."));
+	}
+	else {
+		if(!check(node.left, plan) || !check(node.right, plan)) return false;
+		if(node.op >= Less && node.op <= NotEqual) {
+			retval = checkComparison(index, plan);
+			node = nodes.at(index);
+		}
+		else if(node.op == And || node.op == Or) {
+			if(nodes.at(node.left).type == Boolean &&
+			   nodes.at(node.right).type == Boolean) node.type = Boolean;
+			else retval = fail(QObject::tr("Row filter: && and || join "
+										   "comparisons."));
+		}
+		else retval = checkArithmetic(node);
+	}
+	if(retval) nodes[index] = node;
+	return retval;
+}
+
+
+//! Checks arithmetic, whose operands have been checked. Arithmetic on two
+//! numbers is done at once.
+//! @param node The node, which is updated
+//! @returns false if the arithmetic cannot be evaluated
+bool RowFilter::checkArithmetic(Node &node)
+{
+	const Node &left = nodes.at(node.left);
+	const Node &right = nodes.at(node.right);
+	for(int side = 0; side < 2; ++side) {
+		const Node &operand = side ? right : left;
+		if(operand.type == Voltage)
+			return fail(QObject::tr("Row filter: %1 is not a counter, so it "
+									"can only be compared with a number.")
+						.arg(names.value(operand.column)));
+		if(operand.type == Boolean)
+			return fail(QObject::tr("Row filter: a comparison cannot be used "
+									"as a number."));
+	}
+	bool retval = true;
+	if(left.type == Constant && right.type == Constant) {
+		double a = left.number, b = right.number;
+		if(b == 0 && (node.op == Divide || node.op == Modulo))
+			return fail(QObject::tr("Row filter: division by zero."));
+		node.kind = NumberNode;
+		node.type = Constant;
+		if(node.op == Add) node.number = a + b;
+		else if(node.op == Subtract) node.number = a - b;
+		else if(node.op == Multiply) node.number = a * b;
+		else if(node.op == Divide) node.number = a / b;
+		else node.number = fmod(a, b);
+	}
+	else {
+		if(left.type == Constant) retval = toWhole(node.left);
+		if(right.type == Constant) retval = toWhole(node.right);
+		node.type = Integer;
+	}
+	return retval;
+}
+
+
+//! Checks a comparison, whose operands have been checked. A column compared
+//! with a number becomes a range test of its raw value; a number compared
+//! with a counter expression is rounded to the whole number which gives
+//! the same result.
+//! @returns false if the comparison cannot be evaluated
+bool RowFilter::checkComparison(int index, const DecodePlan &plan)
+{
+	Node node = nodes.at(index);
+	NodeType leftType = nodes.at(node.left).type;
+	NodeType rightType = nodes.at(node.right).type;
+	if(leftType == Boolean || rightType == Boolean)
+		return fail(QObject::tr("Row filter: a comparison cannot be used as a "
+								"number."));
+	if(leftType == Constant && rightType != Constant) { // Number on the right
+		qSwap(node.left, node.right);
+		qSwap(leftType, rightType);
+		if(node.op == Less) node.op = Greater;
+		else if(node.op == Greater) node.op = Less;
+		else if(node.op == LessEqual) node.op = GreaterEqual;
+		else if(node.op == GreaterEqual) node.op = LessEqual;
+	}
+	const Node &left = nodes.at(node.left);
+	double number = nodes.at(node.right).number;
+	node.type = Boolean;
+
+	if(leftType == Constant) {
+		node.kind = NumberNode;
+		node.number = compare(left.number, node.op, number) ? 1 : 0;
+	}
+	else if(rightType == Constant && left.kind == ColumnNode) {
+		const PlanColumn &column = plan.columns.at(left.source);
+		OpCode op = (node.op == NotEqual) ? Equal : node.op;
+		node.kind = RangeNode;
+		node.source = left.source;
+		node.negate = (node.op == NotEqual);
+		if(column.type == PlanColumn::Float) {
+			node.op = TestValueRange;
+			valueRangeOf(op, number, node.lowValue, node.highValue);
+		}
+		else {
+			node.op = TestRange;
+			node.flip = flipOf(column);
+			if(column.kind == PlanColumn::Counter)
+				counterRangeOf(column, op, nodes.at(node.right), node.low,
+							   node.high);
+			else rangeOf(column, op, number, node.low, node.high);
+		}
+	}
+	else if(leftType == Voltage || rightType == Voltage) {
+		const Node &voltage = (leftType == Voltage) ? left :
+												nodes.at(node.right);
+		return fail(QObject::tr("Row filter: %1 is not a counter, so it can "
+								"only be compared with a number.")
+					.arg(names.value(voltage.column)));
+	}
+	else if(rightType == Constant) {
+		Node &constant = nodes[node.right];
+		bool whole = constant.exact || (number == floor(number));
+		if(!whole && (node.op == Equal || node.op == NotEqual)) {
+			node.kind = NumberNode;
+			node.number = (node.op == NotEqual) ? 1 : 0;
+		}
+		else {
+			if(!constant.exact) {
+				if(node.op == Greater || node.op == LessEqual)
+					constant.number = floor(number);
+				else constant.number = ceil(number);
+			}
+			if(!fitsWhole(constant))
+				return fail(QObject::tr("Row filter: %1 is too large.")
+							.arg(number));
+		}
+	}
+	nodes[index] = node;
+	return true;
+}
+
+
+//! Checks that a number used in counter arithmetic is a whole number.
+//! @returns false if it is not
+bool RowFilter::toWhole(int index)
+{
+	const Node &constant = nodes.at(index);
+	double number = constant.number;
+	if((!constant.exact && number != floor(number)) || !fitsWhole(constant))
+		return fail(QObject::tr("Row filter: %1 is not a whole number, which "
+								"arithmetic on counters needs.").arg(number));
+	return true;
+}
+
+
+//! Finds the raw values of a voltage column whose value compares true with a
+//! number, using the same scaling as the decoder. The value only ever rises,
+//! or only ever falls, with the key of the raw value, so they are one range
+//! of keys, found by a binary search for where the comparison changes.
+//! @param op Less, LessEqual, Greater, GreaterEqual or Equal
+//! @param low Receives the lowest key in the range
+//! @param high Receives the highest; less than low if the range is empty
+void RowFilter::rangeOf(const PlanColumn &column, OpCode op, double number,
+						quint64 &low, quint64 &high) const
+{
+	if(op == Equal) {
+		quint64 lowAbove, highAbove, lowBelow, highBelow;
+		rangeOf(column, GreaterEqual, number, lowAbove, highAbove);
+		rangeOf(column, LessEqual, number, lowBelow, highBelow);
+		low = qMax(lowAbove, lowBelow);
+		high = qMin(highAbove, highBelow);
+		if(lowAbove > highAbove || lowBelow > highBelow) {
+			low = 1;
+			high = 0;
+		}
+		return;
+	}
+	quint64 lowest = lowestKey(column);
+	quint64 highest = lowest + DecodePlan::maxRawValue(column.bytes);
+	bool first = compare(valueOf(column, lowest), op, number);
+	bool last = compare(valueOf(column, highest), op, number);
+	low = first ? lowest : 1;
+	high = first ? highest : 0;
+	if(first == last) return;
+
+	quint64 same = lowest, changed = highest;	// Around where it changes
+	while(changed - same > 1) {
+		quint64 middle = same + (changed - same) / 2;
+		if(compare(valueOf(column, middle), op, number) == first) same = middle;
+		else changed = middle;
+	}
+	if(first) high = same;
+	else {
+		low = changed;
+		high = highest;
+	}
+}
+
+
+//! Finds the raw values of a counter column which compare true with a
+//! number. They are compared as integers, so no counter is rounded, as one
+//! of 8 bytes would be as a double. A number which is not whole is first
+//! turned into the whole number which gives the same result.
+//! @param op Less, LessEqual, Greater, GreaterEqual or Equal
+//! @param constant The number
+//! @param low Receives the lowest key in the range
+//! @param high Receives the highest; less than low if the range is empty
+void RowFilter::counterRangeOf(const PlanColumn &column, OpCode op,
+							   const Node &constant, quint64 &low,
+							   quint64 &high) const
+{
+	const double wholeLimit = 18446744073709551616.0;	// 2 to the 64th
+	quint64 lowest = lowestKey(column);
+	quint64 highest = lowest + DecodePlan::maxRawValue(column.bytes);
+	bool negative = constant.negative;
+	quint64 magnitude = constant.magnitude;
+	int side = 0;	// Where the number is among the column's values
+	quint64 key = 0;
+	low = 1;		// Empty, unless found below
+	high = 0;
+	if(!constant.exact) {
+		double number = constant.number;
+		if(number != number) return;	// NaN equals and orders with nothing
+		if(number != floor(number)) {
+			if(op == Equal) return;
+			bool up = (op == Greater || op == GreaterEqual);
+			number = up ? ceil(number) : floor(number);
+			op = up ? GreaterEqual : LessEqual;
+		}
+		negative = (number < 0);
+		if(fabs(number) >= wholeLimit) side = negative ? -1 : 1;
+		else magnitude = quint64(fabs(number));
+	}
+	if(side == 0) side = keyOf(column, negative, magnitude, key);
+
+	if(op == Equal) {
+		if(side == 0) low = high = key;
+	}
+	else if(op == Greater || op == GreaterEqual) {
+		if(side < 0) {
+			low = lowest;
+			high = highest;
+		}
+		else if(side == 0 && !(op == Greater && key == highest)) {
+			low = (op == Greater) ? key + 1 : key;
+			high = highest;
+		}
+	}
+	else if(side > 0) {	// Less or LessEqual
+		low = lowest;
+		high = highest;
+	}
+	else if(side == 0 && !(op == Less && key == lowest)) {
+		low = lowest;
+		high = (op == Less) ? key - 1 : key;
+	}
+}
+
+
+//! Finds the values of a float column which compare true with a number.
+//! NaN is in no range, so it passes only a != test, as in IEEE 754.
+//! @param op Less, LessEqual, Greater, GreaterEqual or Equal
+//! @param low Receives the lowest value in the range
+//! @param high Receives the highest
+void RowFilter::valueRangeOf(OpCode op, double number, double &low,
+							 double &high) const
+{
+	const double infinity = HUGE_VAL;
+	low = -infinity;
+	high = infinity;
+	if(op == Less) high = nextafter(number, -infinity);
+	else if(op == LessEqual) high = number;
+	else if(op == Greater) low = nextafter(number, infinity);
+	else if(op == GreaterEqual) low = number;
+	else low = high = number;
+}
+
+
+//! Appends the program for a node and its operands.
+//! @param depth Values on the stack before the node is run
+//! @param maxDepth The deepest the stack gets; raised by this call
+//! @returns false if the stack would get too deep
+bool RowFilter::generate(int index, int depth, int &maxDepth)
+{
+	const Node &node = nodes.at(index);
+	Instruction in;
+	in.op = node.op;
+	in.column = node.source;
+	in.value = 0;
+	in.flip = node.flip;
+	in.low = node.low;
+	in.high = node.high;
+	in.lowValue = node.lowValue;
+	in.highValue = node.highValue;
+	if(depth + 1 > maxDepth) maxDepth = depth + 1;
+	if(maxDepth > maxFilterDepth)
+		return fail(QObject::tr("Row filter: the expression is nested too "
+								"deeply."));
+	bool retval = true;
+	if(node.kind == NumberNode) {
+		in.op = PushConstant;
+		in.value = wholeOf(node);
+	}
+	else if(node.kind == ColumnNode) in.op = PushColumn;
+	else if(node.kind == RangeNode) in.value = node.negate ? 1 : 0;
+	else if(node.kind == UnaryNode) retval = generate(node.left, depth,
+													  maxDepth);
+	else retval = generate(node.left, depth, maxDepth) &&
+			generate(node.right, depth + 1, maxDepth);
+	if(retval) code.append(in);
+	return retval;
+}
+
+
+//! @returns What to exclusive-or a column's raw values with, to make keys
+//!			 which sort as the values do. Flipping the top bit of a signed
+//!			 value, sign-extended, moves the negative values below the rest.
+quint64 RowFilter::flipOf(const PlanColumn &column)
+{
+	return (column.type == PlanColumn::Signed) ? Q_UINT64_C(1) << 63 : 0;
+}
+
+
+//! @returns The key of a column's lowest raw value. The keys of its other
+//!			 values follow it, up to maxRawValue() above it.
+quint64 RowFilter::lowestKey(const PlanColumn &column)
+{
+	if(column.type != PlanColumn::Signed) return 0;
+	return (Q_UINT64_C(1) << 63) - (Q_UINT64_C(1) << ((column.bytes << 3) - 1));
+}
+
+
+//! @returns The voltage the decoder gives the raw value with a key, scaled
+//!			 as the decoder does, before it is rounded to be written.
+//!			 A key's distance from the lowest key is the unsigned or offset
+//!			 binary value which the voltage kernels scale.
+double RowFilter::valueOf(const PlanColumn &column, quint64 key)
+{
+	return ((key - lowestKey(column)) / column.divisor) + column.vMin;
+}
+
+
+//! Finds the key of a counter column's raw value which equals a whole
+//! number, given by its sign and size.
+//! @param key Receives the key, if the column has the value
+//! @returns 0 if the column has the value, or -1 or 1 if the number is
+//!			 below or above all of its values
+int RowFilter::keyOf(const PlanColumn &column, bool negative,
+					 quint64 magnitude, quint64 &key)
+{
+	quint64 maximum = DecodePlan::maxRawValue(column.bytes);
+	if(column.type != PlanColumn::Signed) {
+		if(negative) return -1;
+		if(magnitude > maximum) return 1;
+		key = magnitude;
+		return 0;
+	}
+	quint64 half = maximum / 2 + 1;	// Size of the lowest value
+	if(negative && magnitude > half) return -1;
+	if(!negative && magnitude >= half) return 1;
+	key = (negative ? 0 - magnitude : magnitude) ^ flipOf(column);
+	return 0;
+}
+
+
+//! @returns Whether a whole number fits the 64-bit integer arithmetic
+bool RowFilter::fitsWhole(const Node &constant)
+{
+	const quint64 half = Q_UINT64_C(1) << 63;
+	if(!constant.exact) return fabs(constant.number) <= maxWholeNumber;
+	return constant.negative ? constant.magnitude <= half
+							 : constant.magnitude < half;
+}
+
+
+//! @returns A whole number as the 64-bit integer arithmetic holds it
+qint64 RowFilter::wholeOf(const Node &constant)
+{
+	if(!constant.exact) return qint64(constant.number);
+	return qint64(constant.negative ? 0 - constant.magnitude
+									: constant.magnitude);
+}
+
+
+//! @returns The result of comparing a value with a number
+bool RowFilter::compare(double value, OpCode op, double number)
+{
+	switch(op) {
+	case Less: return value < number;
+	case LessEqual: return value <= number;
+	case Greater: return value > number;
+	case GreaterEqual: return value >= number;
+	case Equal: return value == number;
+	case NotEqual: return value != number;
+	default: return false;
+	}
+}
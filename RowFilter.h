@@ -0,0 +1,138 @@
+/*
+	Name        : RowFilter.h
+	Author      : Charles N. Burns (charlesnburns|gmail|com / burnchar|isu|edu)
+	Date        : October 2026
+	License     : GPL3. See license.txt or www.gnu.org/licenses/gpl-3.0.txt
+	Requirements: Qt 4, data to parse, any spreadsheet program.
+	Notes       : Best viewed with tab width 4.
+	Description : Header file to define the RowFilter class.
+*/
+
+#ifndef ROWFILTER_H
+#define ROWFILTER_H
+
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QVector>
+#include "DecodePlan.h"
+
+//! Most values a row filter holds on its stack at once
+const int maxFilterDepth = 16;
+
+
+//! Keeps the rows for which an expression over the columns is true, such as
+//! "ch3 > 2.5 && seq % 10 == 0". The expression is parsed and type-checked
+//! once per job, and compiled to a short stack program which is run on a
+//! whole decoded block at a time, before any row is formatted.
+//! Columns are named as in the column list, in [brackets] if the name has
+//! spaces, or numbered as $1, $2, ... Counters and numbers may be combined
+//! with + - * / %, in 64-bit integer arithmetic. A counter compared with a
+//! number is compared as an integer, exactly; whole numbers written in the
+//! expression are read exactly, even beyond the 53 bits of a double.
+//! A voltage column may only be compared with a number in volts; the
+//! comparison is turned into a test of the raw value against the range of
+//! raw values whose unrounded voltage satisfies it, so no row is scaled to
+//! volts to be tested. That voltage may differ from the one written to the
+//! CSV file in its last printed digits. Float columns may likewise only be
+//! compared with a number, which tests their value against a range.
+//! Comparisons are combined with &&, || and !.
+class RowFilter
+{
+	enum OpCode {
+		PushColumn, PushConstant, TestRange, TestValueRange,
+		Add, Subtract, Multiply, Divide, Modulo, Negate,
+		Less, LessEqual, Greater, GreaterEqual, Equal, NotEqual,
+		And, Or, Not
+	};
+
+	//! One step of the compiled program
+	struct Instruction
+	{
+		OpCode op;
+		int column;		// Index into DecodePlan::columns
+		qint64 value;	// Constant pushed, or 1 to negate a range test
+		quint64 flip;	// Turns raw values into ordered keys; see flipOf()
+		quint64 low;	// Keys passing a range test, inclusive
+		quint64 high;
+		double lowValue;	// Values passing a value range test, inclusive
+		double highValue;
+	};
+
+	enum NodeKind { NumberNode, ColumnNode, RangeNode, UnaryNode, BinaryNode };
+	enum NodeType { Constant, Integer, Voltage, Boolean };
+
+	//! One node of the parsed expression
+	struct Node
+	{
+		NodeKind kind;
+		NodeType type;		// Set by check()
+		OpCode op;
+		double number;		// Value of a NumberNode
+		bool exact;			// It is the whole number below, exactly
+		bool negative;		// Sign of that whole number
+		quint64 magnitude;	// Its size, as a double cannot hold every counter
+		int column;			// Input column of a ColumnNode
+		int source;			// Its DecodePlan column, set by check()
+		int left;			// Operands, as indices into nodes
+		int right;
+		quint64 flip;		// Range of a RangeNode, as in Instruction
+		quint64 low;
+		quint64 high;
+		double lowValue;
+		double highValue;
+		bool negate;
+	};
+
+	QString text;
+	int position;
+	QStringList names;
+	QList<Node> nodes;
+	int root;
+	QVector<Instruction> code;
+
+	void skipSpace();
+	bool take(const char *token);
+	int addNode(NodeKind kind, OpCode op, int left, int right);
+	int parseOr();
+	int parseAnd();
+	int parseComparison();
+	int parseSum();
+	int parseProduct();
+	int parseUnary();
+	int parsePrimary();
+	int findColumn(const QString &name);
+	bool fail(const QString &message);
+	bool check(int node, const DecodePlan &plan);
+	bool checkArithmetic(Node &node);
+	bool checkComparison(int node, const DecodePlan &plan);
+	bool toWhole(int node);
+	void rangeOf(const PlanColumn &column, OpCode op, double number,
+				 quint64 &low, quint64 &high) const;
+	void counterRangeOf(const PlanColumn &column, OpCode op,
+						const Node &constant, quint64 &low,
+						quint64 &high) const;
+	void valueRangeOf(OpCode op, double number, double &low,
+					  double &high) const;
+	bool generate(int node, int depth, int &maxDepth);
+
+	static quint64 flipOf(const PlanColumn &column);
+	static quint64 lowestKey(const PlanColumn &column);
+	static double valueOf(const PlanColumn &column, quint64 key);
+	static int keyOf(const PlanColumn &column, bool negative,
+					 quint64 magnitude, quint64 &key);
+	static bool fitsWhole(const Node &constant);
+	static qint64 wholeOf(const Node &constant);
+	static bool compare(double value, OpCode op, double number);
+
+public:
+	QString errorMessage;
+	RowFilter();
+	bool parse(const QString &text, const QStringList &names);
+	bool compile(const DecodePlan &plan);
+	bool isActive() const { return root >= 0; }
+	QList<int> columns() const;
+	int apply(DecodedBlock &block) const;
+};
+
+#endif // ROWFILTER_H
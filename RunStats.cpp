@@ -0,0 +1,110 @@
+/*
+	Name        : RunStats.cpp
+	Author      : Charles N. Burns (charlesnburns|gmail|com / burnchar|isu|edu)
+	Date        : October 2026
+	License     : GPL3. See license.txt or www.gnu.org/licenses/gpl-3.0.txt
+	Requirements: Qt 4, data to parse, any spreadsheet program.
+	Notes       : Best viewed with tab width 4.
+	Description : The RunStats class reports where a conversion job spent its
+				  time, in the status bar or as a JSON file.
+*/
+
+#include "RunStats.h"
+#include <QFile>
+#include <QObject>
+
+//! Constructor for RunStats class. Every counter starts at zero.
+RunStats::RunStats()
+{
+	clear();
+}
+
+
+//! Sets every counter to zero.
+void RunStats::clear()
+{
+	this->bytesRead = 0;
+	this->rowsDecoded = 0;
+	this->rowsSkipped = 0;
+	this->rowsFiltered = 0;
+	this->rowsOutput = 0;
+	this->bytesWritten = 0;
+	this->framesBad = 0;
+	this->bytesUnframed = 0;
+	this->elapsedNs = 0;
+	this->scanNs = 0;
+	this->readNs = 0;
+	this->decodeNs = 0;
+	this->formatNs = 0;
+	this->compressNs = 0;
+	this->writeNs = 0;
+	this->stallNs = 0;
+	this->warning.clear();
+}
+
+
+//! @returns A one-line summary, short enough for the status bar
+QString RunStats::summary() const
+{
+	QString text = QObject::tr("%1 rows in %2 s. Read %3 MB, decode %4 s, "
+							   "format %5 s, ")
+			.arg(rowsOutput)
+			.arg(elapsedNs / 1e9, 0, 'f', 2)
+			.arg(bytesRead / 1e6, 0, 'f', 1)
+			.arg(decodeNs / 1e9, 0, 'f', 2)
+			.arg(formatNs / 1e9, 0, 'f', 2);
+	if(compressNs > 0) text += QObject::tr("compress %1 s, ")
+			.arg(compressNs / 1e9, 0, 'f', 2);
+	text += QObject::tr("write %1 s, stall %2 s, %3 rows skipped")
+			.arg(writeNs / 1e9, 0, 'f', 2)
+			.arg(stallNs / 1e9, 0, 'f', 2)
+			.arg(rowsSkipped);
+	if(rowsFiltered > 0) text += QObject::tr(", %1 filtered out")
+			.arg(rowsFiltered);
+	if(framesBad > 0) text += QObject::tr(", %1 bad frames").arg(framesBad);
+	text += ".";
+	if(!warning.isEmpty()) text += " " + warning;
+	return text;
+}
+
+
+//! @returns Every counter as one JSON object, times in seconds
+QByteArray RunStats::toJson() const
+{
+	QString json = QString("{\"elapsed_s\":%1,\"read_s\":%2,\"decode_s\":%3,"
+						   "\"format_s\":%4,\"compress_s\":%5,\"write_s\":%6,"
+						   "\"stall_s\":%7,\"scan_s\":%8,")
+			.arg(elapsedNs / 1e9, 0, 'g', 9)
+			.arg(readNs / 1e9, 0, 'g', 9)
+			.arg(decodeNs / 1e9, 0, 'g', 9)
+			.arg(formatNs / 1e9, 0, 'g', 9)
+			.arg(compressNs / 1e9, 0, 'g', 9)
+			.arg(writeNs / 1e9, 0, 'g', 9)
+			.arg(stallNs / 1e9, 0, 'g', 9)
+			.arg(scanNs / 1e9, 0, 'g', 9);
+	json += QString("\"bytes_read\":%1,\"rows_decoded\":%2,"
+					"\"rows_skipped\":%3,\"rows_filtered\":%4,"
+					"\"rows_output\":%5,\"bytes_written\":%6,"
+					"\"frames_bad\":%7,\"bytes_unframed\":%8")
+			.arg(bytesRead).arg(rowsDecoded).arg(rowsSkipped)
+			.arg(rowsFiltered).arg(rowsOutput).arg(bytesWritten)
+			.arg(framesBad).arg(bytesUnframed);
+	if(!warning.isEmpty()) {
+		QString text = warning;
+		text.replace('\\', "\\\\").replace('"', "\\\"");
+		json += ",\"warning\":\"" + text + "\"";
+	}
+	json += "}\n";
+	return json.toUtf8();
+}
+
+
+//! Writes the counters to a JSON file.
+//! @returns false on a write error
+bool RunStats::write(const QString &fileURI) const
+{
+	QFile file(fileURI);
+	QByteArray json = toJson();
+	return file.open(QIODevice::WriteOnly | QIODevice::Text) &&
+			file.write(json) == json.size();
+}
@@ -0,0 +1,49 @@
+/*
+	Name        : RunStats.h
+	Author      : Charles N. Burns (charlesnburns|gmail|com / burnchar|isu|edu)
+	Date        : October 2026
+	License     : GPL3. See license.txt or www.gnu.org/licenses/gpl-3.0.txt
+	Requirements: Qt 4, data to parse, any spreadsheet program.
+	Notes       : Best viewed with tab width 4.
+	Description : Header file to define the RunStats class.
+*/
+
+#ifndef RUNSTATS_H
+#define RUNSTATS_H
+
+#include <QString>
+#include <QByteArray>
+
+//! Per-stage counters of one conversion job, to tell whether a slow job is
+//! waiting on the disk, decoding, formatting or writing. Decode and format
+//! times are summed over the worker threads, so together they may exceed the
+//! elapsed time. Decode time includes page faults on the input mapping.
+class RunStats
+{
+public:
+	RunStats();
+	void clear();
+	QString summary() const;
+	QByteArray toJson() const;
+	bool write(const QString &fileURI) const;
+
+	quint64 bytesRead;		// Input bytes mapped for decoding
+	quint64 rowsDecoded;	// Input rows decoded
+	quint64 rowsSkipped;	// Input rows passed over by keeping 1 in N
+	quint64 rowsFiltered;	// Decoded rows dropped by the row filter
+	quint64 rowsOutput;		// Output rows, counting the column names
+	quint64 bytesWritten;	// Size of the output file
+	quint64 framesBad;		// Frames of a framed input which were bad
+	quint64 bytesUnframed;	// Input bytes outside good frames
+	qint64 elapsedNs;		// Whole job
+	qint64 scanNs;			// Finding the frames of a framed input
+	qint64 readNs;			// Mapping the input and hinting readahead
+	qint64 decodeNs;		// Decoding, decimating and column statistics
+	qint64 formatNs;		// Formatting CSV text or Arrow batches
+	qint64 compressNs;		// Compressing CSV text, on all threads
+	qint64 writeNs;			// Writing the output file
+	qint64 stallNs;			// Writer waiting for workers to format chunks
+	QString warning;		// A problem which did not fail the job, if any
+};
+
+#endif // RUNSTATS_H
@@ -19,9 +19,15 @@ Window::Window()
 	this->configFileURI = "config.xml";
 	this->maxComboItems = 10;
 	this->config = new Config();
+	this->infileStats = new FileStatsCache(this);
+	this->convertThread = 0;
+	this->batchThread = 0;
+	this->progressDialog = 0;
+	this->convertFollow = false;
 	this->createStatusBar();
 	this->createDataLayout();
 	this->createAdvFeaturesLayout();
+	this->createPreviewLayout();
 	this->createMainLayout();
 	this->updateColumnList();
 	this->mainLayoutCreateConnections();
@@ -42,23 +48,22 @@ void Window::createStatusBar()
 }
 
 
-//! Finds the integer by which the row count must divide to stay within limits.
-//! For example, if there are 200 rows, and the row limit is 50, returns 4
-//! @returns That integer
-//! @see infileNumberRows()
-//! @see updateInfileRowsDisplay()
-quint64 Window::infileRowLimitDivisor()
+//! Computes the row count, row limit divisor and partial row size of the
+//! input file from its cached size, without touching the disk.
+//! @returns The stats, which are unknown while the file is being stat'ed
+//! @see updateDisplay()
+RowStats Window::infileRowStats()
 {
-	quint64 rowLimit = comboRowLimit->currentText().toULongLong();
-	quint64 rows = infileNumberRows();
-	quint64 divider = 1;
-	quint64 start;
-	if((rowLimit < rows) && (rows > 0) && (rowLimit > 0)) {
-		if(checkBoxWriteColNames->isChecked()) rows += 1;
-		start = rows / (rowLimit + 1);
-		for(divider = start; ((rows / divider) > rowLimit); divider += 1);
-	}
-	return divider;
+	RowStats stats;
+	FrameFormat framing = currentFraming();
+	int frameBytes = rowDataSize();
+	if(framing.isFramed())
+		frameBytes += framing.headerBytes() + framing.checksumBytes();
+	if(infileStats->isFile())
+		stats.compute(infileStats->size(), frameBytes,
+					  comboRowLimit->currentText().toULongLong(),
+					  checkBoxWriteColNames->isChecked());
+	return stats;
 }
 
 //! Creates and configures main layout
@@ -83,12 +88,20 @@ void Window::mainLayoutAllocateWidgets()
 	comboInfile = new QComboBox();
 	comboOutfile = new QComboBox();
 	comboRowLimit = new QComboBox();
+	comboDecimation = new QComboBox();
+	lineEditFilter = new QLineEdit();
+	lineEditSync = new QLineEdit();
+	checkBoxLengthByte = new QCheckBox(tr("Length byte"));
+	comboChecksum = new QComboBox();
 	spinColumns = new QSpinBox();
 	infileRowsDisplay = new QLabel();
 	buttonBrowseInput = new QPushButton(tr("Browse"));
 	buttonBrowseOutput = new QPushButton(tr("Browse"));
 	buttonProcessData = new QPushButton(tr("Process data"));
 	checkBoxOpenWhenDone = new QCheckBox(tr("Open output file when finished"));
+	checkBoxFollow = new QCheckBox(tr("Follow data file as it grows"));
+	checkBoxResume = new QCheckBox(tr("Resume"));
+	checkBoxColumnStats = new QCheckBox(tr("Column statistics"));
 }
 
 
@@ -119,6 +132,45 @@ void Window::mainLayoutConfigureWidgets()
 	comboRowLimit->setCompleter(0);
 	comboRowLimit->insertSeparator(0);
 	comboRowLimitDefaultItemCount = 4;
+	comboDecimation->addItem(tr("Keep 1 row in N"), Decimator::KeepFirst);
+	comboDecimation->addItem(tr("Mean of N rows"), Decimator::Mean);
+	comboDecimation->addItem(tr("Min and max of N rows"), Decimator::MinMax);
+	comboDecimation->addItem(tr("Most significant of N rows (LTTB)"),
+							 Decimator::Lttb);
+	comboDecimation->setToolTip(tr("How N rows become one row when the "
+								   "row limit is less than the file's rows"));
+	lineEditFilter->setPlaceholderText(tr("All rows"));
+	lineEditFilter->setToolTip(tr("Keep only rows which match, such as "
+								  "ch3 > 2.5 && seq % 10 == 0. Name columns "
+								  "as in the list below, in [brackets] if "
+								  "the name has spaces, or as $1, $2..."));
+	lineEditSync->setPlaceholderText(tr("Not framed"));
+	lineEditSync->setValidator(new QRegExpValidator(
+			QRegExp("[0-9A-Fa-f ]*"), lineEditSync));
+	lineEditSync->setToolTip(tr("Hex bytes starting each row's frame, such "
+								"as EB90. Bad frames are skipped and "
+								"counted."));
+	checkBoxLengthByte->setToolTip(tr("Each frame has a byte after its sync "
+									  "word holding the row's length"));
+	comboChecksum->addItem(tr("No checksum"), FrameFormat::NoChecksum);
+	comboChecksum->addItem(tr("8-bit sum"), FrameFormat::Sum8);
+	comboChecksum->addItem(tr("8-bit XOR"), FrameFormat::Xor8);
+	comboChecksum->addItem(tr("CRC-16/CCITT"), FrameFormat::Crc16);
+	comboChecksum->addItem(tr("CRC-32"), FrameFormat::Crc32);
+	comboChecksum->setToolTip(tr("Checksum ending each frame, over the "
+								 "length byte and the row"));
+	checkBoxFollow->setToolTip(tr("Keep appending rows to the CSV file as "
+								  "they are written to the data file, until "
+								  "stopped. Ignores the row limit."));
+	checkBoxResume->setToolTip(tr("Continue the CSV file where the last run "
+								  "stopped or the data file ended, instead "
+								  "of starting over, if nothing else has "
+								  "changed"));
+	checkBoxColumnStats->setChecked(DEFAULT_COLUMN_STATS);
+	checkBoxColumnStats->setToolTip(tr("Write the range, mean, standard "
+									   "deviation and histogram of each "
+									   "column to a .stats.json file beside "
+									   "the output file"));
 }
 
 
@@ -132,16 +184,33 @@ void Window::mainLayoutAddWidgets()
 	mainLayout->addWidget(new QLabel(tr("Output file:")), 1, 0);
 	mainLayout->addWidget(comboOutfile, 1, 1, 1, 2);
 	mainLayout->addWidget(buttonBrowseOutput, 1, 3);
-	mainLayout->addWidget(checkBoxOpenWhenDone, 2, 1, 1, 2);
+	QHBoxLayout *jobOptionsLayout = new QHBoxLayout();
+	jobOptionsLayout->addWidget(checkBoxOpenWhenDone);
+	jobOptionsLayout->addWidget(checkBoxFollow);
+	jobOptionsLayout->addWidget(checkBoxResume);
+	jobOptionsLayout->addWidget(checkBoxColumnStats);
+	mainLayout->addLayout(jobOptionsLayout, 2, 1, 1, 3);
 	mainLayout->addWidget(new QLabel(tr("Limit rows:")), 3, 0);
 	mainLayout->addWidget(comboRowLimit, 3, 1, 1, 1);
 	mainLayout->addWidget(infileRowsDisplay, 3, 2, 1, 2);
-	mainLayout->addWidget(new QLabel(tr("Columns:")), 4, 0);
-	mainLayout->addWidget(spinColumns, 4, 1, 1, 1);
-	mainLayout->addWidget(scrollArea, 5, 0, 1, 4);
-	mainLayout->addLayout(advFeaturesLayout, 6, 0, 1, 4);
-	mainLayout->addWidget(buttonProcessData, 7, 0, 1, 4);
-	mainLayout->addWidget(statusBar, 8, 0, 1, 4);
+	mainLayout->addWidget(new QLabel(tr("Reduce by:")), 4, 0);
+	mainLayout->addWidget(comboDecimation, 4, 1, 1, 3);
+	mainLayout->addWidget(new QLabel(tr("Filter rows:")), 5, 0);
+	mainLayout->addWidget(lineEditFilter, 5, 1, 1, 3);
+	mainLayout->addWidget(new QLabel(tr("Frames:")), 6, 0);
+	QHBoxLayout *framingLayout = new QHBoxLayout();
+	framingLayout->addWidget(lineEditSync, 1);
+	framingLayout->addWidget(checkBoxLengthByte);
+	framingLayout->addWidget(comboChecksum);
+	mainLayout->addLayout(framingLayout, 6, 1, 1, 3);
+	mainLayout->addWidget(new QLabel(tr("Columns:")), 7, 0);
+	mainLayout->addWidget(spinColumns, 7, 1, 1, 1);
+	mainLayout->addWidget(checkBoxWriteColNames, 7, 2, 1, 2);
+	mainLayout->addWidget(columnView, 8, 0, 1, 4);
+	mainLayout->addLayout(advFeaturesLayout, 9, 0, 1, 4);
+	mainLayout->addWidget(previewGroupBox, 10, 0, 1, 4);
+	mainLayout->addWidget(buttonProcessData, 11, 0, 1, 4);
+	mainLayout->addWidget(statusBar, 12, 0, 1, 4);
 }
 
 //! Connects the signals of widgets in the main layout to the appropriate slots.
@@ -166,32 +235,42 @@ void Window::mainLayoutCreateConnections() const
 			SLOT(filterLimitRowsName(const QString&)));
 	connect(comboRowLimit, SIGNAL(editTextChanged(const QString&)), this,
 			SLOT(updateDisplay()));
+	connect(comboDecimation, SIGNAL(currentIndexChanged(int)), this,
+			SLOT(updateDisplay()));
+	connect(lineEditSync, SIGNAL(textChanged(QString)), this,
+			SLOT(updateDisplay()));
+	connect(checkBoxLengthByte, SIGNAL(toggled(bool)), this,
+			SLOT(updateDisplay()));
+	connect(comboChecksum, SIGNAL(currentIndexChanged(int)), this,
+			SLOT(updateDisplay()));
 	connect(statusBarMessage, SIGNAL(linkActivated(QString)), this,
 			SLOT(openSystemWebBrowser(QString)));
+	connect(infileStats, SIGNAL(changed()), this, SLOT(updateDisplay()));
 }
 
 
-//! Allocates, configures, and adds widgets to the layout which shows columns.
+//! Allocates and configures the table which shows columns. Its rows are
+//! painted from the ColumnModel, and a cell gets an editor widget only
+//! while it is edited, so any number of columns shows at once.
 //! @see Window()
 void Window::createDataLayout()
 {
-	dataLayout = new QGridLayout;
-	dataLayout->addWidget(new QLabel(tr("#")), 0, 0);
-	checkBoxWriteColNames = new QCheckBox("Column Name");
+	checkBoxWriteColNames = new QCheckBox(tr("Write column names"));
 	checkBoxWriteColNames->setChecked(true);
-	dataLayout->addWidget(checkBoxWriteColNames, 0, 1, 1, 1, Qt::AlignCenter);
-	dataLayout->addWidget(new QLabel(tr("# bytes")), 0, 2);
-	dataLayout->addWidget(new QLabel(tr("Count")), 0, 3);
-	dataLayout->setColumnStretch(1, 2);
-	dataLayout->setAlignment(Qt::AlignTop);
-	dataGroupBox = new QGroupBox();
-	dataGroupBox->setFocusPolicy(Qt::WheelFocus);
-	dataGroupBox->setLayout(dataLayout);
-	scrollArea = new QScrollArea;
-	scrollArea->setWidgetResizable(true);
-	scrollArea->setWidget(dataGroupBox);
+	columnModel = new ColumnModel(this);
+	columnView = new QTableView;
+	columnView->setModel(columnModel);
+	columnView->setItemDelegate(new ColumnDelegate(columnView));
+	columnView->setEditTriggers(QAbstractItemView::AllEditTriggers);
+	columnView->setSelectionMode(QAbstractItemView::SingleSelection);
+	columnView->horizontalHeader()->setResizeMode(ColumnModel::NameField,
+												  QHeaderView::Stretch);
+	columnView->verticalHeader()->setDefaultSectionSize(
+			columnView->fontMetrics().height() + 8);
 	connect(checkBoxWriteColNames, SIGNAL(toggled(bool)), this,
 			SLOT(updateDisplay()));
+	connect(columnModel, SIGNAL(dataChanged(QModelIndex,QModelIndex)), this,
+			SLOT(updateDisplay()));
 }
 
 
@@ -226,58 +305,45 @@ void Window::createAdvFeaturesLayout()
 }
 
 
-//! This slot changes the number of items displayed in the data layout.
-//! @see mainLayoutCreateConnections()
-void Window::updateColumnList()
-{
-	static int oldCount; //! Remembers previous number of columns
-	int newCount = spinColumns->value();
-	for(; oldCount < newCount; ++oldCount) {
-		if(dataLayout->rowCount() -1 > oldCount)
-			dataRowSetVisible(oldCount, true);
-		else
-			dataRowCreate(oldCount);
-	}
-	while(oldCount > newCount) {
-		--oldCount;
-		dataRowSetVisible(newCount, false);
-	}
-}
-
-
-//! Changes the visibility of a row in the data layout.
-//! @param index Index of the row of controls (0-based) to make show or hide.
-//! @param visible Should this row be visible? True or false?
-//! @see updateColumnList()
-void Window::dataRowSetVisible(const int index, const bool visible)
-{
-	dataLabel.at(index)->setVisible(visible);
-	dataComboName.at(index)->setVisible(visible);
-	dataSpinNumBytes.at(index)->setVisible(visible);
-	dataCheckBox.at(index)->setVisible(visible);
+//! Allocates, configures, and adds widgets to the preview of decoded rows.
+//! Only the rows the preview shows are read, and only when the file or the
+//! row size changes; other changes to the layout decode them again at once.
+//! @see Window()
+void Window::createPreviewLayout()
+{
+	previewGroupBox = new QGroupBox(tr("Preview decoded rows"));
+	previewGroupBox->setCheckable(true);
+	previewGroupBox->setChecked(false);
+	previewSummary = new QLabel();
+	previewModel = new PreviewModel(this);
+	previewView = new QTableView;
+	previewView->setModel(previewModel);
+	previewView->setEditTriggers(QAbstractItemView::NoEditTriggers);
+	previewView->verticalHeader()->setDefaultSectionSize(
+			previewView->fontMetrics().height() + 4);
+	QVBoxLayout *previewLayout = new QVBoxLayout;
+	previewLayout->addWidget(previewSummary);
+	previewLayout->addWidget(previewView);
+	previewGroupBox->setLayout(previewLayout);
+	previewSummary->setVisible(false);
+	previewView->setVisible(false);
+	connect(previewGroupBox, SIGNAL(toggled(bool)), this,
+			SLOT(updatePreview()));
+	connect(previewModel, SIGNAL(changed()), this, SLOT(previewChanged()));
+	connect(checkBoxEndian, SIGNAL(toggled(bool)), this,
+			SLOT(updatePreview()));
+	connect(minVoltage, SIGNAL(valueChanged(double)), this,
+			SLOT(updatePreview()));
+	connect(maxVoltage, SIGNAL(valueChanged(double)), this,
+			SLOT(updatePreview()));
 }
 
 
-//! Creates and configures an entire row of widgets in the data layout.
-//! @param index Index of the row (0-based) to create controls in
-//! @see updateColumnList()
-void Window::dataRowCreate(const int index)
+//! This slot changes the number of columns shown in the table of columns.
+//! @see mainLayoutCreateConnections()
+void Window::updateColumnList()
 {
-	dataLabel.append(new QLabel(QString::number(index + 1)));
-	dataComboName.append(new QComboBox());
-	dataComboName.at(index)->setEditable(true);
-	dataSpinNumBytes.append(new QSpinBox());
-	dataSpinNumBytes.at(index)->setRange(1, maxColumnBytes);
-	dataCheckBox.append(new QCheckBox());
-	dataLayout->addWidget(dataLabel.at(index));
-	dataLayout->addWidget(dataComboName.at(index));
-	dataLayout->addWidget(dataSpinNumBytes.at(index));
-	connect(dataSpinNumBytes.at(index), SIGNAL(valueChanged(int)),
-			this, SLOT(updateDisplay()));
-	dataLayout->addWidget(dataCheckBox.at(index));
-	connect(dataComboName.at(index),
-			SIGNAL(editTextChanged(const QString&)), this,
-			SLOT(filterColumnName(const QString&)));
+	columnModel->setCount(spinColumns->value());
 }
 
 
@@ -287,7 +353,8 @@ void Window::openFileDialog()
 {
 	QString fileURI = QFileDialog::getOpenFileName(
 			this, tr("Open data file"), comboInfile->currentText(),
-			tr("All Files (*.*);;Data files (*.dat *.bin)"));
+			tr("All Files (*.*);;Data files (*.dat *.bin);;"
+			   "Compressed data files (*.gz *.zst)"));
 	QFileInfo fInfo(fileURI);
 	if(fInfo.exists()) {
 		int dupeIndex = comboInfile->findText(
@@ -301,38 +368,25 @@ void Window::openFileDialog()
 
 //! Computes the sum of bytes in the columns of any one row of input data.
 //! @returns the number of bytes
-//! @see infileNumberRows()
+//! @see infileRowStats()
 //! @see dataToCsv()
 int Window::rowDataSize()
 {
-	int accumulator = 0, columns = spinColumns->value();
-	for(int index = 0; index < columns; ++index)
-		accumulator += dataSpinNumBytes.at(index)->value();
-	return accumulator;
+	return columnModel->rowDataSize();
 }
 
 
-//! Computes number of rows in input file based on its size and bytes per row.
-//! @returns The number of rows
-//! @see rowDataSize()
+//! @returns How each row of the input file is framed, as set in the window.
+//!			 A sync word which is not whole hex bytes leaves it unframed.
 //! @see dataToCsv()
-//! @see updateInfileRowsDisplay()
-//! @see updateStatusBarFileStats()
-//! @see infileRowLimitDivisor()
-quint64 Window::infileNumberRows()
-{
-	quint64 rows;
-	QFile infile(comboInfile->currentText().trimmed());
-	if(!infile.open(QIODevice::ReadOnly))
-		rows = 0;
-	else {
-		int rowSize = this->rowDataSize();
-		quint64 fileSize = infile.size();
-		rows = fileSize / rowSize;
-		if(fileSize % rowSize != 0) rows += 1; // Don't ignore partial rows
-		infile.close();
-	}
-	return rows;
+FrameFormat Window::currentFraming() const
+{
+	FrameFormat framing;
+	framing.setSyncHex(lineEditSync->text());
+	framing.lengthByte = checkBoxLengthByte->isChecked();
+	framing.checksum = FrameFormat::Checksum(comboChecksum->itemData(
+			comboChecksum->currentIndex()).toInt());
+	return framing;
 }
 
 
@@ -342,7 +396,9 @@ void Window::saveFileDialog()
 {
 	QString fileURI = QFileDialog::getSaveFileName(
 			this, tr("Save as..."), comboOutfile->currentText(),
-			tr("Comma-separated values file (*.csv *.txt);; All files (*.* )"));
+			tr("Comma-separated values file (*.csv *.txt);;"
+			   "Compressed CSV file (*.csv.gz *.csv.zst);;"
+			   "Arrow / Feather file (*.arrow *.feather);; All files (*.* )"));
 	// If file is already in list, delete it and re-insert at the top.
 	int dupeIndex = comboOutfile->findText(
 			fileURI, Qt::MatchFixedString | Qt::MatchCaseSensitive);
@@ -351,183 +407,224 @@ void Window::saveFileDialog()
 	comboOutfile->setCurrentIndex(0);
 }
 
-/*
-000000000000AA80  Correct value
-
-00000000000080AA  Raw data before qbswap
-AA80000000000000  After qbswap
-000000000000AA80  Bit shifted 8 - bytecount * 8 bits.
-*/
-
-//! Opens both input and output files for processing.
-//! @param infile Unassociated QFile object representing input file.
-//! @param outfile Unassociated QFile object representing output file.
-//! @returns True if there was an error opening either one, false otherwise.
+//! Takes a snapshot of the column layout and options shown in the window.
+//! @returns Settings for a Converter
 //! @see dataToCsv()
-bool Window::csvOpenFiles(QFile &infile, QFile &outfile)
+ConvertSettings Window::currentSettings() const
+{
+	ConvertSettings settings;
+	settings.infilePath = comboInfile->currentText();
+	settings.outfilePath = comboOutfile->currentText();
+	for(int index = 0; index < columnModel->rowCount(); ++index) {
+		settings.colNames.append(columnModel->name(index));
+		settings.colBytes.append(columnModel->bytes(index));
+		settings.colCounter.append(columnModel->isCounter(index));
+		settings.colType.append(columnModel->type(index));
+		settings.colExport.append(columnModel->isExported(index));
+	}
+	settings.byteSwap = checkBoxEndian->isChecked();
+	settings.writeColNames = checkBoxWriteColNames->isChecked();
+	settings.vMin = minVoltage->value();
+	settings.vMax = maxVoltage->value();
+	settings.rowLimit = comboRowLimit->currentText().toULongLong();
+	settings.format = ConvertSettings::formatForPath(settings.outfilePath);
+	settings.compression =
+			ConvertSettings::compressionForPath(settings.outfilePath);
+	settings.decimation = Decimator::Mode(comboDecimation->itemData(
+			comboDecimation->currentIndex()).toInt());
+	settings.rowFilter = lineEditFilter->text().trimmed();
+	settings.framing = currentFraming();
+	settings.follow = checkBoxFollow->isChecked();
+	settings.resume = checkBoxResume->isChecked();
+	settings.columnStats = checkBoxColumnStats->isChecked();
+	return settings;
+}
+
+
+//! Controller function to convert input file data to an output .CSV file.
+//! The conversion runs on a ConvertThread with a snapshot of the current
+//! settings, so the window stays responsive and may even be edited meanwhile.
+//! @see mainLayoutCreateConnections()
+//! @see conversionFinished()
+void Window::dataToCsv()
 {
-	bool errorState = false;
-	infile.setFileName(comboInfile->currentText());
-	if(!infile.open(QIODevice::ReadOnly)) {
-		statusBarMessage->setText(tr("Cannot open data file for reading."));
-		errorState = true;
+	if(convertThread != 0 || batchThread != 0) return; // One job at a time
+	QStringList files = batchInputs();
+	if(files.isEmpty()) {
+		statusBarMessage->setText(tr("No data files match %1")
+								  .arg(comboInfile->currentText()));
+		return;
 	}
-	else {
-		outfile.setFileName(comboOutfile->currentText());
-		if(!outfile.open(QIODevice::WriteOnly | QIODevice::Text)) {
-			statusBarMessage->setText(tr(
-					"Cannot open output file for writing."));
-			errorState = true;
-		}
-		else {
-			QFileInfo ifinfo(infile);
-			QFileInfo ofinfo(outfile);
-			if(ifinfo.canonicalFilePath() == ofinfo.canonicalFilePath()) {
-				statusBarMessage->setText(tr(
-						"Input and output files must not be the same file!"));
-				errorState = true;
-			}
-		}
+	if(!FrameFormat().setSyncHex(lineEditSync->text())) {
+		statusBarMessage->setText(tr("The sync word must be 1 to %1 whole "
+									 "hex bytes, such as EB90.")
+								  .arg(maxSyncBytes));
+		return;
 	}
-	return errorState;
-}
-
-
-//! Writes the first row of the output file -- the names of each column.
-//! @param ts QTextStream object already associated with an output file
-//! @returns True if column names were written, false otherwise
-//! @see dataToCsv()
-bool Window::csvWriteColumnNames(QTextStream &ts)
-{
-	bool retval = false;
-	for(int index = 0; index < spinColumns->value(); ++index) {
-		if(dataComboName.at(index)->isHidden()) break;
-		else {
-			ts << dataComboName.at(index)->currentText().trimmed() << ',';
-			retval = true;
-		}
+	if(files.size() > 1) {
+		startBatch(files);
+		return;
 	}
-	ts << endl;
-	return retval;
-}
-
-//! Processes all data in one row of input & writes appropriate data to output
-//! @param ts QTextStream already associated with an output file
-//! @param infile QFile object representing input (raw data) file
-//! @param colCount Interpret data in infile as having this many "columns"
-//! @param colSize Array of column sizes with colSize[n] = bytes in column n
-//! @param byteSwap Swap endianness of source data. True or false.
-//! @param vMin If device outputs between 1.1v and 5.5v, this is the 1.1v
-//! @param vMax If device outputs between 1.1v and 5.5v, this is the 5.1v
+	ConvertSettings settings = currentSettings();
+	settings.infilePath = files.first();
+	convertOutfilePath = settings.outfilePath;
+	convertFollow = settings.follow;
+	convertThread = new ConvertThread(settings, this);
+	if(convertFollow) // Stopping keeps the rows converted so far
+		progressDialog = new QProgressDialog(tr("Following data file..."),
+											 tr("Stop"), 0, 0, this);
+	else progressDialog = new QProgressDialog(tr("Saving CSV file..."),
+											  tr("Cancel"), 0, 0, this);
+	connect(convertThread, SIGNAL(progressRange(int,int)),
+			progressDialog, SLOT(setRange(int,int)));
+	connect(convertThread, SIGNAL(progressChanged(int)),
+			progressDialog, SLOT(setValue(int)));
+	connect(convertThread, SIGNAL(throughputChanged(double,int)),
+			this, SLOT(conversionThroughput(double,int)));
+	connect(progressDialog, SIGNAL(canceled()),
+			convertThread, SLOT(cancel()));
+	connect(convertThread, SIGNAL(finished()),
+			this, SLOT(conversionFinished()));
+
+	buttonProcessData->setEnabled(false);
+	statusBarMessage->setText(tr("Processing data file..."));
+	convertThread->start();
+}
+
+
+//! @returns The data files to convert: those dropped together on the window,
+//!			 if the first of them is still the input file, or else the files
+//!			 the input file's name matches if it holds wildcards
 //! @see dataToCsv()
-void inline Window::csvProcessRow(QTextStream &ts, QFile &infile, int colCount,
-								  QByteArray &colSize, bool byteSwap,
-								  double vMin, double vMax)
-{
-	static raw2quint64 raw;
-	raw.ui64 = 0;
-	for(int col = 0; col < colCount; ++col) { // For each column in this row
-		int readError = infile.read(raw.bytes, colSize[col]);
-		if(readError == -1) {
-			statusBarMessage->setText(tr("Error reading data file."));
-			return; // TODO: Get rid of multiple returns
-		}
-		if(byteSwap) raw.ui64 = qbswap(raw.ui64) >> ((8 - colSize[col]) << 3);
-		// TODO: Get rid of this check against a GUI checkbox
-		if(dataCheckBox.at(col)->isChecked()) ts << raw.ui64 << ',';
-		else {
-			double colVal = rawIntToVoltage(raw.ui64, colSize[col], vMin, vMax);
-			ts << qSetRealNumberPrecision(15) << colVal << ',';
-		}
-	}
-	ts << endl;
+QStringList Window::batchInputs() const
+{
+	if(isDroppedBatch()) return droppedFiles;
+	return BatchQueue::expandPattern(comboInfile->currentText());
 }
 
 
-//! Controller function to convert input file data to an output .CSV file
-//! @see mainLayoutCreateConnections()
-void Window::dataToCsv()
+//! @returns Whether several files were dropped together on the window, and
+//!			 the first of them is still the input file
+bool Window::isDroppedBatch() const
 {
-	QFile infile, outfile;
-	bool errorOpeningEitherFile = csvOpenFiles(infile,  outfile);
-
-	if(!errorOpeningEitherFile) {
-		int colCount = spinColumns->value();
-		int rowSize = rowDataSize();
-		quint64 rowsOutput = 0;
-		quint64 rowLimit = comboRowLimit->currentText().toULongLong();
-		quint64 divCount = infileRowLimitDivisor();
-		bool byteSwap = checkBoxEndian->isChecked();
-		bool cancelled = false;
-		double vMin = minVoltage->value();
-		double vMax = maxVoltage->value();
-		QTextStream ts(&outfile);
-		if(checkBoxWriteColNames->isChecked())
-			if(csvWriteColumnNames(ts)) rowsOutput += 1;
-
-		QByteArray colSize(colCount, '\n');
-		for(int index = 0; index < colCount; ++index)
-			colSize[index] = dataSpinNumBytes.at(index)->value();
-
-		quint64 pMax = infileNumberRows();
-		if(rowLimit > 0 && rowLimit < pMax) pMax = rowLimit;
-		QProgressDialog progress("Saving CSV file...", "Cancel", 0, pMax, this);
-		progress.setModal(true);
-
-		statusBarMessage->setText(tr("Processing data file..."));
-		while(!infile.atEnd()) {
-//		while(rowsOutput <= pMax) {
-			if(rowLimit > 0 && rowsOutput >= rowLimit) break;
-
-			// Updating the status bar for every line processed is too slow!
-			if(rowsOutput % 1024 == 0) {
-				progress.setValue(rowsOutput);
-				if(progress.wasCanceled()) {
-					cancelled = true;
-					statusBarMessage->setText(tr("Processing cancelled."));
-					outfile.remove();
-					break;
-				}
-			}
-			csvProcessRow(ts, infile, colCount, colSize, byteSwap, vMin, vMax);
-			++rowsOutput;
-			if(divCount > 1)
-				infile.seek(infile.pos() + (rowSize * (divCount - 1)));
-		}
-		infile.close();
-		outfile.close();
-		if(!cancelled) statusBarMessage->setText(tr("Processing complete."));
-		if(checkBoxOpenWhenDone->isChecked()) openFileWithAssociatedProgram();
-	}
+	return droppedFiles.size() > 1 && comboInfile->currentText() ==
+			QDir::toNativeSeparators(droppedFiles.first());
 }
 
 
-//! Converts a raw unsigned integer value range [0, 2^numBits] to a voltage.
-//! Assumes that vMax > vMin
-//! @param value One piece of the raw uninterpreted data from the source file
-//! @param numBytes The size of value in number of bytes
-//! @param vMin If device outputs between 1.1v and 5.5v, this is the 1.1v
-//! @param vMax If device outputs between 1.1v and 5.5v, this is the 5.1v
-//! @returns The computed voltage in the range [vMin, vMax]
+//! Converts several data files with the current settings, on a BatchThread.
+//! Each output file is named after its data file, in the output file's
+//! directory and with its extension; see BatchQueue::outputPathFor().
+//! @param files The data files
 //! @see dataToCsv()
-inline double Window::rawIntToVoltage(const quint64 value, const int numBytes,
-									 const double vMin, const double vMax) const
-{
-	double range = vMax - vMin;
-	// Corrected bug reported by Riley Pack, 26 Jan 2010
-	//	quint64 maxVal = 1 << (numBytes << 3); // pow(2,(bits in numBytes))
-	quint64 maxVal = (1 << (numBytes << 3)) -1; // pow(2,(bits in numBytes))
-
-	return (value / (maxVal / range)) + vMin;
+//! @see batchFinished()
+void Window::startBatch(const QStringList &files)
+{
+	ConvertSettings settings = currentSettings();
+	QString outputTemplate = comboOutfile->currentText().trimmed();
+	batchThread = new BatchThread(this);
+	for(int index = 0; index < files.size(); ++index) {
+		settings.infilePath = files.at(index);
+		settings.outfilePath = BatchQueue::outputPathFor(files.at(index),
+														 outputTemplate);
+		settings.format = ConvertSettings::formatForPath(settings.outfilePath);
+		settings.compression =
+				ConvertSettings::compressionForPath(settings.outfilePath);
+		if(!batchThread->batch().add(settings)) {
+			statusBarMessage->setText(batchThread->batch().errorMessage);
+			delete batchThread;
+			batchThread = 0;
+			return;
+		}
+	}
+	progressDialog = new QProgressDialog(
+			tr("Converting %1 data files...").arg(files.size()),
+			tr("Cancel"), 0, files.size(), this);
+	connect(batchThread, SIGNAL(progressRange(int,int)),
+			progressDialog, SLOT(setRange(int,int)));
+	connect(batchThread, SIGNAL(progressChanged(int)),
+			progressDialog, SLOT(setValue(int)));
+	connect(progressDialog, SIGNAL(canceled()), batchThread, SLOT(cancel()));
+	connect(batchThread, SIGNAL(finished()), this, SLOT(batchFinished()));
+
+	buttonProcessData->setEnabled(false);
+	statusBarMessage->setText(tr("Processing data files..."));
+	batchThread->start();
+}
+
+
+//! Reports the result of a batch when its thread finishes: the whole batch
+//! in the status bar, and each file in its tooltip.
+//! @see startBatch()
+void Window::batchFinished()
+{
+	progressDialog->deleteLater();
+	progressDialog = 0;
+	const BatchQueue &batch = batchThread->batch();
+	QStringList lines;
+	for(int index = 0; index < batch.size(); ++index)
+		lines.append(batch.jobSummary(index));
+	QString summary = batch.summary();
+	if(batchThread->wasSuccessful())
+		summary = tr("Processing complete. ") + summary;
+	statusBarMessage->setText(summary);
+	statusBarMessage->setToolTip(lines.join("\n"));
+	batchThread->deleteLater();
+	batchThread = 0;
+	buttonProcessData->setEnabled(true);
+}
+
+
+//! Shows the conversion speed and estimated time remaining.
+//! @param secondsRemaining Estimated time remaining, or -1 if unknown
+//! @see dataToCsv()
+void Window::conversionThroughput(double rowsPerSecond, int secondsRemaining)
+{
+	if(progressDialog == 0) return;
+	QString remaining = QTime(0, 0).addSecs(secondsRemaining).toString(
+			secondsRemaining >= 3600 ? "h:mm:ss" : "m:ss");
+	if(convertFollow)
+		progressDialog->setLabelText(
+				tr("Following data file...\n%1 rows per second")
+				.arg(qRound64(rowsPerSecond)));
+	else if(secondsRemaining < 0)	// A compressed data file's rows are
+		progressDialog->setLabelText(	// not known until it is all read
+				tr("Saving CSV file...\n%1 rows per second")
+				.arg(qRound64(rowsPerSecond)));
+	else progressDialog->setLabelText(
+			tr("Saving CSV file...\n%1 rows per second, %2 remaining")
+			.arg(qRound64(rowsPerSecond)).arg(remaining));
+}
+
+
+//! Reports the result of the conversion when its thread finishes.
+//! @see dataToCsv()
+void Window::conversionFinished()
+{
+	progressDialog->deleteLater();
+	progressDialog = 0;
+	statusBarMessage->setToolTip(QString());
+	if(convertThread->wasSuccessful()) {
+		statusBarMessage->setText(tr("Processing complete. ") +
+								  convertThread->runStats().summary());
+		statusBarMessage->setToolTip(convertThread->columnStats().summary());
+		if(checkBoxOpenWhenDone->isChecked())
+			openFileWithAssociatedProgram(convertOutfilePath);
+	}
+	else statusBarMessage->setText(convertThread->errorMessage());
+	convertThread->deleteLater();
+	convertThread = 0;
+	buttonProcessData->setEnabled(true);
 }
 
 
 //! Opens a file or URI with an applications the host operating system suggests.
-//! @see dataToCsv()
-void Window::openFileWithAssociatedProgram() const
+//! @param path The file to open
+//! @see conversionFinished()
+void Window::openFileWithAssociatedProgram(const QString &path) const
 {
 	QString filePath("file:///");
-	filePath += comboOutfile->currentText();
+	filePath += path;
 	QUrl fileURI(filePath, QUrl::TolerantMode);
 	QDesktopServices::openUrl(fileURI);
 }
@@ -549,20 +646,38 @@ bool Window::importSettings()
 		comboOutfile->addItems(config->pathlistOutfile);
 
 	checkBoxOpenWhenDone->setChecked(config->boxOpen);
+	previewGroupBox->setChecked(config->previewOpen);
+	checkBoxEndian->setChecked(config->swapBytes);
+	checkBoxWriteColNames->setChecked(config->writeColNames);
+	maxVoltage->setValue(config->maxVoltage);
+	minVoltage->setValue(config->minVoltage);
 	comboRowLimit->insertItem(0, QString::number(
 			getUint64(config->limitRows.trimmed())));
 	comboRowLimit->setCurrentIndex(0);
+	int mode = Decimator::modeFromName(config->decimation);
+	comboDecimation->setCurrentIndex(comboDecimation->findData(mode));
+	lineEditFilter->setText(config->rowFilter);
+	lineEditSync->setText(config->syncWord);
+	checkBoxLengthByte->setChecked(config->lengthByte);
+	checkBoxColumnStats->setChecked(config->columnStats);
+	comboChecksum->setCurrentIndex(comboChecksum->findData(
+			FrameFormat::checksumFromName(config->checksum)));
 
 	int colCount = config->colCount;
 
 	if(this->spinColumns->value() < colCount) spinColumns->setValue(colCount);
 	for(int index = 0; index < colCount; ++index) {
 		if(config->colNames.size() > index)
-			dataComboName.at(index)->addItems(config->colNames.at(index));
+			columnModel->setNameHistory(index, config->colNames.at(index));
 		if(config->colBoxChecked.size() > index)
-			dataCheckBox.at(index)->setChecked(config->colBoxChecked.at(index));
+			columnModel->setCounter(index, config->colBoxChecked.at(index));
+		if(config->colExport.size() > index)
+			columnModel->setExported(index, config->colExport.at(index));
+		if(config->colType.size() > index)
+			columnModel->setType(index, DecodePlan::typeFromName(
+					config->colType.at(index)));
 		if(config->colBytes.size() > index)
-			dataSpinNumBytes.at(index)->setValue(config->colBytes.at(index));
+			columnModel->setBytes(index, config->colBytes.at(index));
 	}
 	spinColumns->setValue(config->colCount);
 	return retval;
@@ -589,25 +704,35 @@ void Window::exportSettings() const
 	config->pathlistOutfile.removeDuplicates();
 
 	config->boxOpen = checkBoxOpenWhenDone->isChecked();
+	config->previewOpen = previewGroupBox->isChecked();
+	config->swapBytes = checkBoxEndian->isChecked();
+	config->decimation = Decimator::modeName(Decimator::Mode(
+			comboDecimation->itemData(
+					comboDecimation->currentIndex()).toInt()));
+	config->writeColNames = checkBoxWriteColNames->isChecked();
+	config->rowFilter = lineEditFilter->text().trimmed();
+	config->syncWord = lineEditSync->text().trimmed();
+	config->lengthByte = checkBoxLengthByte->isChecked();
+	config->columnStats = checkBoxColumnStats->isChecked();
+	config->checksum = FrameFormat::checksumName(FrameFormat::Checksum(
+			comboChecksum->itemData(comboChecksum->currentIndex()).toInt()));
+	config->minVoltage = minVoltage->value();
+	config->maxVoltage = maxVoltage->value();
 
 	if(comboRowLimit->count() > comboRowLimitDefaultItemCount) {
 		config->limitRows = comboRowLimit->currentText();
 	}
 	config->colCount = spinColumns->value();
 
-	QStringList sl;
-	for(index = 0; index < spinColumns->value(); ++index) { // For each column
-		QComboBox *cBox = dataComboName.at(index);
-		sl.append(cBox->currentText()); // Add the currently displayed text
-		// For each name in this combobox
-		for(int name = 0; name < cBox->count(); ++name) {
-			sl.append(cBox->itemText(name));
-		}
+	for(index = 0; index < columnModel->rowCount(); ++index) {
+		// The current name first, then the names used before
+		QStringList sl = columnModel->nameHistory(index);
 		sl.removeDuplicates();
 		config->colNames.append(sl);
-		sl.clear();
-		config->colBoxChecked.append(dataCheckBox.at(index)->isChecked());
-		config->colBytes.append(dataSpinNumBytes.at(index)->value());
+		config->colBoxChecked.append(columnModel->isCounter(index));
+		config->colExport.append(columnModel->isExported(index));
+		config->colType.append(DecodePlan::typeName(columnModel->type(index)));
+		config->colBytes.append(columnModel->bytes(index));
 	}
 }
 
@@ -626,42 +751,51 @@ quint64 Window::getUint64(const QString &text, const quint8 maxDigits) const
 }
 
 
-//!	Blocks disruptive characters from being entered in a column name field.
-//! This function directly changes the text in the GUI combobox controls.
-//! @param text The string to insert into the output CSV file after filtering
-//! @see dataRowCreate()
-void Window::filterColumnName(const QString &text)
-{
-	QString filtered = text;
-	// The following characters cause problems with CSV and so are banned: \",
-	filtered.remove(QRegExp("[\\\\\\\",]"));
-	if(text.length() != filtered.length()) {
-		// To find out which combobox is being typed in, we have to request
-		// the sender. It arrives as a QObject, which we cast to a QComboBox
-		QComboBox * cBox = reinterpret_cast<QComboBox*>(QObject::sender());
-		cBox->setEditText(filtered);
-	}
-}
-
-
 //! This slot updates to on-screen stats (number of rows in current file, etc.)
 //! @see mainLayoutCreateConnections()
 //! @see createDataLayout()
-//! @see dataRowCreate()
 void Window::updateDisplay()
 {
-	this->updateInfileRowsDisplay();
-	this->updateStatusBarFileStats();
+	infileStats->setPath(comboInfile->currentText().trimmed());
+	RowStats stats = infileRowStats();
+	this->updateInfileRowsDisplay(stats);
+	this->updateStatusBarFileStats(stats);
+	this->updatePreview();
+}
+
+
+//! Shows the preview's rows decoded with the current layout, if the preview
+//! is open. A change to the byte order or voltages needs no reading.
+//! @see createPreviewLayout()
+//! @see updateDisplay()
+void Window::updatePreview()
+{
+	bool open = previewGroupBox->isChecked();
+	previewSummary->setVisible(open);
+	previewView->setVisible(open);
+	if(!open) return;
+	ConvertSettings settings = currentSettings();
+	settings.infilePath = comboInfile->currentText().trimmed();
+	previewModel->update(settings, infileStats->size());
+}
+
+
+//! Tells which rows the preview shows, once they are decoded.
+//! @see createPreviewLayout()
+void Window::previewChanged()
+{
+	previewSummary->setText(previewModel->summary());
 }
 
 
 //! Updates the display of the number of data rows in the current input file.
+//! @param stats Stats of the input file under the current layout
 //! @see updateDisplay()
-void Window::updateInfileRowsDisplay()
+void Window::updateInfileRowsDisplay(const RowStats &stats)
 {
 	QString display;
 	int addRows = 0;
-	quint64 numRows = infileNumberRows();
+	quint64 numRows = stats.rows;
 	if(numRows < 1) display = "Unknown # rows";
 	else {
 		if(checkBoxWriteColNames->isChecked()) addRows = 1;
@@ -672,16 +806,25 @@ void Window::updateInfileRowsDisplay()
 
 
 //! Updates the status bar with statistics regarding current file vs. row limit.
+//! @param stats Stats of the input file under the current layout
 //! @see updateDisplay()
-void Window::updateStatusBarFileStats()
+void Window::updateStatusBarFileStats(const RowStats &stats)
 {
 	quint64 rowLimit = comboRowLimit->currentText().toULongLong();
-	quint64 rowDivide = infileRowLimitDivisor();
-	QString display = defaultStatusMessage;
-	if(rowLimit < infileNumberRows() && rowLimit != 0)
-		display = QString("Row limit %1: Keeping 1 in %2 rows."
-						  ).arg(rowLimit).arg(rowDivide);
-	statusBarMessage->setText(display);
+	QStringList display;
+	bool keepFirst = comboDecimation->itemData(
+			comboDecimation->currentIndex()).toInt() == Decimator::KeepFirst;
+	if(rowLimit < stats.rows && rowLimit != 0)
+		display << QString(keepFirst ? "Row limit %1: Keeping 1 in %2 rows."
+									 : "Row limit %1: Reducing %2 rows to 1."
+						   ).arg(rowLimit).arg(stats.divisor);
+	if(stats.partialRowBytes != 0)
+		display << QString("Last row has only %1 of %2 bytes."
+						   ).arg(stats.partialRowBytes).arg(rowDataSize());
+	if(isDroppedBatch()) display << QString("%1 data files queued."
+											).arg(droppedFiles.size());
+	if(display.isEmpty()) display << defaultStatusMessage;
+	statusBarMessage->setText(display.join(" "));
 }
 
 
@@ -736,20 +879,23 @@ void Window::dragEnterEvent(QDragEnterEvent *event)
 }
 
 
-//! Sets comboInfile text to the first in a file list dropped on the main window
+//! Sets comboInfile text to the first in a file list dropped on the main
+//! window. When several files are dropped, all of them are converted as one
+//! batch; see batchInputs().
 void Window::dropEvent(QDropEvent *event)
 {
-	QFileInfo fInfo;
 	QList<QUrl> urls = event->mimeData()->urls();
-	if(! urls.isEmpty()) {
-		QString fileURI = urls.first().toLocalFile();
-		if(! fileURI.isEmpty()) {
-			fInfo.setFile(fileURI);
-			if(fInfo.isFile()) {
-				comboInfile->insertItem(0, QDir::toNativeSeparators(fileURI));
-				comboInfile->setCurrentIndex(0);
-			}
-		}
+	QStringList files;
+	for(int index = 0; index < urls.size(); ++index) {
+		QString fileURI = urls.at(index).toLocalFile();
+		if(! fileURI.isEmpty() && QFileInfo(fileURI).isFile())
+			files.append(fileURI);
+	}
+	if(! files.isEmpty()) {
+		comboInfile->insertItem(0, QDir::toNativeSeparators(files.first()));
+		comboInfile->setCurrentIndex(0);
+		droppedFiles = files;
+		updateDisplay();
 	}
 }
 
@@ -757,6 +903,15 @@ void Window::dropEvent(QDropEvent *event)
 //! Called when program is closed. Saves settings and writes them to disk.
 void Window::closeEvent(QCloseEvent *event)
 {
+	if(convertThread != 0) { // Stop the job; partial output is removed,
+							 // unless the job was following the data file
+		convertThread->cancel();
+		convertThread->wait();
+	}
+	if(batchThread != 0) {
+		batchThread->cancel();
+		batchThread->wait();
+	}
 	exportSettings();
 	config->xmlWrite(this->configFileURI);
 	event->accept();
@@ -19,7 +19,10 @@
 #include <QComboBox>
 #include <QSpinBox>
 #include <QCheckBox>
-#include <QScrollArea>
+#include <QLineEdit>
+#include <QRegExpValidator>
+#include <QTableView>
+#include <QHeaderView>
 #include <QDragEnterEvent>
 #include <QUrl>
 #include <QApplication>
@@ -29,22 +32,20 @@
 #include <QtDebug>
 #include <QtGui/QStatusBar>
 #include <QProgressDialog>
+#include <QTime>
 #include "Config.h"
+#include "Converter.h"
+#include "ConvertThread.h"
+#include "FileStats.h"
+#include "ColumnModel.h"
+#include "PreviewModel.h"
 
 //const QString defaultStatusMessage(" 2009 Charles N. Burns, RockOn! 2009 - for <a href=\"http://spacegrant.colorado.edu/rockon/\">RockOn! Workshop</a>");
 const QString defaultStatusMessage(" 2009 Charles N. Burns");
 
-const quint8 maxColumnBytes = 8;
 const float minVoltageDifference = 1.0f;
 
 
-//! Used in the processing out output data
-union raw2quint64 {
-	char bytes[8];
-	quint64 ui64;
-};
-
-
 class Window : public QWidget
 {
 	Q_OBJECT
@@ -52,25 +53,30 @@ class Window : public QWidget
 	// Main UI
 	QGridLayout *mainLayout;
 	QPushButton *buttonBrowseInput, *buttonBrowseOutput, *buttonProcessData;
-	QComboBox *comboInfile, *comboOutfile, *comboRowLimit;
+	QComboBox *comboInfile, *comboOutfile, *comboRowLimit, *comboDecimation;
 	QCheckBox *checkBoxOpenWhenDone, *checkBoxWriteColNames, *checkBoxEndian;
+	QCheckBox *checkBoxFollow, *checkBoxResume, *checkBoxColumnStats;
+	QLineEdit *lineEditFilter, *lineEditSync;
+	QCheckBox *checkBoxLengthByte;
+	QComboBox *comboChecksum;
 
 	QDoubleSpinBox *minVoltage, *maxVoltage;
 
 	QSpinBox *spinColumns;
-	QScrollArea *scrollArea;
 	QStatusBar *statusBar;
 	QLabel *statusBarMessage, *infileRowsDisplay;
 
 
 	// Data columns information (column name, # bytes, counter or non-counter)
-	QGroupBox *dataGroupBox;
 	QHBoxLayout *advFeaturesLayout;
-	QGridLayout *dataLayout;
-	QList<QLabel*> dataLabel;
-	QList<QSpinBox*> dataSpinNumBytes;
-	QList<QComboBox*> dataComboName;
-	QList<QCheckBox*> dataCheckBox;
+	QTableView *columnView;
+	ColumnModel *columnModel;
+
+	// Preview of the first, last and sampled rows under the current layout
+	QGroupBox *previewGroupBox;
+	QLabel *previewSummary;
+	QTableView *previewView;
+	PreviewModel *previewModel;
 
 	// Function prototypes
 	void createMainLayout();
@@ -81,29 +87,26 @@ class Window : public QWidget
 	void createStatusBar();
 	void createDataLayout();
 	void createAdvFeaturesLayout();
+	void createPreviewLayout();
 	bool importSettings();
 	void exportSettings() const;
-	void dataRowSetVisible(const int index, const bool visible);
-	void dataRowCreate(const int index);
 	void mainLayoutCreateConnections() const;
-	double rawIntToVoltage(const quint64 value, const int numBytes,
-						   const double vMin = 0.0,
-						   const double vMax = 5.0) const;
 	int rowDataSize();
-	quint64 infileRowLimitDivisor();
-	quint64 infileNumberRows();
+	FrameFormat currentFraming() const;
+	RowStats infileRowStats();
+	void updateInfileRowsDisplay(const RowStats &stats);
+	void updateStatusBarFileStats(const RowStats &stats);
 	void closeEvent(QCloseEvent *event);
 	void dragEnterEvent(QDragEnterEvent *event);
 	void dropEvent(QDropEvent *event);
-	void openFileWithAssociatedProgram() const;
+	void openFileWithAssociatedProgram(const QString &path) const;
 	quint64 getUint64(const QString &text = "",
 					  const quint8 maxDigits = 19) const;
 
-	bool csvOpenFiles(QFile &infile, QFile &outfile);
-	bool csvWriteColumnNames(QTextStream &ts);
-	void csvProcessRow(QTextStream &ts, QFile &infile, int columnCount,
-					   QByteArray &columnSize, bool swapEndian,
-					   double vMin, double vMax);
+	ConvertSettings currentSettings() const;
+	QStringList batchInputs() const;
+	bool isDroppedBatch() const;
+	void startBatch(const QStringList &files);
 
 	// Private member variables
 	quint8 comboRowLimitDefaultItemCount;
@@ -112,16 +115,25 @@ class Window : public QWidget
 //	static const float minVoltageDifference = 1.0f;
 		QString configFileURI;
 	Config *config;
+	FileStatsCache *infileStats;	// Size of the input file, read off-thread
+	ConvertThread *convertThread;	// The running conversion, if any
+	BatchThread *batchThread;		// The running batch of conversions, if any
+	QStringList droppedFiles;		// Files dropped together, for a batch
+	QProgressDialog *progressDialog;
+	QString convertOutfilePath;
+	bool convertFollow;		// The job keeps following the data file
 
 private slots:
 	void openFileDialog();
 	void saveFileDialog();
 	void updateColumnList();
-	void updateInfileRowsDisplay();
 	void updateDisplay();
-	void updateStatusBarFileStats();
+	void updatePreview();
+	void previewChanged();
 	void dataToCsv();
-	void filterColumnName(const QString &text);
+	void conversionThroughput(double rowsPerSecond, int secondsRemaining);
+	void conversionFinished();
+	void batchFinished();
 	void filterLimitRowsName(const QString &text);
 	void maxVoltageChanged(double newValue);
 	void minVoltageChanged(double newValue);
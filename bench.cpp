@@ -0,0 +1,442 @@
+/*
+	Name        : bench.cpp
+	Author      : Charles N. Burns (charlesnburns|gmail|com / burnchar|isu|edu)
+	Date        : October 2026
+	License     : GPL3. See license.txt or www.gnu.org/licenses/gpl-3.0.txt
+	Requirements: Qt 4.
+	Notes       : Best viewed with tab width 4.
+	Description : Throughput benchmark. Generates synthetic captures, then
+				  times each stage of a conversion on them separately, so a
+				  change to any stage can be measured on the same workloads.
+
+	Usage:
+
+	cnb-data-parser-bench [--layout SPEC]... [--size SIZES] [--endian ORDER]
+						  [--threads N] [--precision N] [--dir DIR] [--keep]
+
+	SPEC lists the columns of one layout, such as 2c,2v,4v: each column is a
+	width of 1 to 8 bytes followed by c for a counter or v for a voltage,
+	with an s before the letter if it is signed, as in 2sv, or by f for a
+	float of 2, 4 or 8 bytes.
+	--layout may be given more than once. SIZES lists capture sizes, such as
+	1M,100M,10G. ORDER is swapped, native or both. Captures are written to
+	DIR, the system's temporary directory by default, as cnb-bench-N.bin with
+	the CSV files beside them, and removed afterward unless --keep is given.
+
+	Each workload prints one line of JSON to stdout with the seconds, MB/s
+	and rows/s of each stage:
+	  read     touching every page of the memory-mapped capture
+	  decode   DecodePlan turning rows into counters and voltages
+	  format   CsvFormatter turning decoded values into CSV text
+	  write    writing that text to a file
+	  convert  a whole Converter job, using every thread, with the column
+	           statistics written beside its output
+	  convert_no_stats  the same job with the column statistics turned off
+	MB/s counts capture bytes, except for write, which counts CSV bytes. The
+	capture was just written, so the read stage measures the page cache.
+	column_stats_cost is the share of the convert stage's time which the
+	column statistics add: its seconds over those of convert_no_stats, less
+	one. Run each workload a few times before trusting a small difference.
+*/
+
+#include <QCoreApplication>
+#include <QStringList>
+#include <QTextStream>
+#include <QElapsedTimer>
+#include <QDir>
+#include <cstdio>
+#include "Converter.h"
+#include "DecodeSimd.h"
+
+const char BENCH_DEFAULT_LAYOUT[] = "2c,2v,2v,2v";
+const char BENCH_DEFAULT_SIZES[] = "1M,100M";
+const qint64 benchWriteBlockBytes = 4 << 20;	// Capture and CSV writes
+
+
+//! One capture to generate and convert.
+struct Workload
+{
+	QString layout;
+	QList<quint8> colBytes;
+	QList<bool> colCounter;
+	QList<PlanColumn::Type> colType;
+	bool byteSwap;
+	quint64 bytes;
+};
+
+
+//! Time and amount of work of one stage.
+struct StageTime
+{
+	StageTime() : nanoseconds(0), bytes(0), rows(0) {}
+	qint64 nanoseconds;
+	quint64 bytes;
+	quint64 rows;
+};
+
+
+//! Prints the usage message to stderr.
+static void printUsage(QTextStream &err)
+{
+	err << "Usage: cnb-data-parser-bench [--layout 2c,2v,4v]... "
+		   "[--size 1M,100M,10G] [--endian swapped|native|both] "
+		   "[--threads N] [--precision N] [--dir DIR] [--keep]" << endl;
+}
+
+
+//! Reads a layout such as 2c,2v,4v into the column lists of a workload.
+//! @returns false if the layout is not valid
+static bool parseLayout(const QString &spec, Workload &work)
+{
+	bool retval = !spec.isEmpty();
+	work.layout = spec;
+	work.colBytes.clear();
+	work.colCounter.clear();
+	work.colType.clear();
+	QStringList columns = spec.split(',');
+	for(int col = 0; col < columns.size() && retval; ++col) {
+		QString column = columns.at(col).trimmed().toLower();
+		int digits = 0;
+		while(digits < column.size() && column.at(digits).isDigit()) ++digits;
+		int bytes = column.left(digits).toInt();
+		QString kind = column.mid(digits);
+		PlanColumn::Type type = PlanColumn::Unsigned;
+		if(kind == "f") type = PlanColumn::Float;
+		else if(kind.startsWith('s')) {
+			type = PlanColumn::Signed;
+			kind.remove(0, 1);
+		}
+		retval = (DecodePlan::typeFits(type, bytes) &&
+				  (type == PlanColumn::Float || kind == "c" || kind == "v"));
+		work.colBytes.append(bytes);
+		work.colCounter.append(kind == "c");
+		work.colType.append(type);
+	}
+	return retval;
+}
+
+
+//! Reads a size such as 100M or 10G.
+//! @returns The number of bytes, or 0 if the size is not valid
+static quint64 parseSize(const QString &text)
+{
+	QString size = text.trimmed().toUpper();
+	quint64 scale = 1;
+	if(size.endsWith('K')) scale = Q_UINT64_C(1) << 10;
+	else if(size.endsWith('M')) scale = Q_UINT64_C(1) << 20;
+	else if(size.endsWith('G')) scale = Q_UINT64_C(1) << 30;
+	if(scale > 1) size.chop(1);
+	return size.toULongLong() * scale;
+}
+
+
+//! @returns The bits of a float of the given width, between 1 and 2, with random
+//!			 mantissa bits, so no value is NaN or infinite
+static quint64 floatBits(int bytes, quint64 random)
+{
+	if(bytes == 2) return 0x3c00 | (random & 0x3ff);
+	if(bytes == 4) return 0x3f800000 | (random & 0x7fffff);
+	return Q_UINT64_C(0x3ff0000000000000) |
+			(random & Q_UINT64_C(0xfffffffffffff));
+}
+
+
+//! Fills a capture with whole rows: counters count up from 0, voltages and
+//! floats are pseudo-random, so the formatter sees realistic digit counts.
+//! @returns false on a write error
+static bool generateCapture(const QString &path, const Workload &work,
+							quint64 &rows)
+{
+	int rowSize = 0;
+	for(int col = 0; col < work.colBytes.size(); ++col)
+		rowSize += work.colBytes.at(col);
+	rows = work.bytes / rowSize;
+	QFile file(path);
+	if(!file.open(QIODevice::WriteOnly)) return false;
+
+	quint64 random = Q_UINT64_C(0x9E3779B97F4A7C15);
+	QByteArray block;
+	block.reserve(benchWriteBlockBytes + rowSize);
+	bool retval = true;
+	for(quint64 row = 0; row < rows && retval; ++row) {
+		for(int col = 0; col < work.colBytes.size(); ++col) {
+			random ^= random << 13;	// xorshift64
+			random ^= random >> 7;
+			random ^= random << 17;
+			quint64 value = work.colCounter.at(col) ? row : random;
+			int bytes = work.colBytes.at(col);
+			if(work.colType.at(col) == PlanColumn::Float)
+				value = floatBits(bytes, random);
+			for(int index = 0; index < bytes; ++index) {
+				int shift = (work.byteSwap ? bytes - 1 - index : index) << 3;
+				block.append(char(value >> shift));
+			}
+		}
+		if(block.size() >= benchWriteBlockBytes || row + 1 == rows) {
+			retval = (file.write(block) == block.size());
+			block.clear();
+		}
+	}
+	file.close();
+	return retval;
+}
+
+
+//! Settings for converting a workload's capture, as the GUI would make them.
+static ConvertSettings workloadSettings(const Workload &work)
+{
+	ConvertSettings settings;
+	for(int col = 0; col < work.colBytes.size(); ++col) {
+		settings.colNames.append(QString("Column %1").arg(col + 1));
+		settings.colBytes.append(work.colBytes.at(col));
+		settings.colCounter.append(work.colCounter.at(col));
+		settings.colType.append(work.colType.at(col));
+	}
+	settings.byteSwap = work.byteSwap;
+	return settings;
+}
+
+
+//! Touches every page of the mapped capture, as decoding it would.
+static bool timeRead(const QString &path, StageTime &stage)
+{
+	MappedInput input;
+	if(!input.open(path)) return false;
+	QElapsedTimer clock;
+	clock.start();
+	quint64 size = input.size();
+	quint64 window = qMax(Q_UINT64_C(1), input.maxWindowSize());
+	uint sum = 0;
+	for(quint64 offset = 0; offset < size; offset += window) {
+		quint64 length = qMin(window, size - offset);
+		const uchar *data = input.map(offset, length);
+		if(data == 0) return false;
+		for(quint64 page = 0; page < length; page += 4096) sum += data[page];
+	}
+	stage.nanoseconds = clock.nsecsElapsed();
+	stage.bytes = size;
+	volatile uint keep = sum;	// The loop must not be optimized away
+	Q_UNUSED(keep);
+	return true;
+}
+
+
+//! Decodes, formats and writes the capture one block of rows at a time,
+//! timing each of those stages on its own.
+static bool timeStages(const QString &path, const QString &csvPath,
+					   const ConvertSettings &settings, StageTime &decode,
+					   StageTime &format, StageTime &write)
+{
+	MappedInput input;
+	QFile csv(csvPath);
+	if(!input.open(path) || !csv.open(QIODevice::WriteOnly)) return false;
+	DecodePlan plan;
+	plan.compile(settings);
+	DecodedBlock block;
+	block.resize(plan.columnCount());
+	CsvFormatter text(settings.precision);
+	int rowTextBytes = plan.columnCount() * (maxValueTextBytes + 1) + 1;
+
+	quint64 rows = input.size() / plan.rowSize;
+	quint64 windowRows = qMax(Q_UINT64_C(1),
+							  input.maxWindowSize() / plan.rowSize);
+	QElapsedTimer clock;
+	clock.start();
+	for(quint64 first = 0; first < rows; first += windowRows) {
+		quint64 count = qMin(windowRows, rows - first);
+		const uchar *data = input.map(first * plan.rowSize,
+									  count * plan.rowSize);
+		if(data == 0) return false;
+		for(quint64 done = 0; done < count; done += block.rows) {
+			int blockRows = int(qMin(count - done, quint64(decodeBlockRows)));
+			qint64 start = clock.nsecsElapsed();
+			plan.decode(data + done * plan.rowSize, plan.rowSize, blockRows,
+						block);
+			qint64 decoded = clock.nsecsElapsed();
+			for(int row = 0; row < block.rows; ++row) {
+				text.reserve(rowTextBytes);
+				for(int col = 0; col < plan.columnCount(); ++col) {
+					const PlanColumn &column = plan.columns.at(col);
+					if(column.kind == PlanColumn::Voltage)
+						text.appendDouble(block.realColumn(col)[row]);
+					else if(column.type == PlanColumn::Signed)
+						text.appendInt(qint64(block.rawColumn(col)[row]));
+					else text.appendUInt(block.rawColumn(col)[row]);
+					text.append(',');
+				}
+				text.append('\n');
+			}
+			qint64 formatted = clock.nsecsElapsed();
+			decode.nanoseconds += decoded - start;
+			format.nanoseconds += formatted - decoded;
+			if(text.size() >= benchWriteBlockBytes) {
+				if(csv.write(text.data(), text.size()) != text.size())
+					return false;
+				write.bytes += text.size();
+				text.clear();
+				write.nanoseconds += clock.nsecsElapsed() - formatted;
+			}
+		}
+	}
+	qint64 start = clock.nsecsElapsed();
+	if(csv.write(text.data(), text.size()) != text.size()) return false;
+	csv.close();
+	write.nanoseconds += clock.nsecsElapsed() - start;
+	write.bytes += text.size();
+	decode.bytes = format.bytes = rows * plan.rowSize;
+	decode.rows = format.rows = write.rows = rows;
+	return true;
+}
+
+
+//! Runs a whole conversion job on the capture.
+static bool timeConvert(ConvertSettings settings, StageTime &stage,
+						QString &errorMessage)
+{
+	QElapsedTimer clock;
+	clock.start();
+	Converter converter(settings);
+	bool retval = converter.run();
+	stage.nanoseconds = clock.nsecsElapsed();
+	stage.bytes = QFileInfo(settings.infilePath).size();
+	stage.rows = converter.rowsWritten();
+	if(settings.writeColNames && stage.rows > 0) stage.rows -= 1;
+	if(!retval) errorMessage = converter.errorMessage;
+	return retval;
+}
+
+
+//! @returns One stage's results as a JSON object
+static QString stageJson(const StageTime &stage)
+{
+	double seconds = stage.nanoseconds / 1e9;
+	double perSecond = (seconds > 0) ? 1 / seconds : 0;
+	return QString("{\"seconds\":%1,\"mb_per_s\":%2,\"rows_per_s\":%3}")
+			.arg(seconds, 0, 'g', 6)
+			.arg(stage.bytes / 1e6 * perSecond, 0, 'f', 1)
+			.arg(stage.rows * perSecond, 0, 'f', 0);
+}
+
+
+//! @returns The share of a stage's time which a slower run of it added
+static double statsCost(const StageTime &with, const StageTime &without)
+{
+	if(without.nanoseconds <= 0) return 0;
+	return double(with.nanoseconds) / without.nanoseconds - 1;
+}
+
+
+int main(int argc, char **argv)
+{
+	QCoreApplication app(argc, argv);
+	QTextStream out(stdout);
+	QTextStream err(stderr);
+	QStringList args = app.arguments();
+	QStringList layouts;
+	QString sizesText = BENCH_DEFAULT_SIZES;
+	QString endianText = "swapped";
+	QString dirPath = QDir::tempPath();
+	int threads = 0, precision = defaultPrecision;
+	bool keep = false, argError = false;
+
+	for(int index = 1; index < args.size(); ++index) {
+		const QString &arg = args.at(index);
+		if(arg == "--layout" && index + 1 < args.size())
+			layouts.append(args.at(++index));
+		else if(arg == "--size" && index + 1 < args.size())
+			sizesText = args.at(++index);
+		else if(arg == "--endian" && index + 1 < args.size())
+			endianText = args.at(++index);
+		else if(arg == "--threads" && index + 1 < args.size())
+			threads = args.at(++index).toInt();
+		else if(arg == "--precision" && index + 1 < args.size())
+			precision = args.at(++index).toInt();
+		else if(arg == "--dir" && index + 1 < args.size())
+			dirPath = args.at(++index);
+		else if(arg == "--keep") keep = true;
+		else argError = true;
+	}
+	if(layouts.isEmpty()) layouts.append(BENCH_DEFAULT_LAYOUT);
+	QList<bool> orders;
+	if(endianText != "native") orders.append(true);
+	if(endianText != "swapped") orders.append(false);
+	if(endianText != "native" && endianText != "swapped" &&
+	   endianText != "both") argError = true;
+
+	QList<Workload> workloads;
+	QStringList sizes = sizesText.split(',');
+	for(int lay = 0; lay < layouts.size() && !argError; ++lay) {
+		for(int size = 0; size < sizes.size() && !argError; ++size) {
+			for(int order = 0; order < orders.size(); ++order) {
+				Workload work;
+				argError = !parseLayout(layouts.at(lay), work);
+				work.bytes = parseSize(sizes.at(size));
+				work.byteSwap = orders.at(order);
+				if(work.bytes == 0) argError = true;
+				workloads.append(work);
+			}
+		}
+	}
+	if(argError) {
+		printUsage(err);
+		return 2;
+	}
+
+	QDir dir(dirPath);
+	int retval = 0;
+	for(int index = 0; index < workloads.size() && retval == 0; ++index) {
+		const Workload &work = workloads.at(index);
+		QString name = QString("cnb-bench-%1").arg(index + 1);
+		QString capturePath = dir.filePath(name + ".bin");
+		QString csvPath = dir.filePath(name + "-stages.csv");
+		QString convertPath = dir.filePath(name + "-convert.csv");
+		ConvertSettings settings = workloadSettings(work);
+		settings.infilePath = capturePath;
+		settings.outfilePath = convertPath;
+		settings.threads = threads;
+		settings.precision = precision;
+		quint64 rows = 0;
+		StageTime read, decode, format, write, convert, convertNoStats;
+		QString errorMessage;
+		if(!generateCapture(capturePath, work, rows))
+			errorMessage = "Cannot write capture: " + capturePath;
+		else if(!timeRead(capturePath, read) ||
+				!timeStages(capturePath, csvPath, settings, decode, format,
+							write))
+			errorMessage = "Error reading capture or writing CSV file.";
+		else if(timeConvert(settings, convert, errorMessage)) {
+			settings.columnStats = false;
+			timeConvert(settings, convertNoStats, errorMessage);
+		}
+		read.rows = rows;
+
+		if(!errorMessage.isEmpty()) {
+			err << work.layout << ": " << errorMessage << endl;
+			retval = 1;
+		}
+		else {
+			out << "{\"layout\":\"" << work.layout << "\",\"endian\":\""
+				<< (work.byteSwap ? "swapped" : "native") << "\",\"bytes\":"
+				<< rows * settings.rowDataSize() << ",\"rows\":" << rows
+				<< ",\"threads\":" << threads << ",\"precision\":"
+				<< precision << ",\"instruction_set\":\""
+				<< uniformDecodeInstructionSet() << "\",\"stages\":{"
+				<< "\"read\":" << stageJson(read)
+				<< ",\"decode\":" << stageJson(decode)
+				<< ",\"format\":" << stageJson(format)
+				<< ",\"write\":" << stageJson(write)
+				<< ",\"convert\":" << stageJson(convert)
+				<< ",\"convert_no_stats\":" << stageJson(convertNoStats)
+				<< "},\"column_stats_cost\":"
+				<< QString::number(statsCost(convert, convertNoStats), 'f', 4)
+				<< "}" << endl;
+		}
+		if(!keep) {
+			QFile::remove(capturePath);
+			QFile::remove(csvPath);
+			QFile::remove(convertPath);
+			QFile::remove(ColumnStats::pathFor(convertPath));
+		}
+	}
+	return retval;
+}
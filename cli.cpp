@@ -0,0 +1,226 @@
+/*
+	Name        : cli.cpp
+	Author      : Charles N. Burns (charlesnburns|gmail|com / burnchar|isu|edu)
+	Date        : October 2026
+	License     : GPL3. See license.txt or www.gnu.org/licenses/gpl-3.0.txt
+	Requirements: Qt 4, data to parse.
+	Notes       : Best viewed with tab width 4.
+	Description : Command-line front end. Converts a data file using the column
+				  layout stored in a settings file written by the GUI, without
+				  creating any widgets or needing a display.
+
+	Usage:
+
+	cnb-data-parser --layout config.xml [--limit N] [--threads N]
+					[--precision N] [--reduce MODE] [--filter EXPR] [--follow]
+					[--resume] [--stats FILE] [--no-column-stats] in.bin out.csv
+	cnb-data-parser --layout config.xml [options] [--memory MB]
+					in1.bin in2.bin ... outdir
+
+	The settings file supplies the column names, byte counts, types, counter
+	boxes, export boxes, voltage range, byte order, and row limit. Columns
+	whose export box is unchecked are left out of the output, and never
+	decoded. A column's type is unsigned, signed (two's complement, whose
+	most negative value is the low voltage), or float (IEEE 754 of 2, 4 or 8
+	bytes, written unscaled). --limit overrides the row limit.
+	--threads sets the number of worker threads; the default is one per core.
+	--precision sets the significant digits of voltages, 1 to 17. The default
+	is 15; 0 writes 15, or 16 or 17 where 15 would not read back as the
+	exact value.
+	--reduce sets how each N rows become one when the row limit is less than
+	the number of rows: first (keep the first row), mean, minmax, or lttb.
+	--filter keeps only the rows for which an expression is true, such as
+	"ch3 > 2.5 && seq % 10 == 0", in place of the settings file's filter.
+	Columns are named as in the settings file, in [brackets] if the name has
+	spaces, or numbered as $1, $2... Counters may be combined with + - * / %,
+	voltage and float columns compared with a number, and comparisons joined
+	with &&, || and !. Rows the row limit keeps are then filtered; a filter
+	cannot be combined with mean, minmax or lttb.
+	An output file ending in .arrow, .feather or .ipc is written as an Arrow
+	IPC file, with counters as integers and voltages and floats as doubles.
+	An output file ending in .gz or .zst, such as out.csv.gz, is a CSV file
+	compressed with gzip or zstd in blocks, one per parallel task.
+	--follow keeps appending rows to the CSV file as they are written to the
+	data file, like tail -f, until interrupted. The row limit is ignored.
+	--resume continues a CSV file from the checkpoint written next to it by
+	an earlier --resume run, if the layout, the data converted so far and the
+	CSV file are unchanged; otherwise the CSV file is written from the start.
+	Arrow and compressed output cannot be resumed.
+	--stats writes the job's per-stage counters and times to FILE as JSON,
+	and prints a summary of them and of the output columns to stderr.
+	Every job writes the minimum, maximum, mean, standard deviation and a
+	histogram of each output column, in raw counts and volts, to a JSON file
+	named after the output file, such as out.csv.stats.json. They are
+	gathered as the rows are converted, and kept in the checkpoint of a
+	--resume run, so a resumed job's cover every row of its output.
+	--no-column-stats, or <columnstats> unchecked in the settings file,
+	turns them off.
+	Several data files, or a data file name with wildcards such as *.bin,
+	are converted as one batch, several files at once. Each output file is
+	named after its data file. The last argument is then the directory for
+	them, or a name such as out/*.csv.gz whose directory and extension are
+	used. --memory caps the output the batch holds in memory at once; the
+	default is 512 MB. Each file's throughput and the batch's are printed to
+	stderr. --follow and --stats apply only to a single file.
+	A data file compressed with gzip or zstd is decompressed as it is read,
+	in builds which support it; see DataParser.pro. It can be neither
+	followed nor resumed, and cannot have a row limit, as its rows are not
+	known until it has all been read; it is read only once.
+	A framed data file, in which each row is sent as sync word, optional
+	length byte, row and optional checksum, is described by the settings
+	file's <syncword> (hex bytes, such as EB90), <lengthbyte> (checked or
+	unchecked) and <checksum> (none, sum8, xor8, crc16 or crc32, over the
+	length byte and row, in the data's byte order). Only the rows of good
+	frames are converted. After a bad frame the file is searched for the
+	next sync word which starts a good one; the number of bad frames is
+	printed to stderr, and written by --stats. A framed file cannot be
+	compressed.
+*/
+
+#include <QCoreApplication>
+#include <QStringList>
+#include <QTextStream>
+#include <cstdio>
+#include "Config.h"
+#include "Converter.h"
+#include "BatchQueue.h"
+
+//! Prints the usage message to stderr.
+static void printUsage(QTextStream &err)
+{
+	err << "Usage: cnb-data-parser --layout config.xml [--limit N] "
+		   "[--threads N] [--precision N] [--reduce first|mean|minmax|lttb] "
+		   "[--filter EXPR] [--follow] [--resume] [--stats FILE] "
+		   "[--no-column-stats] in.bin out.csv" << endl
+		<< "       cnb-data-parser --layout config.xml [options] "
+		   "[--memory MB] in1.bin in2.bin ... outdir" << endl;
+}
+
+
+int main(int argc, char **argv)
+{
+	QCoreApplication app(argc, argv);
+	QTextStream err(stderr);
+	QStringList args = app.arguments();
+	QStringList files;
+	QString layoutURI, limitText, threadsText, precisionText, reduceText;
+	QString statsPath, memoryText, filterText;
+	bool filterGiven = false;
+	bool follow = false;
+	bool resume = false;
+	bool noColumnStats = false;
+	bool argError = false;
+
+	for(int index = 1; index < args.size(); ++index) {
+		const QString &arg = args.at(index);
+		if(arg == "--layout" && index + 1 < args.size())
+			layoutURI = args.at(++index);
+		else if(arg == "--limit" && index + 1 < args.size())
+			limitText = args.at(++index);
+		else if(arg == "--threads" && index + 1 < args.size())
+			threadsText = args.at(++index);
+		else if(arg == "--precision" && index + 1 < args.size())
+			precisionText = args.at(++index);
+		else if(arg == "--reduce" && index + 1 < args.size())
+			reduceText = args.at(++index);
+		else if(arg == "--stats" && index + 1 < args.size())
+			statsPath = args.at(++index);
+		else if(arg == "--memory" && index + 1 < args.size())
+			memoryText = args.at(++index);
+		else if(arg == "--filter" && index + 1 < args.size()) {
+			filterText = args.at(++index);
+			filterGiven = true;
+		}
+		else if(arg == "--follow") follow = true;
+		else if(arg == "--resume") resume = true;
+		else if(arg == "--no-column-stats") noColumnStats = true;
+		else if(arg.startsWith("--")) argError = true;
+		else files.append(arg);
+	}
+	// Windows leaves wildcards to each program
+	QStringList inputs;
+	for(int index = 0; index + 1 < files.size(); ++index)
+		inputs += BatchQueue::expandPattern(files.at(index));
+	if(argError || layoutURI.isEmpty() || files.size() < 2 ||
+	   inputs.isEmpty() || (follow && inputs.size() > 1)) {
+		printUsage(err);
+		return 2;
+	}
+
+	// Config::xmlRead() creates a default file when none exists; don't.
+	if(! QFile::exists(layoutURI)) {
+		err << "Settings file does not exist: " << layoutURI << endl;
+		return 1;
+	}
+	Config config;
+	if(! config.xmlRead(layoutURI, DEFAULT_START_ELEMENT) ||
+	   ! config.xmlParse()) {
+		err << "Unable to read settings file: " << config.errorMessage << endl;
+		return 1;
+	}
+
+	ConvertSettings settings;
+	if(! settings.fromConfig(config)) {
+		err << settings.errorMessage << endl;
+		return 1;
+	}
+	settings.infilePath = inputs.first();
+	settings.outfilePath = files.last();
+	settings.format = ConvertSettings::formatForPath(settings.outfilePath);
+	settings.compression =
+			ConvertSettings::compressionForPath(settings.outfilePath);
+	if(! limitText.isEmpty()) settings.rowLimit = limitText.toULongLong();
+	if(! threadsText.isEmpty()) settings.threads = threadsText.toInt();
+	if(! precisionText.isEmpty()) settings.precision = precisionText.toInt();
+	if(! reduceText.isEmpty())
+		settings.decimation = Decimator::modeFromName(reduceText);
+	if(filterGiven) settings.rowFilter = filterText;
+	settings.follow = follow;
+	settings.resume = resume;
+	if(noColumnStats) settings.columnStats = false;
+	settings.statsPath = statsPath;
+
+	if(inputs.size() > 1 || files.size() > 2 ||
+	   QFileInfo(files.last()).isDir()) {
+		BatchQueue batch;
+		if(! memoryText.isEmpty())
+			batch.setMemoryLimit(memoryText.toULongLong() << 20);
+		settings.statsPath.clear();
+		for(int index = 0; index < inputs.size(); ++index) {
+			settings.infilePath = inputs.at(index);
+			settings.outfilePath = BatchQueue::outputPathFor(inputs.at(index),
+															 files.last());
+			settings.format =
+					ConvertSettings::formatForPath(settings.outfilePath);
+			settings.compression =
+					ConvertSettings::compressionForPath(settings.outfilePath);
+			if(! batch.add(settings)) {
+				err << batch.errorMessage << endl;
+				return 1;
+			}
+		}
+		bool succeeded = batch.run();
+		for(int index = 0; index < batch.size(); ++index)
+			err << batch.jobSummary(index) << endl;
+		err << batch.summary() << endl;
+		return succeeded ? 0 : 1;
+	}
+
+	Converter converter(settings);
+	if(! converter.run()) {
+		err << converter.errorMessage << endl;
+		return 1;
+	}
+	const RunStats &stats = converter.runStats();
+	if(! statsPath.isEmpty()) {
+		err << stats.summary() << endl;
+		if(settings.columnStats)
+			err << converter.columnStatistics().summary() << endl;
+	}
+	else {
+		if(stats.framesBad > 0)
+			err << stats.framesBad << " bad frames were skipped." << endl;
+		if(! stats.warning.isEmpty()) err << stats.warning << endl;
+	}
+	return 0;
+}
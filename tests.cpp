@@ -0,0 +1,151 @@
+/*
+	Name        : tests.cpp
+	Author      : Charles N. Burns (charlesnburns|gmail|com / burnchar|isu|edu)
+	Date        : October 2026
+	License     : GPL3. See license.txt or www.gnu.org/licenses/gpl-3.0.txt
+	Requirements: Qt 4, with QtTest.
+	Notes       : Best viewed with tab width 4.
+	Description : Tests of the Converter engine, built with CONFIG+=tests.
+
+	Usage:
+
+	cnb-data-parser-tests [QtTest options]
+
+	Each test writes a small capture to the system's temporary directory and
+	removes it, and every file converted from it, afterward.
+*/
+
+#include <QtTest/QtTest>
+#include <QDir>
+#include <QFile>
+#include "Converter.h"
+
+const int testRows = 4096;
+const char OLD_OUTPUT[] = "Output of an earlier run";
+
+
+class ConverterTest : public QObject
+{
+	Q_OBJECT
+
+	QString capturePath;
+
+	ConvertSettings captureSettings(const QString &outfilePath) const;
+	void writeOldOutput(const QString &path) const;
+	QByteArray contents(const QString &path) const;
+
+private slots:
+	void initTestCase();
+	void cleanupTestCase();
+	void cancelledArrowResumeKeepsOldOutput();
+	void cancelledCompressedResumeKeepsOldOutput();
+	void cancelledArrowRemovesOutput();
+};
+
+
+//! Writes a capture of testRows rows, of a 2-byte counter and a 2-byte
+//! voltage.
+void ConverterTest::initTestCase()
+{
+	capturePath = QDir(QDir::tempPath()).filePath("cnb-tests.bin");
+	QFile file(capturePath);
+	QVERIFY(file.open(QFile::WriteOnly));
+	QByteArray rows(testRows * 4, '\0');
+	for(int row = 0; row < testRows; ++row) {
+		rows[row * 4] = char(row);
+		rows[row * 4 + 1] = char(row >> 8);
+		rows[row * 4 + 2] = char(row * 7);
+		rows[row * 4 + 3] = char(row >> 3);
+	}
+	QCOMPARE(file.write(rows), qint64(rows.size()));
+}
+
+
+void ConverterTest::cleanupTestCase()
+{
+	QFile::remove(capturePath);
+}
+
+
+//! @returns Settings converting the capture to outfilePath, whose name
+//!			 chooses the format and compression, as on the command line
+ConvertSettings ConverterTest::captureSettings(const QString &outfilePath)
+		const
+{
+	ConvertSettings settings;
+	settings.infilePath = capturePath;
+	settings.outfilePath = outfilePath;
+	settings.format = ConvertSettings::formatForPath(outfilePath);
+	settings.compression = ConvertSettings::compressionForPath(outfilePath);
+	settings.colNames << "Count" << "Volts";
+	settings.colBytes << 2 << 2;
+	settings.colCounter << true << false;
+	return settings;
+}
+
+
+//! Stands in for the output of an earlier run, which must not be lost.
+void ConverterTest::writeOldOutput(const QString &path) const
+{
+	QFile file(path);
+	QVERIFY(file.open(QFile::WriteOnly));
+	file.write(OLD_OUTPUT);
+}
+
+
+QByteArray ConverterTest::contents(const QString &path) const
+{
+	QFile file(path);
+	return file.open(QFile::ReadOnly) ? file.readAll() : QByteArray();
+}
+
+
+//! An Arrow file cut off at a checkpoint could never be continued, so a
+//! resumable Arrow job is refused before its output is touched.
+void ConverterTest::cancelledArrowResumeKeepsOldOutput()
+{
+	QString outfilePath = QDir(QDir::tempPath()).filePath("cnb-tests.arrow");
+	writeOldOutput(outfilePath);
+	ConvertSettings settings = captureSettings(outfilePath);
+	settings.resume = true;
+	Converter converter(settings);
+	converter.cancel();
+	QVERIFY(!converter.run());
+	QVERIFY(!converter.errorMessage.isEmpty());
+	QCOMPARE(contents(outfilePath), QByteArray(OLD_OUTPUT));
+	QVERIFY(!QFile::exists(Checkpoint::pathFor(outfilePath)));
+	QFile::remove(outfilePath);
+}
+
+
+//! Likewise a compressed CSV file, which would lack its final block.
+void ConverterTest::cancelledCompressedResumeKeepsOldOutput()
+{
+	QString outfilePath = QDir(QDir::tempPath()).filePath("cnb-tests.csv.gz");
+	writeOldOutput(outfilePath);
+	ConvertSettings settings = captureSettings(outfilePath);
+	settings.resume = true;
+	Converter converter(settings);
+	converter.cancel();
+	QVERIFY(!converter.run());
+	QCOMPARE(contents(outfilePath), QByteArray(OLD_OUTPUT));
+	QVERIFY(!QFile::exists(Checkpoint::pathFor(outfilePath)));
+	QFile::remove(outfilePath);
+}
+
+
+//! A cancelled Arrow job leaves no half-written file behind.
+void ConverterTest::cancelledArrowRemovesOutput()
+{
+	QString outfilePath = QDir(QDir::tempPath()).filePath("cnb-tests.arrow");
+	Converter converter(captureSettings(outfilePath));
+	converter.cancel();
+	QVERIFY(!converter.run());
+	QVERIFY(converter.wasCancelled());
+	QVERIFY(!QFile::exists(outfilePath));
+	QFile::remove(ColumnStats::pathFor(outfilePath));
+}
+
+
+QTEST_APPLESS_MAIN(ConverterTest)
+#include "tests.moc"